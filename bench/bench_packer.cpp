@@ -0,0 +1,384 @@
+#include "maxrects_packer.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace MaxRects;
+
+namespace {
+
+    using Packer = MaxRectsPacker<float, Rectangle<float>>;
+    using Bin = MaxRectsBin<Rectangle<float>, float>;
+
+    constexpr auto bin_edge = 2048.0f;
+
+    struct workload {
+        const char* name{};
+        std::function<Rectangle<float>(std::mt19937&)> generate{};
+    };
+
+    struct config {
+        PackingLogic logic{};
+        bool allow_rotation{};
+        BinSelection selection{};
+        BinAlgorithm algorithm{BinAlgorithm::MaxRects};
+        SkylineHeuristic skyline{};
+        GuillotineSplit split{};
+        bool global{};
+        ShardMode shard{ShardMode::Off};
+    };
+
+    struct result {
+        std::string workload{};
+        std::string config{};
+        std::size_t rects{};
+        double rects_per_sec{};
+        double ns_per_insert{};
+        std::size_t peak_free_rects{};
+        std::size_t bins{};
+        double occupancy{};
+    };
+
+    struct settings {
+        std::size_t count{5000};
+        std::size_t repeat{3};
+        double tolerance{0.10};
+        std::string json_path{};
+        std::string baseline_path{};
+    };
+
+    auto uniform_edge(std::mt19937& engine, int low, int high) -> float {
+        return static_cast<float>(std::uniform_int_distribution<int>{low, high}(engine));
+    }
+
+    // Mostly small frames with power-of-two sizes mixed in, as sprite sheets tend to be.
+    auto sprite_sheet(std::mt19937& engine) -> Rectangle<float> {
+        if (std::uniform_int_distribution<int>{0, 3}(engine) == 0) {
+            const auto shift = std::uniform_int_distribution<int>{4, 8}(engine);
+            return Rectangle<float>{static_cast<float>(1 << shift), static_cast<float>(1 << shift)};
+        }
+        return Rectangle<float>{uniform_edge(engine, 16, 192), uniform_edge(engine, 16, 192)};
+    }
+
+    // Glyphs share a line height and vary mostly in advance width.
+    auto font_glyph(std::mt19937& engine) -> Rectangle<float> {
+        const auto line_height = std::array{18.0f, 24.0f, 32.0f}[std::uniform_int_distribution<std::size_t>{0, 2}(engine)];
+        return Rectangle<float>{uniform_edge(engine, 4, static_cast<int>(line_height)), line_height - uniform_edge(engine, 0, 6)};
+    }
+
+    auto ui_icon(std::mt19937& engine) -> Rectangle<float> {
+        constexpr auto edges = std::array{16.0f, 24.0f, 32.0f, 48.0f, 64.0f, 128.0f};
+        const auto edge = edges[std::uniform_int_distribution<std::size_t>{0, edges.size() - 1}(engine)];
+        return Rectangle<float>{edge, edge};
+    }
+
+    auto uniform_random(std::mt19937& engine) -> Rectangle<float> {
+        return Rectangle<float>{uniform_edge(engine, 8, 256), uniform_edge(engine, 8, 256)};
+    }
+
+    // Pareto-distributed edges: many tiny rects and a few that take most of a bin.
+    auto heavy_tailed(std::mt19937& engine) -> Rectangle<float> {
+        auto uniform = std::uniform_real_distribution<double>{0.0, 1.0};
+        const auto pareto = [&]() {
+            const auto edge = 8.0 / std::pow(1.0 - uniform(engine), 1.0 / 1.2);
+            return static_cast<float>(std::min(std::floor(edge), 1536.0));
+        };
+        return Rectangle<float>{pareto(), pareto()};
+    }
+
+    auto logic_name(PackingLogic logic) -> const char* {
+        switch (logic) {
+            case PackingLogic::MaxArea:
+                return "max_area";
+            case PackingLogic::MaxEdge:
+                return "max_edge";
+            case PackingLogic::BottomLeft:
+                return "bottom_left";
+            case PackingLogic::ContactPoint:
+                return "contact_point";
+            default:
+                return "fill_width";
+        }
+    }
+
+    auto algorithm_name(const config& cfg) -> const char* {
+        switch (cfg.algorithm) {
+            case BinAlgorithm::Skyline:
+                return cfg.skyline == SkylineHeuristic::MinWaste ? "skyline_mw" : "skyline_bl";
+            case BinAlgorithm::Guillotine:
+                return cfg.split == GuillotineSplit::MinArea ? "guillotine_min_area" : "guillotine_sla";
+            default:
+                return logic_name(cfg.logic);
+        }
+    }
+
+    auto shard_name(ShardMode mode) -> const char* {
+        switch (mode) {
+            case ShardMode::RoundRobin:
+                return "/shard_rr";
+            case ShardMode::SizeClass:
+                return "/shard_size";
+            case ShardMode::Tag:
+                return "/shard_tag";
+            default:
+                return "";
+        }
+    }
+
+    auto config_name(const config& cfg) -> std::string {
+        const auto* algorithm = algorithm_name(cfg);
+        return std::string{algorithm} + (cfg.allow_rotation ? "/rotate" : "/fixed") +
+            (cfg.selection == BinSelection::BestFit ? "/best_fit" : "/first_fit") + (cfg.global ? "/global" : "") +
+            shard_name(cfg.shard);
+    }
+
+    auto make_options(const config& cfg) -> PackingOptions<float> {
+        auto opts = PackingOptions<float>{};
+        opts.logic = cfg.logic;
+        opts.allow_rotation = cfg.allow_rotation;
+        opts.bin_selection = cfg.selection;
+        opts.bin_algorithm = cfg.algorithm;
+        opts.skyline = cfg.skyline;
+        opts.guillotine_split = cfg.split;
+        opts.global_fit = cfg.global;
+        opts.shard = cfg.shard;
+        return opts;
+    }
+
+    auto peak_free_rects(const config& cfg, const std::vector<Rectangle<float>>& rects) -> std::size_t {
+        auto packer = Packer{bin_edge, bin_edge, 0.0f, make_options(cfg)};
+        auto peak = std::size_t{0};
+        for (const auto& rect : rects) {
+            packer.add(rect);
+            for (const auto& bin : packer.bins) {
+                if (const auto* maxrects_bin = dynamic_cast<const Bin*>(bin.get())) {
+                    peak = std::max(peak, maxrects_bin->free_rect_count());
+                }
+            }
+        }
+        return peak;
+    }
+
+    auto measure(const workload& load, const config& cfg, const std::vector<Rectangle<float>>& rects,
+                std::size_t repeat) -> result {
+        auto best_ns = 0.0;
+        auto packed = result{load.name, config_name(cfg), rects.size()};
+        for (auto run = std::size_t{0}; run < repeat; ++run) {
+            auto packer = Packer{bin_edge, bin_edge, 0.0f, make_options(cfg)};
+            const auto begin_time = std::chrono::steady_clock::now();
+            packer.add_array(rects);
+            const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin_time).count();
+            if (run == 0 || elapsed < best_ns) {
+                best_ns = elapsed;
+            }
+            packed.bins = packer.bins.size();
+            packed.occupancy = packer.occupancy();
+        }
+        packed.ns_per_insert = best_ns / static_cast<double>(rects.size());
+        packed.rects_per_sec = 1.0e9 / packed.ns_per_insert;
+        packed.peak_free_rects = peak_free_rects(cfg, rects);
+        return packed;
+    }
+
+    auto write_json(const std::vector<result>& results, std::FILE* out) -> void {
+        std::fprintf(out, "{\n  \"bin_edge\": %.0f,\n  \"results\": [\n", static_cast<double>(bin_edge));
+        for (auto i = std::size_t{0}; i < results.size(); ++i) {
+            const auto& r = results[i];
+            std::fprintf(out,
+                "    {\"workload\": \"%s\", \"config\": \"%s\", \"rects\": %zu, \"rects_per_sec\": %.1f, "
+                "\"ns_per_insert\": %.1f, \"peak_free_rects\": %zu, \"bins\": %zu, \"occupancy\": %.6f}%s\n",
+                r.workload.c_str(), r.config.c_str(), r.rects, r.rects_per_sec, r.ns_per_insert,
+                r.peak_free_rects, r.bins, r.occupancy, i + 1 < results.size() ? "," : "");
+        }
+        std::fprintf(out, "  ]\n}\n");
+    }
+
+    auto string_field(std::string_view line, std::string_view key) -> std::string {
+        const auto pattern = "\"" + std::string{key} + "\": \"";
+        const auto start = line.find(pattern);
+        if (start == std::string_view::npos) {
+            return {};
+        }
+        const auto first = start + pattern.size();
+        return std::string{line.substr(first, line.find('"', first) - first)};
+    }
+
+    auto number_field(std::string_view line, std::string_view key) -> double {
+        const auto pattern = "\"" + std::string{key} + "\": ";
+        const auto start = line.find(pattern);
+        if (start == std::string_view::npos) {
+            return 0.0;
+        }
+        return std::strtod(std::string{line.substr(start + pattern.size())}.c_str(), nullptr);
+    }
+
+    // Reads back the one-result-per-line layout produced by write_json.
+    auto read_baseline(const std::string& path) -> std::vector<result> {
+        auto baseline = std::vector<result>{};
+        auto file = std::ifstream{path};
+        auto line = std::string{};
+        while (std::getline(file, line)) {
+            if (line.find("\"workload\"") == std::string::npos) {
+                continue;
+            }
+            auto r = result{string_field(line, "workload"), string_field(line, "config")};
+            r.rects = static_cast<std::size_t>(number_field(line, "rects"));
+            r.ns_per_insert = number_field(line, "ns_per_insert");
+            r.bins = static_cast<std::size_t>(number_field(line, "bins"));
+            r.occupancy = number_field(line, "occupancy");
+            baseline.push_back(std::move(r));
+        }
+        return baseline;
+    }
+
+    auto compare(const std::vector<result>& results, const std::vector<result>& baseline, double tolerance) -> std::size_t {
+        auto regressions = std::size_t{0};
+        for (const auto& current : results) {
+            const auto match = std::find_if(baseline.begin(), baseline.end(), [&](const auto& old) {
+                return old.workload == current.workload && old.config == current.config && old.rects == current.rects;
+            });
+            if (match == baseline.end()) {
+                continue;
+            }
+            if (current.ns_per_insert > match->ns_per_insert * (1.0 + tolerance)) {
+                std::printf("REGRESSION %s %s: %.1f ns/insert, baseline %.1f\n", current.workload.c_str(),
+                    current.config.c_str(), current.ns_per_insert, match->ns_per_insert);
+                ++regressions;
+            }
+            if (current.bins > match->bins || current.occupancy < match->occupancy - 1.0e-4) {
+                std::printf("REGRESSION %s %s: %zu bins at %.4f occupancy, baseline %zu at %.4f\n", current.workload.c_str(),
+                    current.config.c_str(), current.bins, current.occupancy, match->bins, match->occupancy);
+                ++regressions;
+            }
+        }
+        return regressions;
+    }
+
+    auto parse(int argc, char** argv, settings& out) -> bool {
+        for (auto i = 1; i < argc; ++i) {
+            const auto arg = std::string_view{argv[i]};
+            if (i + 1 >= argc) {
+                return false;
+            }
+            if (arg == "--count") {
+                out.count = static_cast<std::size_t>(std::strtoull(argv[++i], nullptr, 10));
+            } else if (arg == "--repeat") {
+                out.repeat = std::max(static_cast<std::size_t>(std::strtoull(argv[++i], nullptr, 10)), std::size_t{1});
+            } else if (arg == "--tolerance") {
+                out.tolerance = std::strtod(argv[++i], nullptr);
+            } else if (arg == "--json") {
+                out.json_path = argv[++i];
+            } else if (arg == "--baseline") {
+                out.baseline_path = argv[++i];
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+}
+
+auto main(int argc, char** argv) -> int {
+    auto opts = settings{};
+    if (!parse(argc, argv, opts)) {
+        std::fprintf(stderr, "usage: %s [--count N] [--repeat N] [--json out.json] [--baseline old.json] [--tolerance 0.1]\n", argv[0]);
+        return 2;
+    }
+
+    const auto workloads = std::array{
+        workload{"sprite_sheet", sprite_sheet},
+        workload{"font_glyph", font_glyph},
+        workload{"ui_icon", ui_icon},
+        workload{"uniform", uniform_random},
+        workload{"heavy_tailed", heavy_tailed}
+    };
+
+    auto configs = std::vector<config>{};
+    for (auto logic : packing_logics) {
+        for (auto rotation : {false, true}) {
+            for (auto selection : {BinSelection::FirstFit, BinSelection::BestFit}) {
+                configs.push_back(config{logic, rotation, selection});
+            }
+        }
+    }
+    for (auto heuristic : {SkylineHeuristic::BottomLeft, SkylineHeuristic::MinWaste}) {
+        for (auto rotation : {false, true}) {
+            configs.push_back(config{PackingLogic::MaxEdge, rotation, BinSelection::FirstFit, BinAlgorithm::Skyline, heuristic});
+        }
+    }
+    for (auto split : {GuillotineSplit::ShorterLeftoverAxis, GuillotineSplit::MinArea}) {
+        for (auto rotation : {false, true}) {
+            configs.push_back(config{PackingLogic::MaxEdge, rotation, BinSelection::FirstFit, BinAlgorithm::Guillotine, {}, split});
+        }
+    }
+    for (auto logic : {PackingLogic::MaxEdge, PackingLogic::BottomLeft}) {
+        configs.push_back(config{logic, true, BinSelection::FirstFit, BinAlgorithm::MaxRects, {}, {}, true});
+    }
+    for (auto shard : {ShardMode::RoundRobin, ShardMode::SizeClass}) {
+        configs.push_back(config{PackingLogic::MaxEdge, true, BinSelection::FirstFit, BinAlgorithm::MaxRects, {}, {}, false, shard});
+    }
+
+    auto results = std::vector<result>{};
+    std::printf("%-14s %-34s %12s %12s %10s %6s %10s\n", "workload", "config", "rects/s", "ns/insert", "peak_free", "bins", "occupancy");
+    for (const auto& load : workloads) {
+        auto engine = std::mt19937{20240531u};
+        auto rects = std::vector<Rectangle<float>>{};
+        rects.reserve(opts.count);
+        for (auto i = std::size_t{0}; i < opts.count; ++i) {
+            rects.push_back(load.generate(engine));
+        }
+        for (const auto& cfg : configs) {
+            const auto& r = results.emplace_back(measure(load, cfg, rects, opts.repeat));
+            std::printf("%-14s %-34s %12.0f %12.1f %10zu %6zu %10.4f\n", r.workload.c_str(), r.config.c_str(),
+                r.rects_per_sec, r.ns_per_insert, r.peak_free_rects, r.bins, r.occupancy);
+            
+            // Sharding trades bins for throughput, so report what it cost against the sequential pack.
+            if (cfg.shard != ShardMode::Off) {
+                auto sequential_cfg = cfg;
+                sequential_cfg.shard = ShardMode::Off;
+                const auto name = config_name(sequential_cfg);
+                const auto sequential = std::find_if(results.begin(), results.end(), [&](const auto& old) {
+                    return old.workload == r.workload && old.config == name;
+                });
+                if (sequential != results.end()) {
+                    std::printf("%-14s %-34s %+zd bins (%+.1f%%), %.2fx throughput vs %s\n", "", "shard overhead",
+                        static_cast<std::ptrdiff_t>(r.bins) - static_cast<std::ptrdiff_t>(sequential->bins),
+                        100.0 * (static_cast<double>(r.bins) / static_cast<double>(sequential->bins) - 1.0),
+                        r.rects_per_sec / sequential->rects_per_sec, name.c_str());
+                }
+            }
+        }
+    }
+
+    if (!opts.json_path.empty()) {
+        if (auto* out = std::fopen(opts.json_path.c_str(), "w")) {
+            write_json(results, out);
+            std::fclose(out);
+        } else {
+            std::fprintf(stderr, "cannot write %s\n", opts.json_path.c_str());
+            return 2;
+        }
+    }
+
+    if (!opts.baseline_path.empty()) {
+        const auto baseline = read_baseline(opts.baseline_path);
+        if (baseline.empty()) {
+            std::fprintf(stderr, "no results in baseline %s\n", opts.baseline_path.c_str());
+            return 2;
+        }
+        const auto regressions = compare(results, baseline, opts.tolerance);
+        std::printf("%zu regression(s) against %s\n", regressions, opts.baseline_path.c_str());
+        return regressions == 0 ? 0 : 1;
+    }
+    return 0;
+}
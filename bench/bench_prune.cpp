@@ -0,0 +1,135 @@
+#include "maxrects_bin.h"
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace MaxRects;
+
+namespace {
+
+    struct window_sample {
+        std::size_t inserted{};
+        std::size_t free_rects{};
+        double ns_per_insert{};
+    };
+
+    constexpr auto bin_edge = 8192.0f;
+    constexpr auto window = std::size_t{1000};
+    constexpr auto max_inserts = std::size_t{20000};
+    constexpr auto sweep_budget_ns = 2.0e6;
+
+    auto run(PruneMode mode, const std::vector<std::pair<float, float>>& sizes) -> std::vector<window_sample> {
+        auto opts = PackingOptions<float>{};
+        opts.smart = false;
+        opts.logic = PackingLogic::MaxArea;
+        opts.prune_mode = mode;
+        auto bin = MaxRectsBin<Rectangle<float>, float>{bin_edge, bin_edge, 0.0f, opts};
+        bin.rects.reserve(sizes.size());
+
+        auto samples = std::vector<window_sample>{};
+        for (auto start = std::size_t{0}; start < sizes.size(); start += window) {
+            const auto end = std::min(start + window, sizes.size());
+            const auto begin_time = std::chrono::steady_clock::now();
+            for (auto i = start; i < end; ++i) {
+                bin.add(sizes[i].first, sizes[i].second, std::any{});
+            }
+            const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin_time).count();
+            const auto sample = window_sample{end, bin.free_rect_count(), elapsed / static_cast<double>(end - start)};
+            samples.push_back(sample);
+            if (mode == PruneMode::Sweep && sample.ns_per_insert > sweep_budget_ns) {
+                break;
+            }
+        }
+        return samples;
+    }
+
+    // Times is_contained over n scattered free rects with the old fixed 8x8
+    // layout and with the layout fit_to picks for n.
+    auto grid_lookup(std::size_t count, bool fitted, std::mt19937& engine) -> std::pair<double, std::size_t> {
+        auto size = std::uniform_int_distribution<int>{2, 64};
+        auto position = std::uniform_real_distribution<float>{0.0f, bin_edge - 64.0f};
+        auto rects = std::vector<std::array<float, 4>>(count);
+        auto grid = FreeRectGrid<float>{};
+        if (fitted) {
+            grid.fit_to(bin_edge, bin_edge, count);
+        } else {
+            grid.configure(bin_edge, bin_edge, free_rect_grid_min_cells);
+        }
+        for (auto i = std::size_t{0}; i < count; ++i) {
+            rects[i] = {position(engine), position(engine), static_cast<float>(size(engine)), static_cast<float>(size(engine))};
+            grid.insert(static_cast<std::uint32_t>(i), rects[i][0], rects[i][1], rects[i][2], rects[i][3]);
+        }
+
+        auto contained = std::size_t{0};
+        const auto begin_time = std::chrono::steady_clock::now();
+        for (auto i = std::size_t{0}; i < count; ++i) {
+            contained += grid.is_contained(static_cast<std::uint32_t>(i), rects[i][0], rects[i][1], rects[i][2], rects[i][3]) ? 1 : 0;
+        }
+        const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin_time).count();
+        static volatile auto sink = std::size_t{0};
+        sink = sink + contained;
+        return {elapsed / static_cast<double>(count), grid.cell_count()};
+    }
+
+    auto crossover(const std::vector<window_sample>& slow, const std::vector<window_sample>& fast) -> const window_sample* {
+        const auto count = std::min(slow.size(), fast.size());
+        for (auto i = std::size_t{0}; i < count; ++i) {
+            if (fast[i].ns_per_insert < slow[i].ns_per_insert) {
+                return &fast[i];
+            }
+        }
+        return nullptr;
+    }
+
+}
+
+auto main() -> int {
+    auto engine = std::mt19937{20240531u};
+    auto edge = std::uniform_int_distribution<int>{2, 24};
+    auto sizes = std::vector<std::pair<float, float>>{};
+    sizes.reserve(max_inserts);
+    for (auto i = std::size_t{0}; i < max_inserts; ++i) {
+        sizes.emplace_back(static_cast<float>(edge(engine)), static_cast<float>(edge(engine)));
+    }
+
+    const auto modes = std::array{PruneMode::Sweep, PruneMode::Incremental, PruneMode::Grid};
+    const auto names = std::array{"sweep", "incremental", "grid"};
+    auto results = std::array<std::vector<window_sample>, 3>{};
+    for (auto m = std::size_t{0}; m < modes.size(); ++m) {
+        results[m] = run(modes[m], sizes);
+    }
+
+    std::printf("%10s %12s %14s %14s %14s\n", "inserted", "free_rects", "sweep_ns", "incremental_ns", "grid_ns");
+    for (auto i = std::size_t{0}; i < results[1].size(); ++i) {
+        std::printf("%10zu %12zu ", results[1][i].inserted, results[1][i].free_rects);
+        for (const auto& samples : results) {
+            if (i < samples.size()) {
+                std::printf("%14.0f ", samples[i].ns_per_insert);
+            } else {
+                std::printf("%14s ", "-");
+            }
+        }
+        std::printf("\n");
+    }
+
+    for (auto m = std::size_t{1}; m < modes.size(); ++m) {
+        for (auto baseline = std::size_t{0}; baseline < m; ++baseline) {
+            if (const auto* point = crossover(results[baseline], results[m])) {
+                std::printf("%s beats %s from %zu free rects (%zu inserts)\n",
+                    names[m], names[baseline], point->free_rects, point->inserted);
+            } else {
+                std::printf("%s never beats %s in this run\n", names[m], names[baseline]);
+            }
+        }
+    }
+
+    std::printf("\n%10s %14s %14s %14s\n", "free_rects", "fixed_8x8_ns", "fitted_ns", "fitted_cells");
+    for (const auto count : {std::size_t{1000}, std::size_t{4000}, std::size_t{16000}, std::size_t{64000}}) {
+        const auto fixed = grid_lookup(count, false, engine);
+        const auto fitted = grid_lookup(count, true, engine);
+        std::printf("%10zu %14.1f %14.1f %14zu\n", count, fixed.first, fitted.first, fitted.second);
+    }
+    return 0;
+}
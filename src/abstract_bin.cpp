@@ -1,26 +1,162 @@
 #include "abstract_bin.h"
 #include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <new>
+#include <type_traits>
 
 namespace MaxRects {
 
+	namespace {
+		struct AllocationHeader {
+			std::pmr::memory_resource* resource{};
+			std::size_t size{};
+		};
+
+		constexpr auto allocation_alignment = alignof(std::max_align_t);
+		constexpr auto header_size = (sizeof(AllocationHeader) + allocation_alignment - 1) / allocation_alignment * allocation_alignment;
+	}
+
+	template<typename RectType, typename Numeric>
+	AbstractBin<RectType, Numeric>::AbstractBin(Numeric max_w, Numeric max_h, const PackingOptions<Numeric>& opts,
+												std::pmr::memory_resource* resource)
+		: rects{resource}, max_width{max_w}, max_height{max_h}, width{max_w}, height{max_h}, options{opts}, dirty_counter{0},
+		rect_slots{resource}, unpacked_slots{resource}, reserved{resource}, memory_resource{resource} {
+	}
+
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::operator new(std::size_t size) -> void* {
+		return operator new(size, std::pmr::get_default_resource());
+	}
+
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::operator new(std::size_t size, std::pmr::memory_resource* resource) -> void* {
+		auto* raw = static_cast<std::byte*>(resource->allocate(header_size + size, allocation_alignment));
+		::new (static_cast<void*>(raw)) AllocationHeader{resource, header_size + size};
+		return raw + header_size;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::operator delete(void* pointer) noexcept -> void {
+		if (!pointer) {
+			return;
+		}
+		auto* raw = static_cast<std::byte*>(pointer) - header_size;
+		const auto header = *std::launder(reinterpret_cast<AllocationHeader*>(raw));
+		header.resource->deallocate(raw, header.size, allocation_alignment);
+	}
+
 	template<typename RectType, typename Numeric>
-	AbstractBin<RectType, Numeric>::AbstractBin(Numeric max_w, Numeric max_h, const PackingOptions<Numeric>& opts)
-		: max_width{max_w}, max_height{max_h}, width{max_w}, height{max_h}, options{opts}, dirty_counter{0} {
+	auto AbstractBin<RectType, Numeric>::operator delete(void* pointer, std::pmr::memory_resource* resource) noexcept -> void {
+		(void)resource;
+		operator delete(pointer);
 	}
+
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::clone() const -> std::unique_ptr<AbstractBin<RectType, Numeric>> {
+		return clone(memory_resource);
+	}
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::find_fit(const RectType& rect) const -> BinFit<Numeric> {
+		if (options.tag && options.exclusive_tag && tag_of(rect) != tag) {
+			return BinFit<Numeric>{};
+		}
+		return find_fit(rect.w, rect.h);
+	}
+
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::find_fit(Numeric w, Numeric h) const -> BinFit<Numeric> {
+		(void)w;
+		(void)h;
+		return BinFit<Numeric>{};
+	}
+
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::find_fits(std::span<const Size<Numeric>> sizes, std::span<CachedFit<Numeric>> fits,
+													ThreadPool* pool) const -> void {
+		(void)pool;
+		for (auto i = std::size_t{0}; i < sizes.size(); ++i) {
+			fits[i] = CachedFit<Numeric>{find_fit(sizes[i].w, sizes[i].h)};
+		}
+	}
+
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::commit_fit(RectType rect, const BinFit<Numeric>& fit) -> RectType* {
+		(void)rect;
+		(void)fit;
+		return nullptr;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::reserve_fit(const BinFit<Numeric>& fit) -> bool {
+		(void)fit;
+		return false;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::reserve(const BinFit<Numeric>& fit) -> bool {
+		if (!reserve_fit(fit)) {
+			return false;
+		}
+		reserved.push_back(Rectangle<Numeric>{fit.w, fit.h, fit.x, fit.y});
+		++revision;
+		return true;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::remove(std::size_t index) -> bool {
+		if (index >= rects.size()) {
+			return false;
+		}
+		rect_slots.resize(rects.size(), no_rect_slot);
+		if (index + 1 != rects.size()) {
+			rects[index] = std::move(rects.back());
+			rect_slots[index] = rect_slots.back();
+		}
+		rects.pop_back();
+		rect_slots.pop_back();
+		++revision;
+		return true;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::remove(const RectType& rect) -> bool {
+		if (rects.empty() || &rect < rects.data() || &rect >= rects.data() + rects.size()) {
+			return false;
+		}
+		return remove(static_cast<std::size_t>(&rect - rects.data()));
+	}
+
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::capacity() const noexcept -> BinCapacity<Numeric> {
+		constexpr auto unbounded = std::numeric_limits<Numeric>::max();
+		return BinCapacity<Numeric>{unbounded, unbounded, unbounded};
+	}
+
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::stats() const noexcept -> PackingStats {
+		return PackingStats{};
+	}
+
 	template<typename RectType, typename Numeric>
 	auto AbstractBin<RectType, Numeric>::is_dirty() const noexcept -> bool {
 		if (dirty_counter > std::size_t{0}) {
 			return true;
 		}
-		return std::any_of(rects.begin(), rects.end(), 
-			[](const auto& rect) { return rect.is_dirty(); 
-		});
+		if constexpr (std::is_same_v<RectType, Rectangle<Numeric>>) {
+			return std::any_of(rects.begin(), rects.end(), 
+				[](const auto& rect) { return rect.is_dirty(); 
+			});
+		} else {
+			return false;
+		}
 	}
 	template<typename RectType, typename Numeric>
 	auto AbstractBin<RectType, Numeric>::set_dirty(
 		bool is_dirty
 	) noexcept -> void {
 		dirty_counter = is_dirty ? dirty_counter + std::size_t{1} : std::size_t{0};
+		++revision;
 		
 		if (!is_dirty) {
 			if constexpr (std::is_same_v<RectType, Rectangle<Numeric>>) {
@@ -33,10 +169,12 @@ namespace MaxRects {
 	template<typename RectType, typename Numeric>
 	auto AbstractBin<RectType, Numeric>::reset() -> void {
 		if (rects.capacity() > 100) {
-			std::vector<RectType>{}.swap(rects);
+			std::pmr::vector<RectType>{rects.get_allocator()}.swap(rects);
 		} else {
 			rects.clear();
 		}
+		rect_slots.clear();
+		reserved.clear();
 		
 		width = max_width;
 		height = max_height;
@@ -48,6 +186,249 @@ namespace MaxRects {
 		this->calculate_max_dimensions();
 	}
 
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::next_power_of_two(Numeric value) noexcept -> Numeric {
+		if (value <= Numeric{}) return Numeric{1};
+		if constexpr (std::is_floating_point_v<Numeric>) {
+			return static_cast<Numeric>(std::pow(Numeric{2}, std::ceil(std::log2(value))));
+		} else {
+			Numeric power = Numeric{1};
+			while (power < value) {
+				power *= Numeric{2};
+			}
+			return power;
+		}
+	}
+
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::apply_extents(Numeric extent_x, Numeric extent_y) -> void {
+		if (options.pot) {
+			width = next_power_of_two(extent_x);
+			height = next_power_of_two(extent_y);
+		} else {
+			width = extent_x;
+			height = extent_y;
+		}
+		
+		if (options.square) {
+			const auto max_dimension = std::max(width, height);
+			width = max_dimension;
+			height = max_dimension;
+		}
+	}
+
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::content_extents() const noexcept -> std::pair<Numeric, Numeric> {
+		auto extent_x = Numeric{};
+		auto extent_y = Numeric{};
+		for (const auto& rect : rects) {
+			extent_x = std::max(extent_x, static_cast<Numeric>(rect.x + rect.w));
+			extent_y = std::max(extent_y, static_cast<Numeric>(rect.y + rect.h));
+		}
+		for (const auto& region : reserved) {
+			extent_x = std::max(extent_x, region.x + region.w);
+			extent_y = std::max(extent_y, region.y + region.h);
+		}
+		return {extent_x, extent_y};
+	}
+
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::save(SnapshotWriter& writer, const SnapshotPayloadWriter<RectType>& payload) const -> bool {
+		(void)writer;
+		(void)payload;
+		return false;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::restore(const SnapshotReader& reader, std::size_t first_section,
+												const SnapshotPayloadReader<RectType>& payload) -> bool {
+		(void)reader;
+		(void)first_section;
+		(void)payload;
+		return false;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::save_common(SnapshotWriter& writer, SnapshotBin<Numeric> info,
+													const SnapshotPayloadWriter<RectType>& payload) const -> void {
+		info.flags |= is_dirty() ? snapshot_bin_dirty : 0u;
+		info.tag = tag.value;
+		info.width = width;
+		info.height = height;
+		info.max_width = max_width;
+		info.max_height = max_height;
+		info.options = to_snapshot(options);
+		writer.add(info);
+		
+		auto records = std::pmr::vector<SnapshotRect<Numeric>>{memory_resource};
+		records.reserve(rects.size());
+		for (const auto& rect : rects) {
+			auto record = SnapshotRect<Numeric>{static_cast<Numeric>(rect.x), static_cast<Numeric>(rect.y),
+				static_cast<Numeric>(rect.w), static_cast<Numeric>(rect.h)};
+			record.flags = rect.rot ? snapshot_rect_rotated : 0u;
+			if constexpr (std::is_same_v<RectType, Rectangle<Numeric>>) {
+				record.flags |= (rect.allow_rotation ? snapshot_rect_allow_rotation : 0u) |
+					(rect.oversized ? snapshot_rect_oversized : 0u);
+				record.tag = rect.tag.value;
+			} else {
+				record.index = rect.index;
+			}
+			records.push_back(record);
+		}
+		writer.add(std::span<const SnapshotRect<Numeric>>{records});
+		
+		auto slots = std::pmr::vector<std::uint32_t>{rect_slots, memory_resource};
+		slots.resize(rects.size(), no_rect_slot);
+		writer.add(std::span<const std::uint32_t>{slots});
+		
+		auto offsets = std::pmr::vector<std::uint64_t>{memory_resource};
+		auto bytes = std::pmr::vector<std::byte>{memory_resource};
+		if (payload) {
+			offsets.reserve(rects.size() + 1);
+			offsets.push_back(0);
+			for (const auto& rect : rects) {
+				payload(rect, bytes);
+				offsets.push_back(bytes.size());
+			}
+		}
+		writer.add(std::span<const std::uint64_t>{offsets});
+		writer.add(std::span<const std::byte>{bytes});
+		
+		auto regions = std::pmr::vector<SnapshotRect<Numeric>>{memory_resource};
+		regions.reserve(reserved.size());
+		for (const auto& region : reserved) {
+			regions.push_back(SnapshotRect<Numeric>{region.x, region.y, region.w, region.h});
+		}
+		writer.add(std::span<const SnapshotRect<Numeric>>{regions});
+	}
+
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::can_restore_common(const SnapshotReader& reader, std::size_t first_section,
+															SnapshotBinKind kind) const noexcept -> bool {
+		const auto info = reader.section<SnapshotBin<Numeric>>(snapshot_index(first_section, SnapshotSection::Bin));
+		if (info.size() != 1 || info[0].kind != kind) {
+			return false;
+		}
+		const auto count = reader.section<SnapshotRect<Numeric>>(snapshot_index(first_section, SnapshotSection::Rects)).size();
+		const auto offsets = reader.section<std::uint64_t>(snapshot_index(first_section, SnapshotSection::PayloadOffsets));
+		const auto payload = reader.section<std::byte>(snapshot_index(first_section, SnapshotSection::Payload));
+		if (reader.section<std::uint32_t>(snapshot_index(first_section, SnapshotSection::Slots)).size() != count) {
+			return false;
+		}
+		if (offsets.empty()) {
+			return payload.empty();
+		}
+		if (offsets.size() != count + 1 || offsets.front() != 0 || offsets.back() != payload.size()) {
+			return false;
+		}
+		return std::is_sorted(offsets.begin(), offsets.end());
+	}
+
+	template<typename RectType, typename Numeric>
+	auto AbstractBin<RectType, Numeric>::restore_common(const SnapshotReader& reader, std::size_t first_section,
+													const SnapshotPayloadReader<RectType>& payload) -> void {
+		const auto& info = reader.section<SnapshotBin<Numeric>>(snapshot_index(first_section, SnapshotSection::Bin))[0];
+		const auto records = reader.section<SnapshotRect<Numeric>>(snapshot_index(first_section, SnapshotSection::Rects));
+		const auto slots = reader.section<std::uint32_t>(snapshot_index(first_section, SnapshotSection::Slots));
+		const auto offsets = reader.section<std::uint64_t>(snapshot_index(first_section, SnapshotSection::PayloadOffsets));
+		const auto bytes = reader.section<std::byte>(snapshot_index(first_section, SnapshotSection::Payload));
+		const auto regions = reader.section<SnapshotRect<Numeric>>(snapshot_index(first_section, SnapshotSection::Reserved));
+		
+		width = info.width;
+		height = info.height;
+		max_width = info.max_width;
+		max_height = info.max_height;
+		options = from_snapshot(info.options);
+		tag = TagKey{info.tag};
+		
+		rects.clear();
+		rects.reserve(records.size());
+		for (auto i = std::size_t{0}; i < records.size(); ++i) {
+			const auto& record = records[i];
+			auto& rect = rects.emplace_back();
+			if constexpr (std::is_same_v<RectType, Rectangle<Numeric>>) {
+				rect.w = record.w;
+				rect.h = record.h;
+				rect.x = record.x;
+				rect.y = record.y;
+				rect.allow_rotation = (record.flags & snapshot_rect_allow_rotation) != 0;
+				rect.oversized = (record.flags & snapshot_rect_oversized) != 0;
+				rect.tag = TagKey{record.tag};
+			} else {
+				using Coord = decltype(rect.w);
+				rect.w = static_cast<Coord>(record.w);
+				rect.h = static_cast<Coord>(record.h);
+				rect.x = static_cast<Coord>(record.x);
+				rect.y = static_cast<Coord>(record.y);
+				rect.index = record.index;
+			}
+			rect.rot = (record.flags & snapshot_rect_rotated) != 0;
+			if (payload && !offsets.empty()) {
+				payload(rect, bytes.subspan(static_cast<std::size_t>(offsets[i]), static_cast<std::size_t>(offsets[i + 1] - offsets[i])));
+			}
+		}
+		rect_slots.assign(slots.begin(), slots.end());
+		unpacked_slots.clear();
+		reserved.clear();
+		reserved.reserve(regions.size());
+		for (const auto& region : regions) {
+			reserved.emplace_back(region.w, region.h, region.x, region.y);
+		}
+		set_dirty(false);
+		if ((info.flags & snapshot_bin_dirty) != 0) {
+			set_dirty(true);
+		}
+	}
+
+	template<typename Numeric>
+	auto to_snapshot(const PackingOptions<Numeric>& options) noexcept -> SnapshotOptions<Numeric> {
+		const auto flags = std::array{options.smart, options.pot, options.square, options.allow_rotation, options.tag,
+			options.exclusive_tag, options.best_of, options.global_fit, options.deterministic};
+		auto saved = SnapshotOptions<Numeric>{};
+		for (auto bit = std::size_t{0}; bit < flags.size(); ++bit) {
+			saved.flags |= flags[bit] ? 1u << bit : 0u;
+		}
+		saved.logic = static_cast<std::uint8_t>(options.logic);
+		saved.prune_mode = static_cast<std::uint8_t>(options.prune_mode);
+		saved.sort = static_cast<std::uint8_t>(options.sort);
+		saved.bin_selection = static_cast<std::uint8_t>(options.bin_selection);
+		saved.bin_algorithm = static_cast<std::uint8_t>(options.bin_algorithm);
+		saved.skyline = static_cast<std::uint8_t>(options.skyline);
+		saved.guillotine_split = static_cast<std::uint8_t>(options.guillotine_split);
+		saved.shard = static_cast<std::uint8_t>(options.shard);
+		saved.threads = options.threads;
+		saved.shards = options.shards;
+		saved.border = options.border;
+		return saved;
+	}
+
+	template<typename Numeric>
+	auto from_snapshot(const SnapshotOptions<Numeric>& saved) noexcept -> PackingOptions<Numeric> {
+		const auto flag = [&](std::size_t bit) { return (saved.flags & (1u << bit)) != 0; };
+		auto options = PackingOptions<Numeric>{};
+		options.smart = flag(0);
+		options.pot = flag(1);
+		options.square = flag(2);
+		options.allow_rotation = flag(3);
+		options.tag = flag(4);
+		options.exclusive_tag = flag(5);
+		options.best_of = flag(6);
+		options.global_fit = flag(7);
+		options.deterministic = flag(8);
+		options.logic = static_cast<PackingLogic>(saved.logic);
+		options.prune_mode = static_cast<PruneMode>(saved.prune_mode);
+		options.sort = static_cast<SortOrder>(saved.sort);
+		options.bin_selection = static_cast<BinSelection>(saved.bin_selection);
+		options.bin_algorithm = static_cast<BinAlgorithm>(saved.bin_algorithm);
+		options.skyline = static_cast<SkylineHeuristic>(saved.skyline);
+		options.guillotine_split = static_cast<GuillotineSplit>(saved.guillotine_split);
+		options.shard = static_cast<ShardMode>(saved.shard);
+		options.threads = static_cast<std::size_t>(saved.threads);
+		options.shards = static_cast<std::size_t>(saved.shards);
+		options.border = saved.border;
+		return options;
+	}
+
 
 	template class AbstractBin<Rectangle<float>, float>;
 
@@ -55,4 +436,20 @@ namespace MaxRects {
 
 	template class AbstractBin<Rectangle<int>, int>;
 
+	template class AbstractBin<CompactRect<std::int16_t>, int>;
+
+	template class AbstractBin<CompactRect<std::int32_t>, int>;
+
+	template auto to_snapshot(const PackingOptions<float>&) noexcept -> SnapshotOptions<float>;
+
+	template auto to_snapshot(const PackingOptions<double>&) noexcept -> SnapshotOptions<double>;
+
+	template auto to_snapshot(const PackingOptions<int>&) noexcept -> SnapshotOptions<int>;
+
+	template auto from_snapshot(const SnapshotOptions<float>&) noexcept -> PackingOptions<float>;
+
+	template auto from_snapshot(const SnapshotOptions<double>&) noexcept -> PackingOptions<double>;
+
+	template auto from_snapshot(const SnapshotOptions<int>&) noexcept -> PackingOptions<int>;
+
 }
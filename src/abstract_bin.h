@@ -1,17 +1,81 @@
 #pragma once
 
 #include "rectangle.h"
+#include "compact_rect.h"
+#include "packing_stats.h"
+#include "rect_slot_map.h"
+#include "snapshot.h"
+#include <array>
 #include <vector>
 #include <memory>
 #include <any>
+#include <memory_resource>
+#include <limits>
+#include <span>
 #include <string>
+#include <utility>
 
 namespace MaxRects {
 
 	enum struct PackingLogic : std::uint8_t {
 		MaxArea = 0,
 		MaxEdge = 1,
-		FillWidth = 2
+		FillWidth = 2,
+		BottomLeft = 3,
+		ContactPoint = 4
+	};
+
+	constexpr auto packing_logics = std::array{
+		PackingLogic::MaxArea,
+		PackingLogic::MaxEdge,
+		PackingLogic::FillWidth,
+		PackingLogic::BottomLeft,
+		PackingLogic::ContactPoint
+	};
+
+	enum struct SortOrder : std::uint8_t {
+		Auto = 0,
+		MaxEdge = 1,
+		Area = 2
+	};
+
+	enum struct PruneMode : std::uint8_t {
+		Sweep = 0,
+		Incremental = 1,
+		Grid = 2
+	};
+
+	enum struct BinSelection : std::uint8_t {
+		FirstFit = 0,
+		BestFit = 1
+	};
+
+	enum struct BinAlgorithm : std::uint8_t {
+		MaxRects = 0,
+		Skyline = 1,
+		Guillotine = 2
+	};
+
+	enum struct SkylineHeuristic : std::uint8_t {
+		BottomLeft = 0,
+		MinWaste = 1
+	};
+
+	enum struct GuillotineSplit : std::uint8_t {
+		ShorterLeftoverAxis = 0,
+		LongerLeftoverAxis = 1,
+		MinArea = 2,
+		MaxArea = 3
+	};
+
+	// How add_array splits its sorted input when packing shards in parallel.
+	// SizeClass cuts it into runs of equal area, RoundRobin deals the rects
+	// out in turn, and Tag gives every tag a shard of its own.
+	enum struct ShardMode : std::uint8_t {
+		Off = 0,
+		RoundRobin = 1,
+		SizeClass = 2,
+		Tag = 3
 	};
 
 	template<typename Numeric = float>
@@ -24,32 +88,181 @@ namespace MaxRects {
 		bool exclusive_tag{true};
 		Numeric border{Numeric{}};
 		PackingLogic logic{PackingLogic::MaxEdge};
+		PruneMode prune_mode{PruneMode::Incremental};
+		SortOrder sort{SortOrder::Auto};
+		bool best_of{false};
+		std::size_t threads{0};
+		BinSelection bin_selection{BinSelection::FirstFit};
+		BinAlgorithm bin_algorithm{BinAlgorithm::MaxRects};
+		SkylineHeuristic skyline{SkylineHeuristic::BottomLeft};
+		GuillotineSplit guillotine_split{GuillotineSplit::ShorterLeftoverAxis};
+		bool global_fit{false};
+		ShardMode shard{ShardMode::Off};
+		std::size_t shards{0};
+		// Every parallel path already merges its results in a fixed order;
+		// this also keeps choices like the default shard count from following
+		// the number of workers, so any thread count gives the same layout.
+		bool deterministic{false};
+	};
+
+	template<typename Numeric = float>
+	struct BinFit {
+		Numeric x{Numeric{}};
+		Numeric y{Numeric{}};
+		Numeric w{Numeric{}};
+		Numeric h{Numeric{}};
+		Numeric primary{std::numeric_limits<Numeric>::max()};
+		Numeric secondary{std::numeric_limits<Numeric>::max()};
+		bool rotated{false};
+		bool found{false};
+
+		[[nodiscard]] constexpr auto better_than(const BinFit& other) const noexcept -> bool {
+			return found && (!other.found || primary < other.primary ||
+				(primary == other.primary && secondary < other.secondary));
+		}
+	};
+
+	// A fit kept between find_fits calls for the same size. Bins that know
+	// which of their free space changed since it was scored only rescore
+	// that part; a default-constructed entry is always scored from scratch.
+	template<typename Numeric = float>
+	struct CachedFit {
+		BinFit<Numeric> fit{};
+		std::uint32_t region{};
+		std::uint32_t watermark{};
+		std::uint32_t version{};
+	};
+
+	// A bare size for the batch API: packs without constructing a RectType.
+	template<typename Numeric = float>
+	struct Size {
+		Numeric w{Numeric{}};
+		Numeric h{Numeric{}};
+
+		[[nodiscard]] constexpr auto area() const noexcept -> Numeric {
+			return w * h;
+		}
+	};
+
+	constexpr std::size_t no_bin = std::numeric_limits<std::size_t>::max();
+
+	template<typename Numeric = float>
+	struct Placement {
+		std::size_t bin{no_bin};
+		Numeric x{Numeric{}};
+		Numeric y{Numeric{}};
+		bool rotated{false};
+
+		[[nodiscard]] constexpr auto placed() const noexcept -> bool {
+			return bin != no_bin;
+		}
+	};
+
+	// Upper bound on what a bin can still take: no free rect is wider than
+	// max_w, taller than max_h or larger than max_area.
+	template<typename Numeric = float>
+	struct BinCapacity {
+		Numeric max_w{Numeric{}};
+		Numeric max_h{Numeric{}};
+		Numeric max_area{Numeric{}};
+
+		[[nodiscard]] constexpr auto admits(Numeric w, Numeric h) const noexcept -> bool {
+			return w <= max_w && h <= max_h && w * h <= max_area;
+		}
 	};
 
+	template<typename Numeric>
+	[[nodiscard]] auto to_snapshot(const PackingOptions<Numeric>& options) noexcept -> SnapshotOptions<Numeric>;
+
+	template<typename Numeric>
+	[[nodiscard]] auto from_snapshot(const SnapshotOptions<Numeric>& options) noexcept -> PackingOptions<Numeric>;
+
+	template<typename RectType, typename Numeric>
+	[[nodiscard]] constexpr auto snapshot_format() noexcept -> SnapshotFormat {
+		const auto kind = std::is_same_v<RectType, Rectangle<Numeric>> ? SnapshotRectKind::Rectangle : SnapshotRectKind::Compact;
+		return snapshot_format<Numeric>(kind, sizeof(RectType::x));
+	}
+
+	class ThreadPool;
+
 	template<typename RectType = Rectangle<float>, typename Numeric = float>
 	class AbstractBin {
 	public:
-		std::vector<RectType> rects{};
+		std::pmr::vector<RectType> rects{};
 		Numeric width{Numeric{}};
 		Numeric height{Numeric{}};
 		Numeric max_width{Numeric{}};
 		Numeric max_height{Numeric{}};
 		PackingOptions<Numeric> options{};
-		std::any tag{};
+		TagKey tag{};
 		std::size_t dirty_counter{std::size_t{}};
+		// Bumped by every change to the rects or reserved regions, so an owner
+		// caching capacity() can tell when its copy went stale.
+		std::size_t revision{std::size_t{}};
+		// Handle slot of each entry in rects, and of each rect returned by the
+		// last repack(); no_rect_slot for rects added outside a packer.
+		std::pmr::vector<std::uint32_t> rect_slots{};
+		std::pmr::vector<std::uint32_t> unpacked_slots{};
+		// Regions taken by reserve() for placements the caller owns. They hold
+		// no rect, but repack() keeps them occupied and they count toward the
+		// bin's extents.
+		std::pmr::vector<Rectangle<Numeric>> reserved{};
+		std::pmr::memory_resource* memory_resource{std::pmr::get_default_resource()};
 
 		explicit AbstractBin(Numeric w = Numeric{}, Numeric h = Numeric{},
-							const PackingOptions<Numeric>& opts = {});
+							const PackingOptions<Numeric>& opts = {},
+							std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
 		virtual ~AbstractBin() = default;
 
+		// Bins remember the resource they were allocated from, so a plain
+		// std::unique_ptr can own a bin placed with new (resource).
+		static auto operator new(std::size_t size) -> void*;
+
+		static auto operator new(std::size_t size, std::pmr::memory_resource* resource) -> void*;
+
+		static auto operator delete(void* pointer) noexcept -> void;
+
+		static auto operator delete(void* pointer, std::pmr::memory_resource* resource) noexcept -> void;
+
 		virtual auto add(const RectType& rect) -> RectType* = 0;
 		
 		virtual auto add(RectType&& rect) -> RectType* = 0;
 
-		virtual auto repack() -> std::vector<RectType> = 0;
+		[[nodiscard]] auto find_fit(const RectType& rect) const -> BinFit<Numeric>;
+
+		[[nodiscard]] virtual auto find_fit(Numeric w, Numeric h) const -> BinFit<Numeric>;
+
+		// Scores many sizes against the current free space at once, refreshing
+		// the entry at the same index. Bins that can score concurrently split
+		// the work across pool when it is given.
+		virtual auto find_fits(std::span<const Size<Numeric>> sizes, std::span<CachedFit<Numeric>> fits,
+								ThreadPool* pool = nullptr) const -> void;
+
+		virtual auto commit_fit(RectType rect, const BinFit<Numeric>& fit) -> RectType*;
 
-		virtual auto clone() const -> std::unique_ptr<AbstractBin<RectType, Numeric>> = 0;
+		// Occupies the region of a fit without storing a rect or remembering
+		// it; commit_fit builds on this.
+		virtual auto reserve_fit(const BinFit<Numeric>& fit) -> bool;
+
+		// Occupies the region of a fit for a placement the caller owns and
+		// adds it to reserved, so repack() never hands it to a rect.
+		auto reserve(const BinFit<Numeric>& fit) -> bool;
+
+		// Takes the rect out of the bin; the last rect moves into its index.
+		virtual auto remove(std::size_t index) -> bool;
+
+		auto remove(const RectType& rect) -> bool;
+
+		[[nodiscard]] virtual auto capacity() const noexcept -> BinCapacity<Numeric>;
+
+		[[nodiscard]] virtual auto stats() const noexcept -> PackingStats;
+
+		virtual auto repack() -> std::pmr::vector<RectType> = 0;
+
+		virtual auto clone(std::pmr::memory_resource* resource) const -> std::unique_ptr<AbstractBin<RectType, Numeric>> = 0;
+
+		auto clone() const -> std::unique_ptr<AbstractBin<RectType, Numeric>>;
 
 		[[nodiscard]] virtual auto is_dirty() const noexcept -> bool;
 
@@ -59,8 +272,37 @@ namespace MaxRects {
 
 		auto update_size() -> void;
 
+		[[nodiscard]] static auto next_power_of_two(Numeric value) noexcept -> Numeric;
+
+		// Appends the bin's snapshot_bin_sections sections to writer. Bin
+		// types without a snapshot form write nothing and return false.
+		virtual auto save(SnapshotWriter& writer, const SnapshotPayloadWriter<RectType>& payload = {}) const -> bool;
+
+		// Reads back a bin whose sections start at first_section. Nothing is
+		// changed when they do not describe a bin of this type.
+		virtual auto restore(const SnapshotReader& reader, std::size_t first_section,
+							const SnapshotPayloadReader<RectType>& payload = {}) -> bool;
+
 	protected:
 		virtual auto calculate_max_dimensions() -> void = 0;
+
+		// Sizes a smart bin to the extents of its contents, rounded up to a
+		// power of two and squared as the options ask.
+		auto apply_extents(Numeric extent_x, Numeric extent_y) -> void;
+
+		// Far edges of the rects and reserved regions together.
+		[[nodiscard]] auto content_extents() const noexcept -> std::pair<Numeric, Numeric>;
+
+		// Fills in the fields every bin shares and writes info followed by the
+		// rect, slot, payload and reserved sections.
+		auto save_common(SnapshotWriter& writer, SnapshotBin<Numeric> info,
+						const SnapshotPayloadWriter<RectType>& payload) const -> void;
+
+		[[nodiscard]] auto can_restore_common(const SnapshotReader& reader, std::size_t first_section,
+											SnapshotBinKind kind) const noexcept -> bool;
+
+		auto restore_common(const SnapshotReader& reader, std::size_t first_section,
+							const SnapshotPayloadReader<RectType>& payload) -> void;
 	};
 
 }
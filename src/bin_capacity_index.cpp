@@ -0,0 +1,106 @@
+#include "bin_capacity_index.h"
+#include <algorithm>
+
+namespace MaxRects {
+
+	namespace {
+		template<typename Numeric>
+		constexpr auto merge(const BinCapacity<Numeric>& a, const BinCapacity<Numeric>& b) noexcept -> BinCapacity<Numeric> {
+			return BinCapacity<Numeric>{std::max(a.max_w, b.max_w), std::max(a.max_h, b.max_h), std::max(a.max_area, b.max_area)};
+		}
+
+		template<typename Numeric>
+		constexpr auto fits(const BinCapacity<Numeric>& capacity, Numeric width, Numeric height, bool allow_rotation) noexcept -> bool {
+			return capacity.admits(width, height) || (allow_rotation && capacity.admits(height, width));
+		}
+	}
+
+	template<typename Numeric>
+	BinCapacityIndex<Numeric>::BinCapacityIndex(std::pmr::memory_resource* resource)
+		: nodes{resource} {
+	}
+
+	template<typename Numeric>
+	auto BinCapacityIndex<Numeric>::size() const noexcept -> std::size_t {
+		return count;
+	}
+
+	template<typename Numeric>
+	auto BinCapacityIndex<Numeric>::clear() noexcept -> void {
+		std::fill(nodes.begin(), nodes.end(), BinCapacity<Numeric>{});
+		count = std::size_t{0};
+	}
+
+	template<typename Numeric>
+	auto BinCapacityIndex<Numeric>::push_back(const BinCapacity<Numeric>& capacity) -> void {
+		if (count == leaf_count) {
+			grow();
+		}
+		assign(count++, capacity);
+	}
+
+	template<typename Numeric>
+	auto BinCapacityIndex<Numeric>::assign(std::size_t index, const BinCapacity<Numeric>& capacity) noexcept -> void {
+		const auto node = leaf_count + index;
+		nodes[node] = capacity;
+		update_parents(node);
+	}
+
+	template<typename Numeric>
+	auto BinCapacityIndex<Numeric>::admits(std::size_t index, Numeric width, Numeric height, bool allow_rotation) const noexcept -> bool {
+		return index < count && fits(nodes[leaf_count + index], width, height, allow_rotation);
+	}
+
+	template<typename Numeric>
+	auto BinCapacityIndex<Numeric>::find_first(std::size_t from, Numeric width, Numeric height, bool allow_rotation) const noexcept -> std::size_t {
+		if (from >= count) {
+			return npos;
+		}
+		return find_first(std::size_t{1}, std::size_t{0}, leaf_count, from, width, height, allow_rotation);
+	}
+
+	template<typename Numeric>
+	auto BinCapacityIndex<Numeric>::grow() -> void {
+		const auto new_leaf_count = std::max(leaf_count * std::size_t{2}, std::size_t{16});
+		auto grown = std::pmr::vector<BinCapacity<Numeric>>(new_leaf_count * std::size_t{2}, nodes.get_allocator());
+		std::copy_n(nodes.begin() + static_cast<std::ptrdiff_t>(leaf_count), count,
+					grown.begin() + static_cast<std::ptrdiff_t>(new_leaf_count));
+		for (auto node = new_leaf_count - std::size_t{1}; node > std::size_t{0}; --node) {
+			grown[node] = merge(grown[node * std::size_t{2}], grown[node * std::size_t{2} + std::size_t{1}]);
+		}
+		nodes = std::move(grown);
+		leaf_count = new_leaf_count;
+	}
+
+	template<typename Numeric>
+	auto BinCapacityIndex<Numeric>::update_parents(std::size_t node) noexcept -> void {
+		for (node /= std::size_t{2}; node > std::size_t{0}; node /= std::size_t{2}) {
+			nodes[node] = merge(nodes[node * std::size_t{2}], nodes[node * std::size_t{2} + std::size_t{1}]);
+		}
+	}
+
+	template<typename Numeric>
+	auto BinCapacityIndex<Numeric>::find_first(std::size_t node, std::size_t first, std::size_t last, std::size_t from,
+											Numeric width, Numeric height, bool allow_rotation) const noexcept -> std::size_t {
+		if (last <= from || first >= count || !fits(nodes[node], width, height, allow_rotation)) {
+			return npos;
+		}
+		if (last - first == std::size_t{1}) {
+			return first;
+		}
+		const auto middle = first + (last - first) / std::size_t{2};
+		const auto found = find_first(node * std::size_t{2}, first, middle, from, width, height, allow_rotation);
+		if (found != npos) {
+			return found;
+		}
+		return find_first(node * std::size_t{2} + std::size_t{1}, middle, last, from, width, height, allow_rotation);
+	}
+
+
+	template class BinCapacityIndex<float>;
+
+	template class BinCapacityIndex<double>;
+
+	template class BinCapacityIndex<int>;
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "abstract_bin.h"
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <vector>
+
+namespace MaxRects {
+
+	// Segment tree over bin indices. Every node holds the component-wise max
+	// of the capacities below it, so whole runs of bins that cannot take a
+	// rect are skipped without visiting them.
+	template<typename Numeric = float>
+	class BinCapacityIndex {
+	public:
+		static constexpr auto npos = std::numeric_limits<std::size_t>::max();
+
+		BinCapacityIndex() = default;
+
+		explicit BinCapacityIndex(std::pmr::memory_resource* resource);
+
+		[[nodiscard]] auto size() const noexcept -> std::size_t;
+
+		auto clear() noexcept -> void;
+
+		auto push_back(const BinCapacity<Numeric>& capacity) -> void;
+
+		auto assign(std::size_t index, const BinCapacity<Numeric>& capacity) noexcept -> void;
+
+		[[nodiscard]] auto admits(std::size_t index, Numeric width, Numeric height, bool allow_rotation) const noexcept -> bool;
+
+		[[nodiscard]] auto find_first(std::size_t from, Numeric width, Numeric height, bool allow_rotation) const noexcept -> std::size_t;
+
+	private:
+		std::pmr::vector<BinCapacity<Numeric>> nodes{};
+		std::size_t leaf_count{};
+		std::size_t count{};
+
+		auto grow() -> void;
+
+		auto update_parents(std::size_t node) noexcept -> void;
+
+		[[nodiscard]] auto find_first(std::size_t node, std::size_t first, std::size_t last, std::size_t from,
+									Numeric width, Numeric height, bool allow_rotation) const noexcept -> std::size_t;
+	};
+
+}
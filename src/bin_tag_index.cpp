@@ -0,0 +1,30 @@
+#include "bin_tag_index.h"
+
+namespace MaxRects {
+
+	BinTagIndex::BinTagIndex(std::pmr::memory_resource* resource)
+		: bins{resource} {
+	}
+
+	auto BinTagIndex::size() const noexcept -> std::size_t {
+		return count;
+	}
+
+	auto BinTagIndex::clear() noexcept -> void {
+		bins.clear();
+		count = std::size_t{0};
+	}
+
+	auto BinTagIndex::push_back(TagKey tag) -> void {
+		bins[tag].push_back(count++);
+	}
+
+	auto BinTagIndex::bins_of(TagKey tag) const noexcept -> std::span<const std::size_t> {
+		const auto it = bins.find(tag);
+		if (it == bins.end()) {
+			return {};
+		}
+		return it->second;
+	}
+
+}
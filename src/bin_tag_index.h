@@ -0,0 +1,33 @@
+#pragma once
+
+#include "tag_key.h"
+#include <cstddef>
+#include <memory_resource>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace MaxRects {
+
+	// Bin indices grouped by tag in ascending order, so routing a tagged rect
+	// only probes the bins of its own tag.
+	class BinTagIndex {
+	public:
+		BinTagIndex() = default;
+
+		explicit BinTagIndex(std::pmr::memory_resource* resource);
+
+		[[nodiscard]] auto size() const noexcept -> std::size_t;
+
+		auto clear() noexcept -> void;
+
+		auto push_back(TagKey tag) -> void;
+
+		[[nodiscard]] auto bins_of(TagKey tag) const noexcept -> std::span<const std::size_t>;
+
+	private:
+		std::pmr::unordered_map<TagKey, std::pmr::vector<std::size_t>, TagKeyHash> bins{};
+		std::size_t count{};
+	};
+
+}
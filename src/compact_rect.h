@@ -0,0 +1,36 @@
+#pragma once
+
+#include "rectangle.h"
+#include <cstdint>
+
+namespace MaxRects {
+
+	// Geometry-only rectangle for high-volume jobs. User data is replaced by a
+	// full 32-bit index into the caller's own storage, and the rotation flag
+	// takes the padding after it, so CompactRect<std::int16_t> is 16 bytes and
+	// CompactRect<std::int32_t> is 24. Coordinates must fit in Coord.
+	template<typename Coord = std::int32_t>
+	struct CompactRect {
+		Coord w{};
+		Coord h{};
+		Coord x{};
+		Coord y{};
+		std::uint32_t index{};
+		bool rot{false};
+
+		constexpr CompactRect() noexcept = default;
+
+		template<number_type Numeric>
+		constexpr CompactRect(Numeric width, Numeric height, std::uint32_t user_index = 0) noexcept
+			: w{static_cast<Coord>(width)}, h{static_cast<Coord>(height)}, index{user_index} {}
+
+		[[nodiscard]] constexpr auto area() const noexcept -> std::int64_t {
+			return std::int64_t{w} * std::int64_t{h};
+		}
+
+		[[nodiscard]] constexpr auto operator==(const CompactRect& other) const noexcept -> bool {
+			return w == other.w && h == other.h && x == other.x && y == other.y;
+		}
+	};
+
+}
@@ -0,0 +1,254 @@
+#include "free_node_tree.h"
+#include <algorithm>
+
+namespace MaxRects {
+
+	template<typename Numeric>
+	FreeNodeTree<Numeric>::const_iterator::const_iterator(const FreeNodeTree* tree, std::uint32_t slot) noexcept
+		: tree{tree}, slot{slot} {
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::const_iterator::operator*() const noexcept -> reference {
+		return tree->slots[slot].node;
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::const_iterator::operator->() const noexcept -> pointer {
+		return &tree->slots[slot].node;
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::const_iterator::operator++() noexcept -> const_iterator& {
+		slot = tree->next_live(slot + std::uint32_t{1});
+		return *this;
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::const_iterator::operator++(int) noexcept -> const_iterator {
+		auto previous = *this;
+		++*this;
+		return previous;
+	}
+
+	template<typename Numeric>
+	FreeNodeTree<Numeric>::FreeNodeTree(std::pmr::memory_resource* resource)
+		: slots{resource}, vacant{resource} {
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::size() const noexcept -> std::size_t {
+		return live_count;
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::empty() const noexcept -> bool {
+		return live_count == 0;
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::clear() noexcept -> void {
+		slots.clear();
+		vacant.clear();
+		root = none;
+		live_count = 0;
+		seed = 0;
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::insert(const Node& node) -> void {
+		auto slot = std::uint32_t{};
+		if (vacant.empty()) {
+			slot = static_cast<std::uint32_t>(slots.size());
+			slots.emplace_back();
+		} else {
+			slot = vacant.back();
+			vacant.pop_back();
+		}
+		// A fixed integer hash of a counter keeps the shape, and so every
+		// lookup, identical between runs and between a bin and its clone.
+		auto hash = ++seed * 0x9E3779B9u;
+		hash ^= hash >> 16;
+		hash *= 0x85EBCA6Bu;
+		hash ^= hash >> 13;
+		slots[slot] = Slot{node, node.h, node.w * node.h, none, none, hash, true};
+		root = insert_at(root, slot);
+		++live_count;
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::erase(const_iterator position) -> const_iterator {
+		const auto slot = position.slot;
+		root = erase_at(root, slots[slot].node);
+		slots[slot].live = false;
+		vacant.push_back(slot);
+		--live_count;
+		return const_iterator{this, next_live(slot + std::uint32_t{1})};
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::find(Numeric w, Numeric h, std::size_t& visited) const noexcept -> const_iterator {
+		const auto slot = first_fit(root, w, h, visited);
+		return slot == none ? end() : const_iterator{this, slot};
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::max_w() const noexcept -> Numeric {
+		// The widest node is the rightmost one.
+		auto widest = Numeric{};
+		for (auto t = root; t != none; t = slots[t].right) {
+			widest = slots[t].node.w;
+		}
+		return widest;
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::max_h() const noexcept -> Numeric {
+		return root == none ? Numeric{} : slots[root].max_h;
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::max_area() const noexcept -> Numeric {
+		return root == none ? Numeric{} : slots[root].max_area;
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::begin() const noexcept -> const_iterator {
+		return const_iterator{this, next_live(std::uint32_t{0})};
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::end() const noexcept -> const_iterator {
+		return const_iterator{this, static_cast<std::uint32_t>(slots.size())};
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::less(const Node& a, const Node& b) noexcept -> bool {
+		if (a.w != b.w) return a.w < b.w;
+		if (a.h != b.h) return a.h < b.h;
+		if (a.y != b.y) return a.y < b.y;
+		return a.x < b.x;
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::next_live(std::uint32_t slot) const noexcept -> std::uint32_t {
+		while (slot < slots.size() && !slots[slot].live) {
+			++slot;
+		}
+		return std::min(slot, static_cast<std::uint32_t>(slots.size()));
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::pull(std::uint32_t t) noexcept -> void {
+		auto& slot = slots[t];
+		slot.max_h = slot.node.h;
+		slot.max_area = slot.node.w * slot.node.h;
+		for (const auto child : {slot.left, slot.right}) {
+			if (child != none) {
+				slot.max_h = std::max(slot.max_h, slots[child].max_h);
+				slot.max_area = std::max(slot.max_area, slots[child].max_area);
+			}
+		}
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::split(std::uint32_t t, const Node& key, std::uint32_t& left, std::uint32_t& right) noexcept -> void {
+		if (t == none) {
+			left = none;
+			right = none;
+			return;
+		}
+		if (less(slots[t].node, key)) {
+			split(slots[t].right, key, slots[t].right, right);
+			left = t;
+		} else {
+			split(slots[t].left, key, left, slots[t].left);
+			right = t;
+		}
+		pull(t);
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::merge(std::uint32_t left, std::uint32_t right) noexcept -> std::uint32_t {
+		if (left == none) {
+			return right;
+		}
+		if (right == none) {
+			return left;
+		}
+		if (slots[left].priority > slots[right].priority) {
+			slots[left].right = merge(slots[left].right, right);
+			pull(left);
+			return left;
+		}
+		slots[right].left = merge(left, slots[right].left);
+		pull(right);
+		return right;
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::insert_at(std::uint32_t t, std::uint32_t slot) noexcept -> std::uint32_t {
+		if (t == none) {
+			return slot;
+		}
+		if (slots[slot].priority > slots[t].priority) {
+			split(t, slots[slot].node, slots[slot].left, slots[slot].right);
+			pull(slot);
+			return slot;
+		}
+		if (less(slots[slot].node, slots[t].node)) {
+			slots[t].left = insert_at(slots[t].left, slot);
+		} else {
+			slots[t].right = insert_at(slots[t].right, slot);
+		}
+		pull(t);
+		return t;
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::erase_at(std::uint32_t t, const Node& key) noexcept -> std::uint32_t {
+		if (t == none) {
+			return none;
+		}
+		if (less(key, slots[t].node)) {
+			slots[t].left = erase_at(slots[t].left, key);
+		} else if (less(slots[t].node, key)) {
+			slots[t].right = erase_at(slots[t].right, key);
+		} else {
+			return merge(slots[t].left, slots[t].right);
+		}
+		pull(t);
+		return t;
+	}
+
+	template<typename Numeric>
+	auto FreeNodeTree<Numeric>::first_fit(std::uint32_t t, Numeric w, Numeric h, std::size_t& visited) const noexcept -> std::uint32_t {
+		// Left of the width boundary only the right child can hold a fit. Right
+		// of it every node is wide enough, so max_h alone says whether a
+		// subtree holds one, and only the first such subtree is entered.
+		while (t != none && slots[t].max_h >= h) {
+			++visited;
+			const auto& slot = slots[t];
+			if (slot.node.w < w) {
+				t = slot.right;
+				continue;
+			}
+			if (const auto found = first_fit(slot.left, w, h, visited); found != none) {
+				return found;
+			}
+			if (slot.node.h >= h) {
+				return t;
+			}
+			t = slot.right;
+		}
+		return none;
+	}
+
+
+	template class FreeNodeTree<float>;
+
+	template class FreeNodeTree<double>;
+
+	template class FreeNodeTree<int>;
+
+}
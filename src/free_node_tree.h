@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <vector>
+
+namespace MaxRects {
+
+	// Disjoint free rects of a guillotine bin in a treap ordered by width,
+	// then height, y and x. Every subtree records its tallest node, so the
+	// narrowest node at least w wide and h tall is found in one descent along
+	// the width boundary, O(log n) expected. Nodes live in a pooled array and
+	// iterate in slot order, not key order.
+	template<typename Numeric = float>
+	class FreeNodeTree {
+	public:
+		struct Node {
+			Numeric x{Numeric{}};
+			Numeric y{Numeric{}};
+			Numeric w{Numeric{}};
+			Numeric h{Numeric{}};
+		};
+
+		class const_iterator {
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = Node;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const Node*;
+			using reference = const Node&;
+
+			const_iterator() = default;
+
+			[[nodiscard]] auto operator*() const noexcept -> reference;
+
+			[[nodiscard]] auto operator->() const noexcept -> pointer;
+
+			auto operator++() noexcept -> const_iterator&;
+
+			auto operator++(int) noexcept -> const_iterator;
+
+			[[nodiscard]] auto operator==(const const_iterator& other) const noexcept -> bool = default;
+
+		private:
+			friend class FreeNodeTree;
+
+			const FreeNodeTree* tree{};
+			std::uint32_t slot{};
+
+			const_iterator(const FreeNodeTree* tree, std::uint32_t slot) noexcept;
+		};
+
+		FreeNodeTree() = default;
+
+		explicit FreeNodeTree(std::pmr::memory_resource* resource);
+
+		[[nodiscard]] auto size() const noexcept -> std::size_t;
+
+		[[nodiscard]] auto empty() const noexcept -> bool;
+
+		auto clear() noexcept -> void;
+
+		auto insert(const Node& node) -> void;
+
+		template<typename It>
+		auto insert(It first, It last) -> void {
+			for (; first != last; ++first) {
+				insert(*first);
+			}
+		}
+
+		// Returns the iterator following the erased node in slot order.
+		auto erase(const_iterator position) -> const_iterator;
+
+		// Narrowest, then shortest, node holding w by h, or end(). visited
+		// counts the tree nodes the descent looked at.
+		[[nodiscard]] auto find(Numeric w, Numeric h, std::size_t& visited) const noexcept -> const_iterator;
+
+		[[nodiscard]] auto max_w() const noexcept -> Numeric;
+
+		[[nodiscard]] auto max_h() const noexcept -> Numeric;
+
+		[[nodiscard]] auto max_area() const noexcept -> Numeric;
+
+		[[nodiscard]] auto begin() const noexcept -> const_iterator;
+
+		[[nodiscard]] auto end() const noexcept -> const_iterator;
+
+	private:
+		static constexpr auto none = std::numeric_limits<std::uint32_t>::max();
+
+		struct Slot {
+			Node node{};
+			Numeric max_h{Numeric{}};
+			Numeric max_area{Numeric{}};
+			std::uint32_t left{none};
+			std::uint32_t right{none};
+			std::uint32_t priority{};
+			bool live{false};
+		};
+
+		std::pmr::vector<Slot> slots{};
+		std::pmr::vector<std::uint32_t> vacant{};
+		std::uint32_t root{none};
+		std::uint32_t live_count{};
+		std::uint32_t seed{};
+
+		[[nodiscard]] static auto less(const Node& a, const Node& b) noexcept -> bool;
+
+		[[nodiscard]] auto next_live(std::uint32_t slot) const noexcept -> std::uint32_t;
+
+		auto pull(std::uint32_t t) noexcept -> void;
+
+		auto split(std::uint32_t t, const Node& key, std::uint32_t& left, std::uint32_t& right) noexcept -> void;
+
+		[[nodiscard]] auto merge(std::uint32_t left, std::uint32_t right) noexcept -> std::uint32_t;
+
+		[[nodiscard]] auto insert_at(std::uint32_t t, std::uint32_t slot) noexcept -> std::uint32_t;
+
+		[[nodiscard]] auto erase_at(std::uint32_t t, const Node& key) noexcept -> std::uint32_t;
+
+		[[nodiscard]] auto first_fit(std::uint32_t t, Numeric w, Numeric h, std::size_t& visited) const noexcept -> std::uint32_t;
+	};
+
+}
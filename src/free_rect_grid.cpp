@@ -0,0 +1,204 @@
+#include "free_rect_grid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace MaxRects {
+
+	template<typename Numeric>
+	FreeRectGrid<Numeric>::FreeRectGrid(std::pmr::memory_resource* resource)
+		: cells{resource}, spanning{resource} {
+	}
+
+	template<typename Numeric>
+	auto FreeRectGrid<Numeric>::configure(Numeric extent_w, Numeric extent_h, std::size_t cells_per_axis) -> void {
+		configure(extent_w, extent_h, cells_per_axis, cells_per_axis);
+	}
+
+	template<typename Numeric>
+	auto FreeRectGrid<Numeric>::configure(Numeric extent_w, Numeric extent_h, std::size_t column_count, std::size_t row_count) -> void {
+		columns = std::max(column_count, std::size_t{1});
+		rows = std::max(row_count, std::size_t{1});
+		cell_w = extent_w / static_cast<Numeric>(columns);
+		cell_h = extent_h / static_cast<Numeric>(rows);
+		if (cell_w <= Numeric{}) {
+			cell_w = Numeric{1};
+		}
+		if (cell_h <= Numeric{}) {
+			cell_h = Numeric{1};
+		}
+		fitted_for = columns * rows * free_rect_grid_rects_per_cell;
+		cells.assign(columns * rows, std::pmr::vector<Entry>{cells.get_allocator()});
+		spanning.clear();
+	}
+
+	template<typename Numeric>
+	auto FreeRectGrid<Numeric>::fit_to(Numeric extent_w, Numeric extent_h, std::size_t rect_count) -> void {
+		const auto clamp = [](double cells) {
+			const auto rounded = static_cast<std::size_t>(std::lround(cells));
+			return std::clamp(rounded, free_rect_grid_min_cells, free_rect_grid_max_cells);
+		};
+		const auto wanted = static_cast<double>(rect_count / free_rect_grid_rects_per_cell);
+		const auto aspect = extent_w > Numeric{} && extent_h > Numeric{}
+			? static_cast<double>(extent_w) / static_cast<double>(extent_h) : 1.0;
+		const auto column_count = clamp(std::sqrt(wanted * aspect));
+		const auto row_count = clamp(wanted / static_cast<double>(column_count));
+		configure(extent_w, extent_h, column_count, row_count);
+		fitted_for = std::max(rect_count, free_rect_grid_min_cells * free_rect_grid_min_cells);
+	}
+
+	template<typename Numeric>
+	auto FreeRectGrid<Numeric>::needs_refit(std::size_t rect_count) const noexcept -> bool {
+		const auto floor = free_rect_grid_min_cells * free_rect_grid_min_cells;
+		const auto at_max = columns >= free_rect_grid_max_cells && rows >= free_rect_grid_max_cells;
+		return (rect_count > fitted_for * 2 && !at_max) || (rect_count < fitted_for / 8 && fitted_for > floor);
+	}
+
+	template<typename Numeric>
+	auto FreeRectGrid<Numeric>::cell_count() const noexcept -> std::size_t {
+		return cells.size();
+	}
+
+	template<typename Numeric>
+	auto FreeRectGrid<Numeric>::is_configured() const noexcept -> bool {
+		return !cells.empty();
+	}
+
+	template<typename Numeric>
+	auto FreeRectGrid<Numeric>::clear() noexcept -> void {
+		for (auto& cell : cells) {
+			cell.clear();
+		}
+		spanning.clear();
+	}
+
+	template<typename Numeric>
+	auto FreeRectGrid<Numeric>::insert(std::uint32_t id, Numeric x, Numeric y, Numeric w, Numeric h) -> void {
+		const auto entry = Entry{x, y, x + w, y + h, id};
+		if (spans_many_cells(x, y, w, h)) {
+			spanning.push_back(entry);
+			return;
+		}
+		const auto last_column = column_of(entry.right);
+		const auto last_row = row_of(entry.bottom);
+		for (auto row = row_of(y); row <= last_row; ++row) {
+			for (auto column = column_of(x); column <= last_column; ++column) {
+				cells[row * columns + column].push_back(entry);
+			}
+		}
+	}
+
+	template<typename Numeric>
+	auto FreeRectGrid<Numeric>::erase(std::uint32_t id, Numeric x, Numeric y, Numeric w, Numeric h) noexcept -> void {
+		const auto drop = [id](std::pmr::vector<Entry>& entries) {
+			for (auto i = std::size_t{0}; i < entries.size(); ++i) {
+				if (entries[i].id == id) {
+					entries[i] = entries.back();
+					entries.pop_back();
+					return;
+				}
+			}
+		};
+		if (spans_many_cells(x, y, w, h)) {
+			drop(spanning);
+			return;
+		}
+		const auto last_column = column_of(x + w);
+		const auto last_row = row_of(y + h);
+		for (auto row = row_of(y); row <= last_row; ++row) {
+			for (auto column = column_of(x); column <= last_column; ++column) {
+				drop(cells[row * columns + column]);
+			}
+		}
+	}
+
+	template<typename Numeric>
+	auto FreeRectGrid<Numeric>::is_contained(std::uint32_t id, Numeric x, Numeric y, Numeric w, Numeric h) const noexcept -> bool {
+		const auto right = x + w;
+		const auto bottom = y + h;
+		const auto contains = [&](const Entry& entry) {
+			if (entry.id == id || entry.left > x || entry.top > y || entry.right < right || entry.bottom < bottom) {
+				return false;
+			}
+			const auto equal = entry.left == x && entry.top == y && entry.right == right && entry.bottom == bottom;
+			return !equal || entry.id > id;
+		};
+		const auto& cell = cells[row_of(y) * columns + column_of(x)];
+		return std::any_of(cell.begin(), cell.end(), contains) || std::any_of(spanning.begin(), spanning.end(), contains);
+	}
+
+	template<typename Numeric>
+	auto FreeRectGrid<Numeric>::covers(Numeric x, Numeric y, Numeric w, Numeric h) const noexcept -> bool {
+		const auto right = x + w;
+		const auto bottom = y + h;
+		const auto contains = [&](const Entry& entry) {
+			return entry.left <= x && entry.top <= y && entry.right >= right && entry.bottom >= bottom;
+		};
+		const auto& cell = cells[row_of(y) * columns + column_of(x)];
+		return std::any_of(cell.begin(), cell.end(), contains) || std::any_of(spanning.begin(), spanning.end(), contains);
+	}
+
+	template<typename Numeric>
+	auto FreeRectGrid<Numeric>::collect(Numeric x, Numeric y, Numeric w, Numeric h, std::pmr::vector<std::uint32_t>& ids) const -> void {
+		const auto right = x + w;
+		const auto bottom = y + h;
+		const auto first_column = column_of(x);
+		const auto first_row = row_of(y);
+		const auto last_column = column_of(right);
+		const auto last_row = row_of(bottom);
+		const auto touches = [&](const Entry& entry) {
+			return entry.left <= right && entry.right >= x && entry.top <= bottom && entry.bottom >= y;
+		};
+		for (const auto& entry : spanning) {
+			if (touches(entry)) {
+				ids.push_back(entry.id);
+			}
+		}
+		for (auto row = first_row; row <= last_row; ++row) {
+			for (auto column = first_column; column <= last_column; ++column) {
+				for (const auto& entry : cells[row * columns + column]) {
+					if (!touches(entry)) {
+						continue;
+					}
+					// An entry sits in every cell it overlaps; only report it from
+					// the cell holding the top-left corner of the shared area.
+					if (column_of(std::max(entry.left, x)) == column && row_of(std::max(entry.top, y)) == row) {
+						ids.push_back(entry.id);
+					}
+				}
+			}
+		}
+	}
+
+	template<typename Numeric>
+	auto FreeRectGrid<Numeric>::spans_many_cells(Numeric x, Numeric y, Numeric w, Numeric h) const noexcept -> bool {
+		const auto spanned_columns = column_of(x + w) - column_of(x) + std::size_t{1};
+		const auto spanned_rows = row_of(y + h) - row_of(y) + std::size_t{1};
+		return spanned_columns * spanned_rows > free_rect_grid_max_span;
+	}
+
+	template<typename Numeric>
+	auto FreeRectGrid<Numeric>::column_of(Numeric value) const noexcept -> std::size_t {
+		if (value <= Numeric{}) {
+			return std::size_t{0};
+		}
+		const auto column = static_cast<std::size_t>(value / cell_w);
+		return std::min(column, columns - std::size_t{1});
+	}
+
+	template<typename Numeric>
+	auto FreeRectGrid<Numeric>::row_of(Numeric value) const noexcept -> std::size_t {
+		if (value <= Numeric{}) {
+			return std::size_t{0};
+		}
+		const auto row = static_cast<std::size_t>(value / cell_h);
+		return std::min(row, rows - std::size_t{1});
+	}
+
+
+	template class FreeRectGrid<float>;
+
+	template class FreeRectGrid<double>;
+
+	template class FreeRectGrid<int>;
+
+}
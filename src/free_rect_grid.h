@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace MaxRects {
+
+	// Uniform grid over the bin area. Every free rectangle is registered in
+	// each cell it overlaps, so any rectangle containing a point is found in
+	// the single cell holding that point. fit_to sizes the cells for the
+	// number of rects, so a cell keeps holding a handful as the list grows.
+	// Rects spanning more than free_rect_grid_max_span cells, which maximal
+	// free lists keep only a few of, sit in one list every query scans instead.
+	// Smallest and largest cell count per axis fit_to picks, and the rects it
+	// aims to have in each cell.
+	constexpr std::size_t free_rect_grid_min_cells = 8;
+	constexpr std::size_t free_rect_grid_max_cells = 256;
+	constexpr std::size_t free_rect_grid_rects_per_cell = 4;
+	constexpr std::size_t free_rect_grid_max_span = 16;
+
+	template<typename Numeric = float>
+	class FreeRectGrid {
+	public:
+		struct Entry {
+			Numeric left{};
+			Numeric top{};
+			Numeric right{};
+			Numeric bottom{};
+			std::uint32_t id{};
+		};
+
+		FreeRectGrid() = default;
+
+		explicit FreeRectGrid(std::pmr::memory_resource* resource);
+
+		auto configure(Numeric extent_w, Numeric extent_h, std::size_t cells_per_axis) -> void;
+
+		auto configure(Numeric extent_w, Numeric extent_h, std::size_t column_count, std::size_t row_count) -> void;
+
+		// Lays the grid out for about rect_count rects over the extent, with
+		// cells matching its aspect. Empties the grid.
+		auto fit_to(Numeric extent_w, Numeric extent_h, std::size_t rect_count) -> void;
+
+		// True once rect_count has drifted far enough from the count the
+		// layout was fitted to that refitting pays for the reindex.
+		[[nodiscard]] auto needs_refit(std::size_t rect_count) const noexcept -> bool;
+
+		[[nodiscard]] auto cell_count() const noexcept -> std::size_t;
+
+		[[nodiscard]] auto is_configured() const noexcept -> bool;
+
+		auto clear() noexcept -> void;
+
+		auto insert(std::uint32_t id, Numeric x, Numeric y, Numeric w, Numeric h) -> void;
+
+		auto erase(std::uint32_t id, Numeric x, Numeric y, Numeric w, Numeric h) noexcept -> void;
+
+		[[nodiscard]] auto is_contained(std::uint32_t id, Numeric x, Numeric y, Numeric w, Numeric h) const noexcept -> bool;
+
+		// True if some registered rect contains the region, equal rects included.
+		[[nodiscard]] auto covers(Numeric x, Numeric y, Numeric w, Numeric h) const noexcept -> bool;
+
+		// Appends the id of every registered rect that overlaps or touches the
+		// region, each once, in no particular order.
+		auto collect(Numeric x, Numeric y, Numeric w, Numeric h, std::pmr::vector<std::uint32_t>& ids) const -> void;
+
+	private:
+		std::pmr::vector<std::pmr::vector<Entry>> cells{};
+		std::pmr::vector<Entry> spanning{};
+		std::size_t columns{};
+		std::size_t rows{};
+		Numeric cell_w{};
+		Numeric cell_h{};
+		std::size_t fitted_for{};
+
+		[[nodiscard]] auto spans_many_cells(Numeric x, Numeric y, Numeric w, Numeric h) const noexcept -> bool;
+
+		[[nodiscard]] auto column_of(Numeric value) const noexcept -> std::size_t;
+
+		[[nodiscard]] auto row_of(Numeric value) const noexcept -> std::size_t;
+	};
+
+}
@@ -0,0 +1,467 @@
+#include "free_rect_list.h"
+#include <algorithm>
+#include <array>
+#include <numeric>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MAXRECTS_SIMD_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define MAXRECTS_SIMD_SSE2 1
+#endif
+
+namespace MaxRects {
+
+	namespace {
+
+		template<FreeRectScore Score, typename Numeric>
+		auto scan_scalar(const FreeRectList<Numeric>& list, std::size_t first, Numeric width, Numeric height,
+						FreeRectFit<Numeric>& best) noexcept -> void {
+			for (auto i = first; i < list.size(); ++i) {
+				const auto free_w = list.w[i];
+				const auto free_h = list.h[i];
+				if (free_w >= width && free_h >= height) {
+					const auto leftover_horizontal = free_w - width;
+					const auto leftover_vertical = free_h - height;
+					const auto short_side = std::min(leftover_horizontal, leftover_vertical);
+					const auto long_side = std::max(leftover_horizontal, leftover_vertical);
+
+					auto primary = short_side;
+					auto secondary = long_side;
+					if constexpr (Score == FreeRectScore::LongSide) {
+						primary = long_side;
+						secondary = short_side;
+					} else if constexpr (Score == FreeRectScore::Area) {
+						primary = free_w * free_h - width * height;
+						secondary = short_side;
+					} else if constexpr (Score == FreeRectScore::BottomLeft) {
+						primary = list.y[i] + height;
+						secondary = list.x[i];
+					}
+
+					if (primary < best.primary ||
+						(primary == best.primary && secondary < best.secondary)) {
+						best.index = i;
+						best.primary = primary;
+						best.secondary = secondary;
+					}
+				}
+			}
+		}
+
+#if defined(MAXRECTS_SIMD_AVX2)
+
+		struct F32Lanes {
+			using value_type = float;
+			static constexpr auto lanes = std::size_t{8};
+			__m256 v;
+
+			static auto load(const float* ptr) noexcept -> F32Lanes { return {_mm256_loadu_ps(ptr)}; }
+			static auto broadcast(float value) noexcept -> F32Lanes { return {_mm256_set1_ps(value)}; }
+			static auto store(float* ptr, F32Lanes a) noexcept -> void { _mm256_storeu_ps(ptr, a.v); }
+			static auto add(F32Lanes a, F32Lanes b) noexcept -> F32Lanes { return {_mm256_add_ps(a.v, b.v)}; }
+			static auto sub(F32Lanes a, F32Lanes b) noexcept -> F32Lanes { return {_mm256_sub_ps(a.v, b.v)}; }
+			static auto mul(F32Lanes a, F32Lanes b) noexcept -> F32Lanes { return {_mm256_mul_ps(a.v, b.v)}; }
+			static auto min(F32Lanes a, F32Lanes b) noexcept -> F32Lanes { return {_mm256_min_ps(a.v, b.v)}; }
+			static auto max(F32Lanes a, F32Lanes b) noexcept -> F32Lanes { return {_mm256_max_ps(a.v, b.v)}; }
+			static auto ge(F32Lanes a, F32Lanes b) noexcept -> F32Lanes { return {_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)}; }
+			static auto lt(F32Lanes a, F32Lanes b) noexcept -> F32Lanes { return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)}; }
+			static auto eq(F32Lanes a, F32Lanes b) noexcept -> F32Lanes { return {_mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ)}; }
+			static auto both(F32Lanes a, F32Lanes b) noexcept -> F32Lanes { return {_mm256_and_ps(a.v, b.v)}; }
+			static auto either(F32Lanes a, F32Lanes b) noexcept -> F32Lanes { return {_mm256_or_ps(a.v, b.v)}; }
+			static auto select(F32Lanes mask, F32Lanes a, F32Lanes b) noexcept -> F32Lanes { return {_mm256_blendv_ps(a.v, b.v, mask.v)}; }
+		};
+
+		struct F64Lanes {
+			using value_type = double;
+			static constexpr auto lanes = std::size_t{4};
+			__m256d v;
+
+			static auto load(const double* ptr) noexcept -> F64Lanes { return {_mm256_loadu_pd(ptr)}; }
+			static auto broadcast(double value) noexcept -> F64Lanes { return {_mm256_set1_pd(value)}; }
+			static auto store(double* ptr, F64Lanes a) noexcept -> void { _mm256_storeu_pd(ptr, a.v); }
+			static auto add(F64Lanes a, F64Lanes b) noexcept -> F64Lanes { return {_mm256_add_pd(a.v, b.v)}; }
+			static auto sub(F64Lanes a, F64Lanes b) noexcept -> F64Lanes { return {_mm256_sub_pd(a.v, b.v)}; }
+			static auto mul(F64Lanes a, F64Lanes b) noexcept -> F64Lanes { return {_mm256_mul_pd(a.v, b.v)}; }
+			static auto min(F64Lanes a, F64Lanes b) noexcept -> F64Lanes { return {_mm256_min_pd(a.v, b.v)}; }
+			static auto max(F64Lanes a, F64Lanes b) noexcept -> F64Lanes { return {_mm256_max_pd(a.v, b.v)}; }
+			static auto ge(F64Lanes a, F64Lanes b) noexcept -> F64Lanes { return {_mm256_cmp_pd(a.v, b.v, _CMP_GE_OQ)}; }
+			static auto lt(F64Lanes a, F64Lanes b) noexcept -> F64Lanes { return {_mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ)}; }
+			static auto eq(F64Lanes a, F64Lanes b) noexcept -> F64Lanes { return {_mm256_cmp_pd(a.v, b.v, _CMP_EQ_OQ)}; }
+			static auto both(F64Lanes a, F64Lanes b) noexcept -> F64Lanes { return {_mm256_and_pd(a.v, b.v)}; }
+			static auto either(F64Lanes a, F64Lanes b) noexcept -> F64Lanes { return {_mm256_or_pd(a.v, b.v)}; }
+			static auto select(F64Lanes mask, F64Lanes a, F64Lanes b) noexcept -> F64Lanes { return {_mm256_blendv_pd(a.v, b.v, mask.v)}; }
+		};
+
+		struct I32Lanes {
+			using value_type = int;
+			static constexpr auto lanes = std::size_t{8};
+			__m256i v;
+
+			static auto load(const int* ptr) noexcept -> I32Lanes { return {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr))}; }
+			static auto broadcast(int value) noexcept -> I32Lanes { return {_mm256_set1_epi32(value)}; }
+			static auto store(int* ptr, I32Lanes a) noexcept -> void { _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), a.v); }
+			static auto add(I32Lanes a, I32Lanes b) noexcept -> I32Lanes { return {_mm256_add_epi32(a.v, b.v)}; }
+			static auto sub(I32Lanes a, I32Lanes b) noexcept -> I32Lanes { return {_mm256_sub_epi32(a.v, b.v)}; }
+			static auto mul(I32Lanes a, I32Lanes b) noexcept -> I32Lanes { return {_mm256_mullo_epi32(a.v, b.v)}; }
+			static auto min(I32Lanes a, I32Lanes b) noexcept -> I32Lanes { return {_mm256_min_epi32(a.v, b.v)}; }
+			static auto max(I32Lanes a, I32Lanes b) noexcept -> I32Lanes { return {_mm256_max_epi32(a.v, b.v)}; }
+			static auto ge(I32Lanes a, I32Lanes b) noexcept -> I32Lanes {
+				return {_mm256_andnot_si256(_mm256_cmpgt_epi32(b.v, a.v), _mm256_set1_epi32(-1))};
+			}
+			static auto lt(I32Lanes a, I32Lanes b) noexcept -> I32Lanes { return {_mm256_cmpgt_epi32(b.v, a.v)}; }
+			static auto eq(I32Lanes a, I32Lanes b) noexcept -> I32Lanes { return {_mm256_cmpeq_epi32(a.v, b.v)}; }
+			static auto both(I32Lanes a, I32Lanes b) noexcept -> I32Lanes { return {_mm256_and_si256(a.v, b.v)}; }
+			static auto either(I32Lanes a, I32Lanes b) noexcept -> I32Lanes { return {_mm256_or_si256(a.v, b.v)}; }
+			static auto select(I32Lanes mask, I32Lanes a, I32Lanes b) noexcept -> I32Lanes { return {_mm256_blendv_epi8(a.v, b.v, mask.v)}; }
+		};
+
+#elif defined(MAXRECTS_SIMD_SSE2)
+
+		struct F32Lanes {
+			using value_type = float;
+			static constexpr auto lanes = std::size_t{4};
+			__m128 v;
+
+			static auto load(const float* ptr) noexcept -> F32Lanes { return {_mm_loadu_ps(ptr)}; }
+			static auto broadcast(float value) noexcept -> F32Lanes { return {_mm_set1_ps(value)}; }
+			static auto store(float* ptr, F32Lanes a) noexcept -> void { _mm_storeu_ps(ptr, a.v); }
+			static auto add(F32Lanes a, F32Lanes b) noexcept -> F32Lanes { return {_mm_add_ps(a.v, b.v)}; }
+			static auto sub(F32Lanes a, F32Lanes b) noexcept -> F32Lanes { return {_mm_sub_ps(a.v, b.v)}; }
+			static auto mul(F32Lanes a, F32Lanes b) noexcept -> F32Lanes { return {_mm_mul_ps(a.v, b.v)}; }
+			static auto min(F32Lanes a, F32Lanes b) noexcept -> F32Lanes { return {_mm_min_ps(a.v, b.v)}; }
+			static auto max(F32Lanes a, F32Lanes b) noexcept -> F32Lanes { return {_mm_max_ps(a.v, b.v)}; }
+			static auto ge(F32Lanes a, F32Lanes b) noexcept -> F32Lanes { return {_mm_cmpge_ps(a.v, b.v)}; }
+			static auto lt(F32Lanes a, F32Lanes b) noexcept -> F32Lanes { return {_mm_cmplt_ps(a.v, b.v)}; }
+			static auto eq(F32Lanes a, F32Lanes b) noexcept -> F32Lanes { return {_mm_cmpeq_ps(a.v, b.v)}; }
+			static auto both(F32Lanes a, F32Lanes b) noexcept -> F32Lanes { return {_mm_and_ps(a.v, b.v)}; }
+			static auto either(F32Lanes a, F32Lanes b) noexcept -> F32Lanes { return {_mm_or_ps(a.v, b.v)}; }
+			static auto select(F32Lanes mask, F32Lanes a, F32Lanes b) noexcept -> F32Lanes {
+				return {_mm_or_ps(_mm_and_ps(mask.v, b.v), _mm_andnot_ps(mask.v, a.v))};
+			}
+		};
+
+		struct F64Lanes {
+			using value_type = double;
+			static constexpr auto lanes = std::size_t{2};
+			__m128d v;
+
+			static auto load(const double* ptr) noexcept -> F64Lanes { return {_mm_loadu_pd(ptr)}; }
+			static auto broadcast(double value) noexcept -> F64Lanes { return {_mm_set1_pd(value)}; }
+			static auto store(double* ptr, F64Lanes a) noexcept -> void { _mm_storeu_pd(ptr, a.v); }
+			static auto add(F64Lanes a, F64Lanes b) noexcept -> F64Lanes { return {_mm_add_pd(a.v, b.v)}; }
+			static auto sub(F64Lanes a, F64Lanes b) noexcept -> F64Lanes { return {_mm_sub_pd(a.v, b.v)}; }
+			static auto mul(F64Lanes a, F64Lanes b) noexcept -> F64Lanes { return {_mm_mul_pd(a.v, b.v)}; }
+			static auto min(F64Lanes a, F64Lanes b) noexcept -> F64Lanes { return {_mm_min_pd(a.v, b.v)}; }
+			static auto max(F64Lanes a, F64Lanes b) noexcept -> F64Lanes { return {_mm_max_pd(a.v, b.v)}; }
+			static auto ge(F64Lanes a, F64Lanes b) noexcept -> F64Lanes { return {_mm_cmpge_pd(a.v, b.v)}; }
+			static auto lt(F64Lanes a, F64Lanes b) noexcept -> F64Lanes { return {_mm_cmplt_pd(a.v, b.v)}; }
+			static auto eq(F64Lanes a, F64Lanes b) noexcept -> F64Lanes { return {_mm_cmpeq_pd(a.v, b.v)}; }
+			static auto both(F64Lanes a, F64Lanes b) noexcept -> F64Lanes { return {_mm_and_pd(a.v, b.v)}; }
+			static auto either(F64Lanes a, F64Lanes b) noexcept -> F64Lanes { return {_mm_or_pd(a.v, b.v)}; }
+			static auto select(F64Lanes mask, F64Lanes a, F64Lanes b) noexcept -> F64Lanes {
+				return {_mm_or_pd(_mm_and_pd(mask.v, b.v), _mm_andnot_pd(mask.v, a.v))};
+			}
+		};
+
+		struct I32Lanes {
+			using value_type = int;
+			static constexpr auto lanes = std::size_t{4};
+			__m128i v;
+
+			static auto load(const int* ptr) noexcept -> I32Lanes { return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr))}; }
+			static auto broadcast(int value) noexcept -> I32Lanes { return {_mm_set1_epi32(value)}; }
+			static auto store(int* ptr, I32Lanes a) noexcept -> void { _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), a.v); }
+			static auto add(I32Lanes a, I32Lanes b) noexcept -> I32Lanes { return {_mm_add_epi32(a.v, b.v)}; }
+			static auto sub(I32Lanes a, I32Lanes b) noexcept -> I32Lanes { return {_mm_sub_epi32(a.v, b.v)}; }
+			static auto mul(I32Lanes a, I32Lanes b) noexcept -> I32Lanes {
+#if defined(__SSE4_1__)
+				return {_mm_mullo_epi32(a.v, b.v)};
+#else
+				const auto even = _mm_mul_epu32(a.v, b.v);
+				const auto odd = _mm_mul_epu32(_mm_srli_si128(a.v, 4), _mm_srli_si128(b.v, 4));
+				return {_mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+											_mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)))};
+#endif
+			}
+			static auto min(I32Lanes a, I32Lanes b) noexcept -> I32Lanes { return select(lt(b, a), a, b); }
+			static auto max(I32Lanes a, I32Lanes b) noexcept -> I32Lanes { return select(lt(a, b), a, b); }
+			static auto ge(I32Lanes a, I32Lanes b) noexcept -> I32Lanes {
+				return {_mm_andnot_si128(_mm_cmplt_epi32(a.v, b.v), _mm_set1_epi32(-1))};
+			}
+			static auto lt(I32Lanes a, I32Lanes b) noexcept -> I32Lanes { return {_mm_cmplt_epi32(a.v, b.v)}; }
+			static auto eq(I32Lanes a, I32Lanes b) noexcept -> I32Lanes { return {_mm_cmpeq_epi32(a.v, b.v)}; }
+			static auto both(I32Lanes a, I32Lanes b) noexcept -> I32Lanes { return {_mm_and_si128(a.v, b.v)}; }
+			static auto either(I32Lanes a, I32Lanes b) noexcept -> I32Lanes { return {_mm_or_si128(a.v, b.v)}; }
+			static auto select(I32Lanes mask, I32Lanes a, I32Lanes b) noexcept -> I32Lanes {
+				return {_mm_or_si128(_mm_and_si128(mask.v, b.v), _mm_andnot_si128(mask.v, a.v))};
+			}
+		};
+
+#endif
+
+		template<typename Numeric>
+		struct simd_lanes {
+			using type = void;
+		};
+
+#if defined(MAXRECTS_SIMD_AVX2) || defined(MAXRECTS_SIMD_SSE2)
+		template<>
+		struct simd_lanes<float> {
+			using type = F32Lanes;
+		};
+
+		template<>
+		struct simd_lanes<double> {
+			using type = F64Lanes;
+		};
+
+		template<>
+		struct simd_lanes<int> {
+			using type = I32Lanes;
+		};
+#endif
+
+		// Each lane keeps the first strictly better candidate it sees, so the
+		// lowest index wins ties exactly like the scalar loop. Lane block
+		// counters are kept in the value type to avoid mixed-width registers.
+		template<typename Lanes, FreeRectScore Score, typename Numeric>
+		auto scan_simd(const FreeRectList<Numeric>& list, Numeric width, Numeric height) noexcept -> FreeRectFit<Numeric> {
+			constexpr auto lanes = Lanes::lanes;
+			const auto count = list.size();
+			const auto vector_end = count - count % lanes;
+
+			const auto request_w = Lanes::broadcast(width);
+			const auto request_h = Lanes::broadcast(height);
+			const auto request_area = Lanes::broadcast(width * height);
+			const auto one = Lanes::broadcast(Numeric{1});
+			auto best_primary = Lanes::broadcast(std::numeric_limits<Numeric>::max());
+			auto best_secondary = Lanes::broadcast(std::numeric_limits<Numeric>::max());
+			auto best_block = Lanes::broadcast(Numeric{-1});
+			auto block = Lanes::broadcast(Numeric{});
+
+			for (auto i = std::size_t{0}; i < vector_end; i += lanes) {
+				const auto free_w = Lanes::load(list.w.data() + i);
+				const auto free_h = Lanes::load(list.h.data() + i);
+				const auto fits = Lanes::both(Lanes::ge(free_w, request_w), Lanes::ge(free_h, request_h));
+				const auto leftover_horizontal = Lanes::sub(free_w, request_w);
+				const auto leftover_vertical = Lanes::sub(free_h, request_h);
+				const auto short_side = Lanes::min(leftover_horizontal, leftover_vertical);
+				const auto long_side = Lanes::max(leftover_horizontal, leftover_vertical);
+
+				auto primary = short_side;
+				auto secondary = long_side;
+				if constexpr (Score == FreeRectScore::LongSide) {
+					primary = long_side;
+					secondary = short_side;
+				} else if constexpr (Score == FreeRectScore::Area) {
+					primary = Lanes::sub(Lanes::mul(free_w, free_h), request_area);
+					secondary = short_side;
+				} else if constexpr (Score == FreeRectScore::BottomLeft) {
+					primary = Lanes::add(Lanes::load(list.y.data() + i), request_h);
+					secondary = Lanes::load(list.x.data() + i);
+				}
+
+				const auto better = Lanes::both(fits, Lanes::either(
+					Lanes::lt(primary, best_primary),
+					Lanes::both(Lanes::eq(primary, best_primary), Lanes::lt(secondary, best_secondary))));
+				best_primary = Lanes::select(better, best_primary, primary);
+				best_secondary = Lanes::select(better, best_secondary, secondary);
+				best_block = Lanes::select(better, best_block, block);
+				block = Lanes::add(block, one);
+			}
+
+			auto lane_primary = std::array<Numeric, lanes>{};
+			auto lane_secondary = std::array<Numeric, lanes>{};
+			auto lane_block = std::array<Numeric, lanes>{};
+			Lanes::store(lane_primary.data(), best_primary);
+			Lanes::store(lane_secondary.data(), best_secondary);
+			Lanes::store(lane_block.data(), best_block);
+
+			auto best = FreeRectFit<Numeric>{};
+			for (auto lane = std::size_t{0}; lane < lanes; ++lane) {
+				if (lane_block[lane] < Numeric{}) {
+					continue;
+				}
+				const auto index = static_cast<std::size_t>(lane_block[lane]) * lanes + lane;
+				const auto primary = lane_primary[lane];
+				const auto secondary = lane_secondary[lane];
+				if (!best.found() || primary < best.primary ||
+					(primary == best.primary && (secondary < best.secondary ||
+						(secondary == best.secondary && index < best.index)))) {
+					best.index = index;
+					best.primary = primary;
+					best.secondary = secondary;
+				}
+			}
+
+			scan_scalar<Score>(list, vector_end, width, height, best);
+			return best;
+		}
+
+		template<FreeRectScore Score, typename Numeric>
+		auto scan(const FreeRectList<Numeric>& list, Numeric width, Numeric height) noexcept -> FreeRectFit<Numeric> {
+			using Lanes = typename simd_lanes<Numeric>::type;
+			if constexpr (std::is_void_v<Lanes>) {
+				auto best = FreeRectFit<Numeric>{};
+				scan_scalar<Score>(list, std::size_t{0}, width, height, best);
+				return best;
+			} else {
+				return scan_simd<Lanes, Score>(list, width, height);
+			}
+		}
+
+	}
+
+	template<typename Numeric>
+	FreeRectList<Numeric>::FreeRectList(std::pmr::memory_resource* resource)
+		: x{resource}, y{resource}, w{resource}, h{resource}, id{resource} {
+	}
+
+	template<typename Numeric>
+	auto FreeRectList<Numeric>::size() const noexcept -> std::size_t {
+		return x.size();
+	}
+
+	template<typename Numeric>
+	auto FreeRectList<Numeric>::empty() const noexcept -> bool {
+		return x.empty();
+	}
+
+	template<typename Numeric>
+	auto FreeRectList<Numeric>::clear() noexcept -> void {
+		x.clear();
+		y.clear();
+		w.clear();
+		h.clear();
+		id.clear();
+		next_id = std::uint32_t{0};
+	}
+
+	template<typename Numeric>
+	auto FreeRectList<Numeric>::reserve(std::size_t capacity) -> void {
+		x.reserve(capacity);
+		y.reserve(capacity);
+		w.reserve(capacity);
+		h.reserve(capacity);
+		id.reserve(capacity);
+	}
+
+	template<typename Numeric>
+	auto FreeRectList<Numeric>::emplace_back(Numeric width, Numeric height, Numeric x_pos, Numeric y_pos) -> void {
+		x.push_back(x_pos);
+		y.push_back(y_pos);
+		w.push_back(width);
+		h.push_back(height);
+		id.push_back(next_id++);
+	}
+
+	template<typename Numeric>
+	auto FreeRectList<Numeric>::push_back(const Rectangle<Numeric>& rect) -> void {
+		emplace_back(rect.w, rect.h, rect.x, rect.y);
+	}
+
+	template<typename Numeric>
+	auto FreeRectList<Numeric>::erase(std::size_t index) -> void {
+		x.erase(x.begin() + index);
+		y.erase(y.begin() + index);
+		w.erase(w.begin() + index);
+		h.erase(h.begin() + index);
+		id.erase(id.begin() + index);
+	}
+
+	template<typename Numeric>
+	auto FreeRectList<Numeric>::compact(std::span<const std::uint8_t> removed) noexcept -> void {
+		auto kept = std::size_t{0};
+		for (auto i = std::size_t{0}; i < x.size(); ++i) {
+			if (removed[i]) {
+				continue;
+			}
+			if (kept != i) {
+				x[kept] = x[i];
+				y[kept] = y[i];
+				w[kept] = w[i];
+				h[kept] = h[i];
+				id[kept] = id[i];
+			}
+			++kept;
+		}
+		x.resize(kept);
+		y.resize(kept);
+		w.resize(kept);
+		h.resize(kept);
+		id.resize(kept);
+	}
+
+	template<typename Numeric>
+	auto FreeRectList<Numeric>::operator[](std::size_t index) const -> Rectangle<Numeric> {
+		return Rectangle<Numeric>{w[index], h[index], x[index], y[index]};
+	}
+
+	template<typename Numeric>
+	auto FreeRectList<Numeric>::contains(std::size_t outer, std::size_t inner) const noexcept -> bool {
+		return x[inner] >= x[outer] && y[inner] >= y[outer] &&
+			x[inner] + w[inner] <= x[outer] + w[outer] &&
+			y[inner] + h[inner] <= y[outer] + h[outer];
+	}
+
+	template<typename Numeric>
+	auto FreeRectList<Numeric>::find_best(Numeric width, Numeric height, FreeRectScore score) const noexcept -> FreeRectFit<Numeric> {
+		switch (score) {
+			case FreeRectScore::LongSide:
+				return scan<FreeRectScore::LongSide>(*this, width, height);
+			case FreeRectScore::Area:
+				return scan<FreeRectScore::Area>(*this, width, height);
+			case FreeRectScore::BottomLeft:
+				return scan<FreeRectScore::BottomLeft>(*this, width, height);
+			default:
+				return scan<FreeRectScore::ShortSide>(*this, width, height);
+		}
+	}
+
+	template<typename Numeric>
+	auto FreeRectList<Numeric>::find_best_scalar(Numeric width, Numeric height, FreeRectScore score) const noexcept -> FreeRectFit<Numeric> {
+		return find_best_from(std::size_t{0}, width, height, score);
+	}
+
+	template<typename Numeric>
+	auto FreeRectList<Numeric>::find_best_from(std::size_t first, Numeric width, Numeric height,
+												FreeRectScore score) const noexcept -> FreeRectFit<Numeric> {
+		auto best = FreeRectFit<Numeric>{};
+		switch (score) {
+			case FreeRectScore::LongSide:
+				scan_scalar<FreeRectScore::LongSide>(*this, first, width, height, best);
+				break;
+			case FreeRectScore::Area:
+				scan_scalar<FreeRectScore::Area>(*this, first, width, height, best);
+				break;
+			case FreeRectScore::BottomLeft:
+				scan_scalar<FreeRectScore::BottomLeft>(*this, first, width, height, best);
+				break;
+			default:
+				scan_scalar<FreeRectScore::ShortSide>(*this, first, width, height, best);
+				break;
+		}
+		return best;
+	}
+
+	template<typename Numeric>
+	auto FreeRectList<Numeric>::renumber() noexcept -> void {
+		std::iota(id.begin(), id.end(), std::uint32_t{0});
+		next_id = static_cast<std::uint32_t>(id.size());
+	}
+
+	template<typename Numeric>
+	auto FreeRectList<Numeric>::lower_bound_id(std::uint32_t rect_id) const noexcept -> std::size_t {
+		return static_cast<std::size_t>(std::lower_bound(id.begin(), id.end(), rect_id) - id.begin());
+	}
+
+
+	template class FreeRectList<float>;
+
+	template class FreeRectList<double>;
+
+	template class FreeRectList<int>;
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "rectangle.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+namespace MaxRects {
+
+	enum struct FreeRectScore : std::uint8_t {
+		ShortSide = 0,
+		LongSide = 1,
+		Area = 2,
+		BottomLeft = 3
+	};
+
+	template<typename Numeric = float>
+	struct FreeRectFit {
+		static constexpr auto npos = std::numeric_limits<std::size_t>::max();
+
+		std::size_t index{npos};
+		Numeric primary{std::numeric_limits<Numeric>::max()};
+		Numeric secondary{std::numeric_limits<Numeric>::max()};
+
+		[[nodiscard]] constexpr auto found() const noexcept -> bool {
+			return index != npos;
+		}
+	};
+
+	// Once next_id reaches this the owner renumbers, long before 32-bit ids
+	// could wrap; no single placement or merge gets near the headroom left.
+	constexpr auto free_rect_id_limit = std::uint32_t{1} << 31;
+
+	// Free rectangles stored as separate x/y/w/h arrays so the fit scan only
+	// streams the four coordinates it actually reads. Rects are only ever
+	// appended or compacted, so ids stay in ascending order and everything
+	// added since an id was handed out is the tail from that id on.
+	template<typename Numeric = float>
+	class FreeRectList {
+	public:
+		std::pmr::vector<Numeric> x{};
+		std::pmr::vector<Numeric> y{};
+		std::pmr::vector<Numeric> w{};
+		std::pmr::vector<Numeric> h{};
+		std::pmr::vector<std::uint32_t> id{};
+		std::uint32_t next_id{};
+
+		FreeRectList() = default;
+
+		explicit FreeRectList(std::pmr::memory_resource* resource);
+
+		[[nodiscard]] auto size() const noexcept -> std::size_t;
+
+		[[nodiscard]] auto empty() const noexcept -> bool;
+
+		auto clear() noexcept -> void;
+
+		auto reserve(std::size_t capacity) -> void;
+
+		auto emplace_back(Numeric width, Numeric height, Numeric x_pos, Numeric y_pos) -> void;
+
+		auto push_back(const Rectangle<Numeric>& rect) -> void;
+
+		auto erase(std::size_t index) -> void;
+
+		auto compact(std::span<const std::uint8_t> removed) noexcept -> void;
+
+		// Hands out ids from zero again in list order. Every id held outside
+		// the list is meaningless afterwards.
+		auto renumber() noexcept -> void;
+
+		[[nodiscard]] auto operator[](std::size_t index) const -> Rectangle<Numeric>;
+
+		[[nodiscard]] auto contains(std::size_t outer, std::size_t inner) const noexcept -> bool;
+
+		[[nodiscard]] auto find_best(Numeric width, Numeric height, FreeRectScore score) const noexcept -> FreeRectFit<Numeric>;
+
+		[[nodiscard]] auto find_best_scalar(Numeric width, Numeric height, FreeRectScore score) const noexcept -> FreeRectFit<Numeric>;
+
+		// Scans only the rects from index first on.
+		[[nodiscard]] auto find_best_from(std::size_t first, Numeric width, Numeric height,
+										FreeRectScore score) const noexcept -> FreeRectFit<Numeric>;
+
+		// Index of the first rect whose id is not below rect_id.
+		[[nodiscard]] auto lower_bound_id(std::uint32_t rect_id) const noexcept -> std::size_t;
+	};
+
+}
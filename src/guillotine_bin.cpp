@@ -0,0 +1,382 @@
+#include "guillotine_bin.h"
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+
+namespace MaxRects {
+
+	template<typename RectType, typename Numeric>
+	GuillotineBin<RectType, Numeric>::GuillotineBin(Numeric max_w, Numeric max_h, Numeric padding, const PackingOptions<Numeric>& opts,
+													std::pmr::memory_resource* resource)
+		: AbstractBin<RectType, Numeric>{max_w, max_h, opts, resource}, border{opts.border}, free_set{resource},
+		padding{padding} {
+		this->width = this->options.smart ? Numeric{} : max_w;
+		this->height = this->options.smart ? Numeric{} : max_h;
+		reset_free_set();
+	}
+
+	template<typename RectType, typename Numeric>
+	auto GuillotineBin<RectType, Numeric>::add(const RectType& rect) -> RectType* {
+		const auto fit = find_fit(rect);
+		if (!fit.found) {
+			return nullptr;
+		}
+		return commit_fit(rect, fit);
+	}
+
+	template<typename RectType, typename Numeric>
+	auto GuillotineBin<RectType, Numeric>::add(RectType&& rect) -> RectType* {
+		const auto fit = find_fit(rect);
+		if (!fit.found) {
+			return nullptr;
+		}
+		return commit_fit(std::move(rect), fit);
+	}
+
+	template<typename RectType, typename Numeric>
+	auto GuillotineBin<RectType, Numeric>::find_node(Numeric w, Numeric h) const -> typename FreeSet::const_iterator {
+		auto visited = std::size_t{0};
+		const auto node = free_set.find(w, h, visited);
+		stats_recorder.count_scan(visited);
+		return node;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto GuillotineBin<RectType, Numeric>::find_fit(Numeric w, Numeric h) const -> BinFit<Numeric> {
+		auto fit = BinFit<Numeric>{};
+		if (w <= Numeric{} || h <= Numeric{}) {
+			return fit;
+		}
+		auto node = find_node(w, h);
+		auto rotated = false;
+		if (this->options.allow_rotation && w != h) {
+			stats_recorder.count_rotation_retry();
+			const auto turned = find_node(h, w);
+			if (turned != free_set.end() && (node == free_set.end() || turned->w * turned->h < node->w * node->h)) {
+				node = turned;
+				rotated = true;
+			}
+		}
+		if (node == free_set.end()) {
+			return fit;
+		}
+		if (rotated) {
+			std::swap(w, h);
+		}
+		fit.x = node->x;
+		fit.y = node->y;
+		fit.w = w;
+		fit.h = h;
+		fit.primary = node->w * node->h;
+		fit.secondary = std::min(node->w - w, node->h - h);
+		fit.rotated = rotated;
+		fit.found = true;
+		return fit;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto GuillotineBin<RectType, Numeric>::commit_fit(RectType rect, const BinFit<Numeric>& fit) -> RectType* {
+		if (!reserve_fit(fit)) {
+			return nullptr;
+		}
+
+		rect.x = fit.x;
+		rect.y = fit.y;
+		rect.rot = fit.rotated;
+		if (fit.rotated) {
+			std::swap(rect.w, rect.h);
+		}
+
+		this->rects.push_back(std::move(rect));
+		this->set_dirty(true);
+		return &this->rects.back();
+	}
+
+	template<typename RectType, typename Numeric>
+	auto GuillotineBin<RectType, Numeric>::reserve_fit(const BinFit<Numeric>& fit) -> bool {
+		if (!fit.found) {
+			return false;
+		}
+		// The lookup is deterministic, so it lands on the node find_fit picked
+		// unless the set changed in between; then fall back to a walk.
+		auto node = find_node(fit.w, fit.h);
+		if (node == free_set.end() || node->x != fit.x || node->y != fit.y) {
+			node = free_set.begin();
+			while (node != free_set.end() &&
+				!(node->x == fit.x && node->y == fit.y && node->w >= fit.w && node->h >= fit.h)) {
+				++node;
+			}
+		}
+		if (node == free_set.end()) {
+			return false;
+		}
+		stats_recorder.count_insert();
+		const auto used = *node;
+		free_set.erase(node);
+		split(used, fit.w, fit.h);
+		stats_recorder.observe_free_rects(free_set.size());
+
+		if (this->options.smart) {
+			extent_x = std::max(extent_x, fit.x + fit.w);
+			extent_y = std::max(extent_y, fit.y + fit.h);
+			this->apply_extents(extent_x, extent_y);
+		}
+		return true;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto GuillotineBin<RectType, Numeric>::occupy(const Rectangle<Numeric>& region) -> void {
+		const auto right = region.x + region.w;
+		const auto top = region.y + region.h;
+		auto pieces = std::pmr::vector<FreeNode>{this->memory_resource};
+		for (auto node = free_set.begin(); node != free_set.end();) {
+			if (node->x >= right || node->x + node->w <= region.x || node->y >= top || node->y + node->h <= region.y) {
+				++node;
+				continue;
+			}
+			// Full-height strips either side of the region, then the parts
+			// above and below it between them.
+			const auto cut = *node;
+			node = free_set.erase(node);
+			if (cut.x < region.x) {
+				pieces.push_back(FreeNode{cut.x, cut.y, region.x - cut.x, cut.h});
+			}
+			if (cut.x + cut.w > right) {
+				pieces.push_back(FreeNode{right, cut.y, cut.x + cut.w - right, cut.h});
+			}
+			const auto from = std::max(cut.x, region.x);
+			const auto to = std::min(cut.x + cut.w, right);
+			if (cut.y < region.y) {
+				pieces.push_back(FreeNode{from, cut.y, to - from, region.y - cut.y});
+			}
+			if (cut.y + cut.h > top) {
+				pieces.push_back(FreeNode{from, top, to - from, cut.y + cut.h - top});
+			}
+		}
+		free_set.insert(pieces.begin(), pieces.end());
+
+		if (this->options.smart) {
+			extent_x = std::max(extent_x, right);
+			extent_y = std::max(extent_y, top);
+			this->apply_extents(extent_x, extent_y);
+		}
+	}
+
+	template<typename RectType, typename Numeric>
+	auto GuillotineBin<RectType, Numeric>::split(const FreeNode& node, Numeric w, Numeric h) -> void {
+		const auto leftover_w = node.w - w;
+		const auto leftover_h = node.h - h;
+		auto horizontal = true;
+		switch (this->options.guillotine_split) {
+			case GuillotineSplit::ShorterLeftoverAxis:
+				horizontal = leftover_w <= leftover_h;
+				break;
+			case GuillotineSplit::LongerLeftoverAxis:
+				horizontal = leftover_w > leftover_h;
+				break;
+			case GuillotineSplit::MinArea:
+				horizontal = w * leftover_h > leftover_w * h;
+				break;
+			case GuillotineSplit::MaxArea:
+				horizontal = w * leftover_h <= leftover_w * h;
+				break;
+		}
+
+		// A horizontal cut gives the strip above the rect the node's full width;
+		// a vertical cut gives the strip to its right the full height.
+		const auto above = FreeNode{node.x, node.y + h, horizontal ? node.w : w, leftover_h};
+		const auto beside = FreeNode{node.x + w, node.y, leftover_w, horizontal ? h : node.h};
+		auto pieces = std::size_t{0};
+		for (const auto& piece : {above, beside}) {
+			if (piece.w > Numeric{} && piece.h > Numeric{}) {
+				free_set.insert(piece);
+				++pieces;
+			}
+		}
+		stats_recorder.count_splits(pieces);
+	}
+
+	template<typename RectType, typename Numeric>
+	auto GuillotineBin<RectType, Numeric>::remove(std::size_t index) -> bool {
+		if (index >= this->rects.size()) {
+			return false;
+		}
+		const auto& rect = this->rects[index];
+		const auto x = rect.x;
+		const auto y = rect.y;
+		const auto w = rect.w;
+		const auto h = rect.h;
+		AbstractBin<RectType, Numeric>::remove(index);
+		free_region(x, y, w, h);
+
+		if (this->options.smart && (x + w >= extent_x || y + h >= extent_y)) {
+			calculate_max_dimensions();
+		}
+		return true;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto GuillotineBin<RectType, Numeric>::free_region(Numeric x, Numeric y, Numeric w, Numeric h) -> void {
+		if (w <= Numeric{} || h <= Numeric{}) {
+			return;
+		}
+		auto region = FreeNode{x, y, w, h};
+		for (auto merged = true; merged;) {
+			merged = false;
+			for (auto node = free_set.begin(); node != free_set.end(); ++node) {
+				const auto same_columns = node->x == region.x && node->w == region.w;
+				const auto same_rows = node->y == region.y && node->h == region.h;
+				if (same_columns && (node->y + node->h == region.y || region.y + region.h == node->y)) {
+					region = FreeNode{region.x, std::min(region.y, node->y), region.w, region.h + node->h};
+				} else if (same_rows && (node->x + node->w == region.x || region.x + region.w == node->x)) {
+					region = FreeNode{std::min(region.x, node->x), region.y, region.w + node->w, region.h};
+				} else {
+					continue;
+				}
+				free_set.erase(node);
+				merged = true;
+				break;
+			}
+		}
+		free_set.insert(region);
+		stats_recorder.observe_free_rects(free_set.size());
+	}
+
+	template<typename RectType, typename Numeric>
+	auto GuillotineBin<RectType, Numeric>::free_rects() const noexcept -> const FreeSet& {
+		return free_set;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto GuillotineBin<RectType, Numeric>::capacity() const noexcept -> BinCapacity<Numeric> {
+		if (free_set.empty()) {
+			return BinCapacity<Numeric>{};
+		}
+		return BinCapacity<Numeric>{free_set.max_w(), free_set.max_h(), free_set.max_area()};
+	}
+
+	template<typename RectType, typename Numeric>
+	auto GuillotineBin<RectType, Numeric>::stats() const noexcept -> PackingStats {
+		return stats_recorder.snapshot();
+	}
+
+	template<typename RectType, typename Numeric>
+	auto GuillotineBin<RectType, Numeric>::repack() -> std::pmr::vector<RectType> {
+		auto unpacked = std::pmr::vector<RectType>{this->memory_resource};
+		this->rect_slots.resize(this->rects.size(), no_rect_slot);
+		this->unpacked_slots.clear();
+		reset_free_set();
+		for (const auto& region : this->reserved) {
+			occupy(region);
+		}
+
+		auto indices = std::pmr::vector<std::size_t>(this->rects.size(), this->memory_resource);
+		std::iota(indices.begin(), indices.end(), std::size_t{0});
+		std::sort(indices.begin(), indices.end(), [this](auto a, auto b) {
+			const auto max_a = std::max(this->rects[a].w, this->rects[a].h);
+			const auto max_b = std::max(this->rects[b].w, this->rects[b].h);
+			return max_b < max_a || (max_b == max_a && a < b);
+		});
+		auto kept = std::pmr::vector<std::uint8_t>(this->rects.size(), std::uint8_t{1}, this->memory_resource);
+		for (auto idx : indices) {
+			auto& rect = this->rects[idx];
+			const auto fit = find_fit(rect.w, rect.h);
+			if (!fit.found || !reserve_fit(fit)) {
+				unpacked.push_back(rect);
+				this->unpacked_slots.push_back(this->rect_slots[idx]);
+				kept[idx] = std::uint8_t{0};
+				continue;
+			}
+			rect.x = fit.x;
+			rect.y = fit.y;
+			if (fit.rotated) {
+				std::swap(rect.w, rect.h);
+				rect.rot = !rect.rot;
+			}
+		}
+
+		if (!unpacked.empty()) {
+			auto count = std::size_t{0};
+			for (auto i = std::size_t{0}; i < this->rects.size(); ++i) {
+				if (kept[i]) {
+					if (count != i) {
+						this->rects[count] = std::move(this->rects[i]);
+						this->rect_slots[count] = this->rect_slots[i];
+					}
+					++count;
+				}
+			}
+			this->rects.resize(count);
+			this->rect_slots.resize(count);
+		}
+		this->set_dirty(false);
+		return unpacked;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto GuillotineBin<RectType, Numeric>::clone(std::pmr::memory_resource* resource) const -> std::unique_ptr<AbstractBin<RectType, Numeric>> {
+		auto cloned = std::unique_ptr<GuillotineBin<RectType, Numeric>>(new (resource) GuillotineBin<RectType, Numeric>(
+			this->max_width, this->max_height, padding, this->options, resource));
+
+		cloned->width = this->width;
+		cloned->height = this->height;
+		cloned->extent_x = extent_x;
+		cloned->extent_y = extent_y;
+		cloned->free_set = free_set;
+		cloned->stats_recorder = stats_recorder;
+		cloned->rects = this->rects;
+		cloned->rect_slots = this->rect_slots;
+		cloned->reserved = this->reserved;
+		cloned->tag = this->tag;
+
+		return cloned;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto GuillotineBin<RectType, Numeric>::reset() -> void {
+		AbstractBin<RectType, Numeric>::reset();
+		this->width = this->options.smart ? Numeric{} : this->max_width;
+		this->height = this->options.smart ? Numeric{} : this->max_height;
+		reset_free_set();
+	}
+
+	template<typename RectType, typename Numeric>
+	auto GuillotineBin<RectType, Numeric>::calculate_max_dimensions() -> void {
+		extent_x = Numeric{};
+		extent_y = Numeric{};
+
+		if (this->rects.empty() && this->reserved.empty()) {
+			this->width = this->options.smart ? Numeric{} : this->max_width;
+			this->height = this->options.smart ? Numeric{} : this->max_height;
+			return;
+		}
+
+		std::tie(extent_x, extent_y) = this->content_extents();
+
+		this->apply_extents(extent_x, extent_y);
+	}
+
+	template<typename RectType, typename Numeric>
+	auto GuillotineBin<RectType, Numeric>::reset_free_set() -> void {
+		extent_x = Numeric{};
+		extent_y = Numeric{};
+		free_set.clear();
+		const auto span_w = this->max_width + padding - border * Numeric{2};
+		const auto span_h = this->max_height + padding - border * Numeric{2};
+		if (span_w > Numeric{} && span_h > Numeric{}) {
+			free_set.insert(FreeNode{border, border, span_w, span_h});
+		}
+	}
+
+
+	template class GuillotineBin<Rectangle<float>, float>;
+
+	template class GuillotineBin<Rectangle<double>, double>;
+
+	template class GuillotineBin<Rectangle<int>, int>;
+
+	template class GuillotineBin<CompactRect<std::int16_t>, int>;
+
+	template class GuillotineBin<CompactRect<std::int32_t>, int>;
+
+}
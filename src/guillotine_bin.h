@@ -0,0 +1,79 @@
+#pragma once
+
+#include "abstract_bin.h"
+#include "free_node_tree.h"
+
+namespace MaxRects {
+
+	// Bin that cuts every used free rect in two along one axis, so free rects
+	// never overlap and need no pruning. They sit in a FreeNodeTree, so the
+	// narrowest free rect that holds a size is a logarithmic lookup;
+	// PackingStats::free_rects_scanned counts the tree nodes it visits.
+	template<typename RectType = Rectangle<float>, typename Numeric = float>
+	class GuillotineBin : public AbstractBin<RectType, Numeric> {
+	public:
+		using FreeSet = FreeNodeTree<Numeric>;
+		using FreeNode = typename FreeSet::Node;
+
+		Numeric border{Numeric{}};
+
+		explicit GuillotineBin(Numeric max_w, Numeric max_h, Numeric padding = Numeric{},
+								const PackingOptions<Numeric>& opts = {},
+								std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+		auto add(const RectType& rect) -> RectType* override;
+
+		auto add(RectType&& rect) -> RectType* override;
+
+		using AbstractBin<RectType, Numeric>::find_fit;
+
+		[[nodiscard]] auto find_fit(Numeric w, Numeric h) const -> BinFit<Numeric> override;
+
+		auto commit_fit(RectType rect, const BinFit<Numeric>& fit) -> RectType* override;
+
+		auto reserve_fit(const BinFit<Numeric>& fit) -> bool override;
+
+		using AbstractBin<RectType, Numeric>::remove;
+
+		auto remove(std::size_t index) -> bool override;
+
+		// Returns a region to the free set, merging it with neighbours that
+		// share a full edge.
+		auto free_region(Numeric x, Numeric y, Numeric w, Numeric h) -> void;
+
+		[[nodiscard]] auto free_rects() const noexcept -> const FreeSet&;
+
+		[[nodiscard]] auto capacity() const noexcept -> BinCapacity<Numeric> override;
+
+		[[nodiscard]] auto stats() const noexcept -> PackingStats override;
+
+		auto repack() -> std::pmr::vector<RectType> override;
+
+		using AbstractBin<RectType, Numeric>::clone;
+
+		auto clone(std::pmr::memory_resource* resource) const -> std::unique_ptr<AbstractBin<RectType, Numeric>> override;
+
+		auto reset() -> void override;
+
+	protected:
+		FreeSet free_set;
+		Numeric padding{Numeric{}};
+		Numeric extent_x{Numeric{}};
+		Numeric extent_y{Numeric{}};
+		[[no_unique_address]] mutable StatsRecorder<> stats_recorder{};
+
+		auto calculate_max_dimensions() -> void override;
+
+		// Narrowest, then shortest, node that holds w by h, or end().
+		[[nodiscard]] auto find_node(Numeric w, Numeric h) const -> typename FreeSet::const_iterator;
+
+		auto split(const FreeNode& node, Numeric w, Numeric h) -> void;
+
+		// Cuts region out of every free node it overlaps, for a reserved
+		// region replayed into a fresh set.
+		auto occupy(const Rectangle<Numeric>& region) -> void;
+
+		auto reset_free_set() -> void;
+	};
+
+}
@@ -1,9 +1,12 @@
 #pragma once
 
 #include "rectangle.h"
+#include "compact_rect.h"
 #include "abstract_bin.h"
 #include "maxrects_bin.h"
 #include "oversized_element_bin.h"
+#include "skyline_bin.h"
+#include "guillotine_bin.h"
 #include "maxrects_packer.h"
 
 namespace MaxRects {
@@ -14,4 +17,8 @@ namespace MaxRects {
 
 	using OversizedBin = OversizedElementBin<Rectangle<float>, float>;
 
+	using CompactPacker = MaxRectsPacker<int, CompactRect<std::int32_t>>;
+
+	using CompactPacker16 = MaxRectsPacker<int, CompactRect<std::int16_t>>;
+
 }
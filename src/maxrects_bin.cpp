@@ -1,14 +1,20 @@
 #include "maxrects_bin.h"
+#include "thread_pool.h"
 #include <optional>
 #include <limits>
 #include <algorithm>
 #include <cmath>
+#include <tuple>
 
 namespace MaxRects {
 
 	template<typename RectType, typename Numeric>
-	MaxRectsBin<RectType, Numeric>::MaxRectsBin(Numeric max_w, Numeric max_h, Numeric padding, const PackingOptions<Numeric>& opts)
-		: stage{Numeric{}, Numeric{}} {
+	MaxRectsBin<RectType, Numeric>::MaxRectsBin(Numeric max_w, Numeric max_h, Numeric padding, const PackingOptions<Numeric>& opts,
+												std::pmr::memory_resource* resource)
+		: AbstractBin<RectType, Numeric>{max_w, max_h, opts, resource}, stage{Numeric{}, Numeric{}},
+		free_rectangles{resource}, used_rectangles{resource}, free_rect_marks{resource}, free_rect_grid{resource},
+		merge_neighbours{resource}, candidate_neighbours{resource},
+		vertical_edges{resource}, horizontal_edges{resource} {
 		
 		this->max_width = max_w;
 		this->max_height = max_h;
@@ -23,126 +29,309 @@ namespace MaxRects {
 			border,
 			border
 		);
+		reset_contact_edges();
+		rebuild_free_rect_grid();
+		refresh_capacity();
 		
 		stage = Rectangle<Numeric>{this->width, this->height};
 	}
 
 	template<typename RectType, typename Numeric>
 	auto MaxRectsBin<RectType, Numeric>::add(const RectType& rect) -> RectType* {
-		if (this->options.tag && this->options.exclusive_tag) {
-			
+		const auto fit = find_fit(rect);
+		if (!fit.found) {
+			return nullptr;
 		}
-		auto best_short_side_fit = std::numeric_limits<Numeric>::max();
-		auto best_long_side_fit = std::numeric_limits<Numeric>::max();
-		auto best_area_fit = std::numeric_limits<Numeric>::max();
+		return commit_fit(rect, fit);
+	}
 
-		auto new_node = Rectangle<Numeric>{};
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::add(RectType&& rect) -> RectType* {
+		const auto fit = find_fit(rect);
+		if (!fit.found) {
+			return nullptr;
+		}
+		return commit_fit(std::move(rect), fit);
+	}
 
-		if (this->options.logic == PackingLogic::MaxArea) {
-			new_node = find_position_for_new_node_best_area_fit(rect.w, rect.h, best_area_fit, best_short_side_fit);
-		} else if (this->options.logic == PackingLogic::MaxEdge) {
-			new_node = find_position_for_new_node_best_long_side_fit(rect.w, rect.h, best_short_side_fit, best_long_side_fit);
-		} else {
-			new_node = find_position_for_new_node_best_short_side_fit(rect.w, rect.h, best_short_side_fit, best_long_side_fit);
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::find_fit(Numeric w, Numeric h) const -> BinFit<Numeric> {
+		const auto fit = score_fit(w, h);
+		stats_recorder.count_scan(free_rectangles.size());
+		if (this->options.allow_rotation && (!fit.found || fit.rotated)) {
+			stats_recorder.count_rotation_retry();
+			stats_recorder.count_scan(free_rectangles.size());
 		}
+		return fit;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::score_fit(Numeric w, Numeric h) const -> BinFit<Numeric> {
+		auto entry = CachedFit<Numeric>{};
+		refresh_fit(Size<Numeric>{w, h}, entry);
+		return entry.fit;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::refresh_fit(const Size<Numeric>& size, CachedFit<Numeric>& entry) const -> std::size_t {
+		const auto score = free_rect_score(this->options.logic);
 		
-		if (new_node.h == Numeric{}) {
-			if (this->options.allow_rotation) {
-				if (this->options.logic == PackingLogic::MaxArea) {
-					new_node = find_position_for_new_node_best_area_fit(rect.h, rect.w, best_area_fit, best_short_side_fit);
-				} else if (this->options.logic == PackingLogic::MaxEdge) {
-					new_node = find_position_for_new_node_best_long_side_fit(rect.h, rect.w, best_short_side_fit, best_long_side_fit);
-				} else {
-					new_node = find_position_for_new_node_best_short_side_fit(rect.h, rect.w, best_short_side_fit, best_long_side_fit);
-				}
-				
-				if (new_node.h != Numeric{}) {
-					new_node.rot = true;
+		// Within one version free rects are only split or pruned, never grown.
+		// A cached fit whose free rect survived is still the best of the old
+		// rects, so only rects added since can beat it, and a size that fitted
+		// nowhere still fits nowhere. Contact scores change with every
+		// placement, so they are never reused.
+		if (entry.version == free_version && this->options.logic != PackingLogic::ContactPoint) {
+			if (!entry.fit.found) {
+				return 0;
+			}
+			const auto at = free_rectangles.lower_bound_id(entry.region);
+			if (at < free_rectangles.size() && free_rectangles.id[at] == entry.region) {
+				const auto first = free_rectangles.lower_bound_id(entry.watermark);
+				const auto added = free_rectangles.find_best_from(first, entry.fit.w, entry.fit.h, score);
+				if (added.found() && (added.primary < entry.fit.primary ||
+					(added.primary == entry.fit.primary && added.secondary < entry.fit.secondary))) {
+					entry.fit = make_fit(added, entry.fit.w, entry.fit.h, entry.fit.rotated);
+					entry.region = free_rectangles.id[added.index];
 				}
+				entry.watermark = free_rectangles.next_id;
+				return free_rectangles.size() - first;
 			}
 		}
 		
-		if (new_node.h == Numeric{}) {
-			return nullptr;
+		auto scanned = free_rectangles.size();
+		auto best = find_free_rect(size.w, size.h, score);
+		entry.fit = make_fit(best, size.w, size.h, false);
+		if (!entry.fit.found && this->options.allow_rotation) {
+			scanned += free_rectangles.size();
+			best = find_free_rect(size.h, size.w, score);
+			entry.fit = make_fit(best, size.h, size.w, true);
+		}
+		entry.region = entry.fit.found ? free_rectangles.id[best.index] : std::uint32_t{0};
+		entry.watermark = free_rectangles.next_id;
+		entry.version = free_version;
+		return scanned;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::find_fits(std::span<const Size<Numeric>> sizes, std::span<CachedFit<Numeric>> fits,
+													ThreadPool* pool) const -> void {
+		const auto chunks = (sizes.size() + parallel_fit_chunk - 1) / parallel_fit_chunk;
+		auto scanned = std::pmr::vector<std::size_t>(chunks, std::size_t{0}, this->memory_resource);
+		const auto score_chunk = [&](std::size_t chunk) {
+			const auto last = std::min(sizes.size(), (chunk + 1) * parallel_fit_chunk);
+			for (auto i = chunk * parallel_fit_chunk; i < last; ++i) {
+				scanned[chunk] += refresh_fit(sizes[i], fits[i]);
+			}
+		};
+		if (pool && chunks > 1) {
+			pool->parallel_for(chunks, score_chunk);
+		} else {
+			for (auto chunk = std::size_t{0}; chunk < chunks; ++chunk) {
+				score_chunk(chunk);
+			}
+		}
+		for (auto count : scanned) {
+			stats_recorder.count_scan(count);
+		}
+	}
+
+	template<typename RectType, typename Numeric>
+	template<typename Commit>
+	auto MaxRectsBin<RectType, Numeric>::place_best_first(std::span<const Size<Numeric>> sizes, Commit&& commit) -> void {
+		auto candidates = std::pmr::vector<std::size_t>(sizes.size(), this->memory_resource);
+		auto pending = std::pmr::vector<Size<Numeric>>(sizes.begin(), sizes.end(), this->memory_resource);
+		auto fits = std::pmr::vector<CachedFit<Numeric>>(sizes.size(), this->memory_resource);
+		for (auto i = std::size_t{0}; i < candidates.size(); ++i) {
+			candidates[i] = i;
 		}
 		
-		place_rectangle(new_node);
+		while (!candidates.empty()) {
+			find_fits(pending, fits);
+			auto best = no_bin;
+			for (auto i = std::size_t{0}; i < candidates.size(); ++i) {
+				if (fits[i].fit.better_than(best == no_bin ? BinFit<Numeric>{} : fits[best].fit)) {
+					best = i;
+				}
+			}
+			if (best == no_bin) {
+				return;
+			}
+			commit(candidates[best], fits[best].fit);
+			
+			auto kept = std::size_t{0};
+			for (auto i = std::size_t{0}; i < candidates.size(); ++i) {
+				if (i != best && fits[i].fit.found) {
+					candidates[kept] = candidates[i];
+					pending[kept] = pending[i];
+					fits[kept] = fits[i];
+					++kept;
+				}
+			}
+			candidates.resize(kept);
+			pending.resize(kept);
+			fits.resize(kept);
+		}
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::commit_fit(RectType rect, const BinFit<Numeric>& fit) -> RectType* {
+		reserve_fit(fit);
 		
-		auto result_rect = rect;
-		result_rect.x = new_node.x;
-		result_rect.y = new_node.y;
-		result_rect.rot = new_node.rot;
-		if (new_node.rot) {
-			result_rect.w = rect.h;
-			result_rect.h = rect.w;
+		rect.x = fit.x;
+		rect.y = fit.y;
+		rect.rot = fit.rotated;
+		if (fit.rotated) {
+			std::swap(rect.w, rect.h);
 		}
-				this->rects.push_back(result_rect);
+		
+		this->rects.push_back(std::move(rect));
 		this->set_dirty(true);
+		return &this->rects.back();
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::reserve_fit(const BinFit<Numeric>& fit) -> bool {
+		occupy(Rectangle<Numeric>{fit.w, fit.h, fit.x, fit.y});
+		return true;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::occupy(const Rectangle<Numeric>& node) -> void {
+		stats_recorder.count_insert();
+		place_rectangle(node);
+		add_contact_edges(node);
+		update_bin_size(node);
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::remove(std::size_t index) -> bool {
+		if (index >= this->rects.size()) {
+			return false;
+		}
+		const auto& rect = this->rects[index];
+		const auto region = Rectangle<Numeric>{rect.w, rect.h, rect.x, rect.y};
+		AbstractBin<RectType, Numeric>::remove(index);
+		free_region(region);
+		remove_contact_edges(region);
 		
-		if (this->options.smart) {
+		if (this->options.smart && (region.x + region.w >= extent_x || region.y + region.h >= extent_y)) {
 			calculate_max_dimensions();
 		}
-		return &this->rects.back();
+		return true;
 	}
 
 	template<typename RectType, typename Numeric>
-	auto MaxRectsBin<RectType, Numeric>::add(RectType&& rect) -> RectType* {
-		if (this->options.tag && this->options.exclusive_tag) {
-			
+	auto MaxRectsBin<RectType, Numeric>::free_region(const Rectangle<Numeric>& region) -> void {
+		if (region.w <= Numeric{} || region.h <= Numeric{}) {
+			return;
 		}
-		auto best_short_side_fit = std::numeric_limits<Numeric>::max();
-		auto best_long_side_fit = std::numeric_limits<Numeric>::max();
-		auto best_area_fit = std::numeric_limits<Numeric>::max();
-
-		auto new_node = Rectangle<Numeric>{};
-
-		if (this->options.logic == PackingLogic::MaxArea) {
-			new_node = find_position_for_new_node_best_area_fit(rect.w, rect.h, best_area_fit, best_short_side_fit);
-		} else if (this->options.logic == PackingLogic::MaxEdge) {
-			new_node = find_position_for_new_node_best_long_side_fit(rect.w, rect.h, best_short_side_fit, best_long_side_fit);
-		} else {
-			new_node = find_position_for_new_node_best_short_side_fit(rect.w, rect.h, best_short_side_fit, best_long_side_fit);
+		renumber_free_rects();
+		++free_version;
+		// Merging only looks at neighbours, found through the free-rect grid.
+		// Build it on the first remove; from then on it is kept in step with the
+		// free list exactly as in PruneMode::Grid.
+		if (!free_rect_grid.is_configured()) {
+			free_rect_grid.fit_to(this->max_width, this->max_height, free_rectangles.size());
+			index_new_free_rects(std::size_t{0});
 		}
+		free_rect_marks.assign(free_rectangles.size(), std::uint8_t{0});
+		const auto first_new = free_rectangles.size();
+		add_free_candidate(region.x, region.y, region.w, region.h);
 		
-		if (new_node.h == Numeric{}) {
-			if (this->options.allow_rotation) {
-				if (this->options.logic == PackingLogic::MaxArea) {
-					new_node = find_position_for_new_node_best_area_fit(rect.h, rect.w, best_area_fit, best_short_side_fit);
-				} else if (this->options.logic == PackingLogic::MaxEdge) {
-					new_node = find_position_for_new_node_best_long_side_fit(rect.h, rect.w, best_short_side_fit, best_long_side_fit);
-				} else {
-					new_node = find_position_for_new_node_best_short_side_fit(rect.h, rect.w, best_short_side_fit, best_long_side_fit);
+		// Two free rects that touch along one axis span a free rect over their
+		// shared band. Merging every new rect with its neighbours until nothing
+		// new appears keeps the list maximal without touching distant rects.
+		for (auto next = first_new; next < free_rectangles.size(); ++next) {
+			if (free_rect_marks[next]) {
+				continue;
+			}
+			const auto c = free_rectangles[next];
+			merge_neighbours.clear();
+			free_rect_grid.collect(c.x, c.y, c.w, c.h, merge_neighbours);
+			for (auto& neighbour : merge_neighbours) {
+				neighbour = static_cast<std::uint32_t>(free_rectangles.lower_bound_id(neighbour));
+			}
+			std::sort(merge_neighbours.begin(), merge_neighbours.end());
+			for (const auto j : merge_neighbours) {
+				if (j == next || free_rect_marks[j]) {
+					continue;
+				}
+				const auto f = free_rectangles[j];
+				const auto left = std::max(c.x, f.x);
+				const auto right = std::min(c.x + c.w, f.x + f.w);
+				const auto top = std::max(c.y, f.y);
+				const auto bottom = std::min(c.y + c.h, f.y + f.h);
+				if (left <= right && bottom > top) {
+					const auto x0 = std::min(c.x, f.x);
+					add_free_candidate(x0, top, std::max(c.x + c.w, f.x + f.w) - x0, bottom - top);
+				}
+				if (top <= bottom && right > left) {
+					const auto y0 = std::min(c.y, f.y);
+					add_free_candidate(left, y0, right - left, std::max(c.y + c.h, f.y + f.h) - y0);
 				}
-				
-				if (new_node.h != Numeric{}) {
-					new_node.rot = true;
+				if (free_rect_marks[next]) {
+					break;
 				}
 			}
 		}
 		
-		if (new_node.h == Numeric{}) {
-			return nullptr;
+		free_rectangles.compact(free_rect_marks);
+		refit_free_rect_grid();
+		stats_recorder.observe_free_rects(free_rectangles.size());
+		refresh_capacity();
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::add_free_candidate(Numeric x, Numeric y, Numeric w, Numeric h) -> void {
+		// Marked rects are already out of the grid, so only live rects count.
+		if (free_rect_grid.covers(x, y, w, h)) {
+			return;
 		}
-		
-		place_rectangle(new_node);
-		
-		rect.x = new_node.x;
-		rect.y = new_node.y;
-		rect.rot = new_node.rot;
-		if (new_node.rot) {
-			auto temp_w = rect.w;
-			rect.w = rect.h;
-			rect.h = temp_w;
+		candidate_neighbours.clear();
+		free_rect_grid.collect(x, y, w, h, candidate_neighbours);
+		for (const auto rect_id : candidate_neighbours) {
+			const auto i = free_rectangles.lower_bound_id(rect_id);
+			if (free_rectangles.x[i] >= x && free_rectangles.y[i] >= y &&
+				free_rectangles.x[i] + free_rectangles.w[i] <= x + w &&
+				free_rectangles.y[i] + free_rectangles.h[i] <= y + h) {
+				free_rect_marks[i] = std::uint8_t{1};
+				free_rect_grid.erase(rect_id, free_rectangles.x[i], free_rectangles.y[i],
+									free_rectangles.w[i], free_rectangles.h[i]);
+			}
 		}
-		
-		this->rects.push_back(std::move(rect));
-		this->set_dirty(true);
-		
-		if (this->options.smart) {
-			calculate_max_dimensions();
+		free_rectangles.emplace_back(w, h, x, y);
+		free_rect_marks.push_back(std::uint8_t{0});
+		index_new_free_rects(free_rectangles.size() - std::size_t{1});
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::find_free_rect(Numeric width, Numeric height, FreeRectScore score) const -> FreeRectFit<Numeric> {
+		if (this->options.logic == PackingLogic::ContactPoint) {
+			return find_position_for_new_node_contact_point(width, height);
 		}
-		return &this->rects.back();
-	}	template<typename RectType, typename Numeric>
+		return free_rectangles.find_best(width, height, score);
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::make_fit(const FreeRectFit<Numeric>& best, Numeric width, Numeric height,
+												bool rotated) const noexcept -> BinFit<Numeric> {
+		auto fit = BinFit<Numeric>{};
+		if (!best.found() || height == Numeric{}) {
+			return fit;
+		}
+		fit.x = free_rectangles.x[best.index];
+		fit.y = free_rectangles.y[best.index];
+		fit.w = width;
+		fit.h = height;
+		fit.primary = best.primary;
+		fit.secondary = best.secondary;
+		fit.rotated = rotated;
+		fit.found = true;
+		return fit;
+	}
+
+	template<typename RectType, typename Numeric>
 	auto MaxRectsBin<RectType, Numeric>::add(Numeric width, Numeric height, std::any data) -> RectType* {
 		if constexpr (std::is_same_v<RectType, Rectangle<Numeric>>) {
 			auto rect = RectType{width, height, std::move(data)};
@@ -160,6 +349,19 @@ namespace MaxRects {
 		
 		this->rects.reserve(this->rects.size() + rects.size());
 		
+		if (this->options.global_fit) {
+			results.resize(rects.size(), nullptr);
+			auto sizes = std::pmr::vector<Size<Numeric>>{this->memory_resource};
+			sizes.reserve(rects.size());
+			for (const auto& rect : rects) {
+				sizes.push_back(Size<Numeric>{rect.w, rect.h});
+			}
+			place_best_first(sizes, [&](std::size_t index, const BinFit<Numeric>& fit) {
+				results[index] = commit_fit(std::move(rects[index]), fit);
+			});
+			return results;
+		}
+		
 		for (auto& rect : rects) {
 			if (auto* added = add(std::move(rect))) {
 				results.push_back(added);
@@ -179,23 +381,14 @@ namespace MaxRects {
 		auto best_node = Rectangle<Numeric>{};
 		best_short_side = std::numeric_limits<Numeric>::max();
 		
-		for (const auto& free_rect : free_rectangles) {
-			if (free_rect.w >= width && free_rect.h >= height) {
-				const auto leftover_horizontal = std::abs(free_rect.w - width);
-				const auto leftover_vertical = std::abs(free_rect.h - height);
-				const auto short_side = std::min(leftover_horizontal, leftover_vertical);
-				const auto long_side = std::max(leftover_horizontal, leftover_vertical);
-				
-				if (short_side < best_short_side || 
-					(short_side == best_short_side && long_side < best_long_side)) {
-					best_node.x = free_rect.x;
-					best_node.y = free_rect.y;
-					best_node.w = width;
-					best_node.h = height;
-					best_short_side = short_side;
-					best_long_side = long_side;
-				}
-			}
+		const auto fit = free_rectangles.find_best(width, height, FreeRectScore::ShortSide);
+		if (fit.found()) {
+			best_node.x = free_rectangles.x[fit.index];
+			best_node.y = free_rectangles.y[fit.index];
+			best_node.w = width;
+			best_node.h = height;
+			best_short_side = fit.primary;
+			best_long_side = fit.secondary;
 		}
 		
 		return best_node;
@@ -209,23 +402,14 @@ namespace MaxRects {
 		auto best_node = Rectangle<Numeric>{};
 		best_long_side = std::numeric_limits<Numeric>::max();
 		
-		for (const auto& free_rect : free_rectangles) {
-			if (free_rect.w >= width && free_rect.h >= height) {
-				const auto leftover_horizontal = std::abs(free_rect.w - width);
-				const auto leftover_vertical = std::abs(free_rect.h - height);
-				const auto short_side = std::min(leftover_horizontal, leftover_vertical);
-				const auto long_side = std::max(leftover_horizontal, leftover_vertical);
-				
-				if (long_side < best_long_side || 
-					(long_side == best_long_side && short_side < best_short_side)) {
-					best_node.x = free_rect.x;
-					best_node.y = free_rect.y;
-					best_node.w = width;
-					best_node.h = height;
-					best_short_side = short_side;
-					best_long_side = long_side;
-				}
-			}
+		const auto fit = free_rectangles.find_best(width, height, FreeRectScore::LongSide);
+		if (fit.found()) {
+			best_node.x = free_rectangles.x[fit.index];
+			best_node.y = free_rectangles.y[fit.index];
+			best_node.w = width;
+			best_node.h = height;
+			best_long_side = fit.primary;
+			best_short_side = fit.secondary;
 		}
 		
 		return best_node;
@@ -239,23 +423,14 @@ namespace MaxRects {
 		auto best_node = Rectangle<Numeric>{};
 		best_area_fit = std::numeric_limits<Numeric>::max();
 		
-		for (const auto& free_rect : free_rectangles) {
-			if (free_rect.w >= width && free_rect.h >= height) {
-				const auto area_fit = free_rect.w * free_rect.h - width * height;
-				const auto leftover_horizontal = std::abs(free_rect.w - width);
-				const auto leftover_vertical = std::abs(free_rect.h - height);
-				const auto short_side = std::min(leftover_horizontal, leftover_vertical);
-				
-				if (area_fit < best_area_fit || 
-					(area_fit == best_area_fit && short_side < best_short_side)) {
-					best_node.x = free_rect.x;
-					best_node.y = free_rect.y;
-					best_node.w = width;
-					best_node.h = height;
-					best_area_fit = area_fit;
-					best_short_side = short_side;
-				}
-			}
+		const auto fit = free_rectangles.find_best(width, height, FreeRectScore::Area);
+		if (fit.found()) {
+			best_node.x = free_rectangles.x[fit.index];
+			best_node.y = free_rectangles.y[fit.index];
+			best_node.w = width;
+			best_node.h = height;
+			best_area_fit = fit.primary;
+			best_short_side = fit.secondary;
 		}
 		
 		return best_node;
@@ -263,94 +438,135 @@ namespace MaxRects {
 
 	template<typename RectType, typename Numeric>
 	auto MaxRectsBin<RectType, Numeric>::place_rectangle(const Rectangle<Numeric>& node) -> void {
-		auto num_rects_to_process = free_rectangles.size();
-		for (auto i = size_t{0}; i < num_rects_to_process; ++i) {
+		renumber_free_rects();
+		const auto num_rects_to_process = free_rectangles.size();
+		free_rect_marks.assign(num_rects_to_process, std::uint8_t{0});
+		auto split_count = std::size_t{0};
+		for (auto i = std::size_t{0}; i < num_rects_to_process; ++i) {
 			if (split_free_rect_by_node(free_rectangles[i], node)) {
-				free_rectangles.erase(free_rectangles.begin() + i);
-				--i;
-				--num_rects_to_process;
+				free_rect_marks[i] = std::uint8_t{1};
+				++split_count;
 			}
 		}
+		if (split_count == 0) {
+			return;
+		}
+		free_rect_marks.resize(free_rectangles.size(), std::uint8_t{0});
+		if (free_rect_grid.is_configured()) {
+			for (auto i = std::size_t{0}; i < num_rects_to_process; ++i) {
+				if (free_rect_marks[i]) {
+					free_rect_grid.erase(free_rectangles.id[i], free_rectangles.x[i], free_rectangles.y[i],
+										free_rectangles.w[i], free_rectangles.h[i]);
+				}
+			}
+		}
+		free_rectangles.compact(free_rect_marks);
 		
-		prune_free_list();
+		const auto first_new = num_rects_to_process - split_count;
+		index_new_free_rects(first_new);
+		prune_new_free_rects(first_new);
+		refit_free_rect_grid();
+		refresh_capacity();
 	}
 
 	template<typename RectType, typename Numeric>
 	auto MaxRectsBin<RectType, Numeric>::calculate_max_dimensions() -> void {
-		if (this->rects.empty()) {
+		extent_x = Numeric{};
+		extent_y = Numeric{};
+		
+		if (this->rects.empty() && this->reserved.empty()) {
 			this->width = this->options.smart ? Numeric{} : this->max_width;
 			this->height = this->options.smart ? Numeric{} : this->max_height;
 			return;
 		}
 		
-		auto max_x = Numeric{};
-		auto max_y = Numeric{};
-		
-		for (const auto& rect : this->rects) {
-			const auto right_edge = rect.x + rect.w;
-			const auto bottom_edge = rect.y + rect.h;
-			max_x = std::max(max_x, right_edge);
-			max_y = std::max(max_y, bottom_edge);
-		}
+		std::tie(extent_x, extent_y) = this->content_extents();
 		
-		if (this->options.pot) {
-			this->width = next_power_of_two(max_x);
-			this->height = next_power_of_two(max_y);
-		} else {
-			this->width = max_x;
-			this->height = max_y;
-		}
-		
-		if (this->options.square) {
-			const auto max_dimension = std::max(this->width, this->height);
-			this->width = max_dimension;
-			this->height = max_dimension;
-		}
+		this->apply_extents(extent_x, extent_y);
 	}
+
 	template<typename RectType, typename Numeric>
-	auto MaxRectsBin<RectType, Numeric>::repack() -> std::vector<RectType> {
-		auto unpacked = std::vector<RectType>{};
+	auto MaxRectsBin<RectType, Numeric>::repack() -> std::pmr::vector<RectType> {
+		auto unpacked = std::pmr::vector<RectType>{this->memory_resource};
 		unpacked.reserve(this->rects.size());
+		this->rect_slots.resize(this->rects.size(), no_rect_slot);
+		this->unpacked_slots.clear();
 		
 		reset(false);
-		auto indices = std::vector<std::size_t>(this->rects.size());
+		for (const auto& region : this->reserved) {
+			occupy(region);
+		}
+		auto indices = std::pmr::vector<std::size_t>(this->rects.size(), this->memory_resource);
 		for (auto i = std::size_t{0}; i < indices.size(); ++i) {
 			indices[i] = i;
 		}
 		std::sort(indices.begin(), indices.end(), [this](auto& a, auto& b) {
 			const auto max_a = std::max(this->rects[a].w, this->rects[a].h);
 			const auto max_b = std::max(this->rects[b].w, this->rects[b].h);
-			return max_b < max_a;
+			return max_b < max_a || (max_b == max_a && a < b);
 		});
-		auto removed_indices = std::vector<std::size_t>{};
+		auto placed = std::pmr::vector<std::uint8_t>(indices.size(), std::uint8_t{0}, this->memory_resource);
+		if (this->options.global_fit) {
+			auto sizes = std::pmr::vector<Size<Numeric>>{this->memory_resource};
+			sizes.reserve(indices.size());
+			for (auto idx : indices) {
+				sizes.push_back(Size<Numeric>{this->rects[idx].w, this->rects[idx].h});
+			}
+			place_best_first(sizes, [&](std::size_t i, const BinFit<Numeric>& fit) {
+				auto& rect = this->rects[indices[i]];
+				const auto node = Rectangle<Numeric>{fit.w, fit.h, fit.x, fit.y};
+				auto oriented = rect;
+				if (fit.rotated) {
+					oriented.rot = !rect.rot;
+					std::swap(oriented.w, oriented.h);
+				}
+				rect = finalize_placement(oriented, node);
+				placed[i] = std::uint8_t{1};
+			});
+		} else {
+			for (auto i = std::size_t{0}; i < indices.size(); ++i) {
+				if (auto placed_rect = place(this->rects[indices[i]])) {
+					this->rects[indices[i]] = std::move(*placed_rect);
+					placed[i] = std::uint8_t{1};
+				}
+			}
+		}
+		auto removed_indices = std::pmr::vector<std::size_t>{this->memory_resource};
 		removed_indices.reserve(this->rects.size());
-		for (auto idx : indices) {
-			if (!place(this->rects[idx]).has_value()) {
-				unpacked.push_back(this->rects[idx]);
-				removed_indices.push_back(idx);
+		for (auto i = std::size_t{0}; i < indices.size(); ++i) {
+			if (!placed[i]) {
+				unpacked.push_back(this->rects[indices[i]]);
+				this->unpacked_slots.push_back(this->rect_slots[indices[i]]);
+				removed_indices.push_back(indices[i]);
 			}
 		}
+		this->set_dirty(false);
 		
 		if (removed_indices.empty()) {
 			return unpacked;
 		}
 		std::sort(removed_indices.begin(), removed_indices.end(), std::greater<std::size_t>());
 		if (removed_indices.size() > this->rects.size() / 2) {
-			auto kept_rects = std::vector<RectType>{};
+			auto kept_rects = std::pmr::vector<RectType>{this->rects.get_allocator()};
+			auto kept_slots = std::pmr::vector<std::uint32_t>{this->rect_slots.get_allocator()};
 			kept_rects.reserve(this->rects.size() - removed_indices.size());
-			auto next_remove_idx = std::size_t{0};
+			kept_slots.reserve(kept_rects.capacity());
+			auto next_remove_idx = removed_indices.size();
 			for (auto i = std::size_t{0}; i < this->rects.size(); ++i) {
-				if (next_remove_idx < removed_indices.size() && i == removed_indices[next_remove_idx]) {
-					++next_remove_idx;
+				if (next_remove_idx > 0 && i == removed_indices[next_remove_idx - 1]) {
+					--next_remove_idx;
 				} else {
 					kept_rects.push_back(std::move(this->rects[i]));
+					kept_slots.push_back(this->rect_slots[i]);
 				}
 			}
 			
 			this->rects = std::move(kept_rects);
+			this->rect_slots = std::move(kept_slots);
 		} else {
 			for (auto idx : removed_indices) {
 				this->rects.erase(this->rects.begin() + idx);
+				this->rect_slots.erase(this->rect_slots.begin() + idx);
 			}
 		}
 		return unpacked;
@@ -360,10 +576,15 @@ namespace MaxRects {
 	auto MaxRectsBin<RectType, Numeric>::reset(bool deep_reset) -> void {
 		if (deep_reset) {
 			this->rects.clear();
+			this->rect_slots.clear();
+			this->reserved.clear();
 		}
 		this->width = this->options.smart ? Numeric{} : this->max_width;
 		this->height = this->options.smart ? Numeric{} : this->max_height;
+		extent_x = Numeric{};
+		extent_y = Numeric{};
 		this->free_rectangles.clear();
+		++free_version;
 		
 		this->free_rectangles.emplace_back(
 			this->max_width - border * Numeric{2},
@@ -371,6 +592,9 @@ namespace MaxRects {
 			border,
 			border
 		);
+		reset_contact_edges();
+		rebuild_free_rect_grid();
+		refresh_capacity();
 		
 		stage = Rectangle<Numeric>{this->width, this->height};
 		vertical_expand = false;
@@ -378,14 +602,24 @@ namespace MaxRects {
 	}
 
 	template<typename RectType, typename Numeric>
-	auto MaxRectsBin<RectType, Numeric>::clone() const -> std::unique_ptr<AbstractBin<RectType, Numeric>> {
-		auto cloned = std::make_unique<MaxRectsBin<RectType, Numeric>>(
-			this->max_width, this->max_height, Numeric{}, this->options);
+	auto MaxRectsBin<RectType, Numeric>::clone(std::pmr::memory_resource* resource) const -> std::unique_ptr<AbstractBin<RectType, Numeric>> {
+		auto cloned = std::unique_ptr<MaxRectsBin<RectType, Numeric>>(new (resource) MaxRectsBin<RectType, Numeric>(
+			this->max_width, this->max_height, Numeric{}, this->options, resource));
 		
 		cloned->width = this->width;
 		cloned->height = this->height;
+		cloned->extent_x = extent_x;
+		cloned->extent_y = extent_y;
 		cloned->free_rectangles = this->free_rectangles;
+		cloned->free_rect_grid = this->free_rect_grid;
+		cloned->free_capacity = free_capacity;
+		cloned->free_version = free_version;
+		cloned->vertical_edges = vertical_edges;
+		cloned->horizontal_edges = horizontal_edges;
+		cloned->stats_recorder = stats_recorder;
 		cloned->rects = this->rects;
+		cloned->rect_slots = this->rect_slots;
+		cloned->reserved = this->reserved;
 		cloned->tag = this->tag;
 		cloned->vertical_expand = vertical_expand;
 		cloned->stage = stage;
@@ -394,18 +628,89 @@ namespace MaxRects {
 		return std::move(cloned);
 	}
 
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::save(SnapshotWriter& writer, const SnapshotPayloadWriter<RectType>& payload) const -> bool {
+		auto info = SnapshotBin<Numeric>{SnapshotBinKind::MaxRects, vertical_expand ? snapshot_bin_vertical_expand : 0u};
+		info.extent_x = extent_x;
+		info.extent_y = extent_y;
+		info.border = border;
+		info.stage_w = stage.w;
+		info.stage_h = stage.h;
+		info.free_version = free_version;
+		info.next_free_id = free_rectangles.next_id;
+		this->save_common(writer, info, payload);
+		
+		writer.add(std::span<const Numeric>{free_rectangles.x});
+		writer.add(std::span<const Numeric>{free_rectangles.y});
+		writer.add(std::span<const Numeric>{free_rectangles.w});
+		writer.add(std::span<const Numeric>{free_rectangles.h});
+		writer.add(std::span<const std::uint32_t>{free_rectangles.id});
+		const auto vertical = std::pmr::vector<ContactEdge>{vertical_edges.begin(), vertical_edges.end(), this->memory_resource};
+		const auto horizontal = std::pmr::vector<ContactEdge>{horizontal_edges.begin(), horizontal_edges.end(), this->memory_resource};
+		writer.add(std::span<const ContactEdge>{vertical});
+		writer.add(std::span<const ContactEdge>{horizontal});
+		return true;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::restore(const SnapshotReader& reader, std::size_t first_section,
+												const SnapshotPayloadReader<RectType>& payload) -> bool {
+		const auto section = [&](SnapshotSection kind) { return snapshot_index(first_section, kind); };
+		const auto free_x = reader.section<Numeric>(section(SnapshotSection::FreeX));
+		const auto free_y = reader.section<Numeric>(section(SnapshotSection::FreeY));
+		const auto free_w = reader.section<Numeric>(section(SnapshotSection::FreeW));
+		const auto free_h = reader.section<Numeric>(section(SnapshotSection::FreeH));
+		const auto free_id = reader.section<std::uint32_t>(section(SnapshotSection::FreeId));
+		const auto vertical = reader.section<ContactEdge>(section(SnapshotSection::VerticalEdges));
+		const auto horizontal = reader.section<ContactEdge>(section(SnapshotSection::HorizontalEdges));
+		// A contact-point bin always holds the border's edges, so empty edge
+		// sections mean they were written in another layout.
+		const auto edges_missing = this->options.logic == PackingLogic::ContactPoint && (vertical.empty() || horizontal.empty());
+		if (!this->can_restore_common(reader, first_section, SnapshotBinKind::MaxRects) ||
+			free_y.size() != free_x.size() || free_w.size() != free_x.size() ||
+			free_h.size() != free_x.size() || free_id.size() != free_x.size() || edges_missing) {
+			return false;
+		}
+		
+		this->restore_common(reader, first_section, payload);
+		const auto& info = reader.section<SnapshotBin<Numeric>>(section(SnapshotSection::Bin))[0];
+		vertical_expand = (info.flags & snapshot_bin_vertical_expand) != 0;
+		extent_x = info.extent_x;
+		extent_y = info.extent_y;
+		border = info.border;
+		stage = Rectangle<Numeric>{info.stage_w, info.stage_h};
+		free_version = info.free_version;
+		
+		free_rectangles.x.assign(free_x.begin(), free_x.end());
+		free_rectangles.y.assign(free_y.begin(), free_y.end());
+		free_rectangles.w.assign(free_w.begin(), free_w.end());
+		free_rectangles.h.assign(free_h.begin(), free_h.end());
+		free_rectangles.id.assign(free_id.begin(), free_id.end());
+		free_rectangles.next_id = info.next_free_id;
+		vertical_edges.clear();
+		vertical_edges.insert(vertical.begin(), vertical.end());
+		horizontal_edges.clear();
+		horizontal_edges.insert(horizontal.begin(), horizontal.end());
+		
+		rebuild_free_rect_grid();
+		refresh_capacity();
+		return true;
+	}
+
 	template<typename RectType, typename Numeric>
 	auto MaxRectsBin<RectType, Numeric>::place(const RectType& rect) -> std::optional<RectType> {
 		auto best_node = find_best_position(rect.w, rect.h);
 		
 		if (best_node.w == Numeric{}) {
 			if (this->options.allow_rotation) {
+				stats_recorder.count_rotation_retry();
 				best_node = find_best_position(rect.h, rect.w);
 				if (best_node.w != Numeric{}) {
+					// Like commit_fit, this swaps the edges directly: set_rotation
+					// ignores rects that did not opt into rotation themselves.
 					auto rotated_rect = rect;
-					if constexpr (std::is_same_v<RectType, Rectangle<Numeric>>) {
-						rotated_rect.set_rotation(!rect.rot);
-					}
+					rotated_rect.rot = !rect.rot;
+					std::swap(rotated_rect.w, rotated_rect.h);
 					best_node.w = rect.h;
 					best_node.h = rect.w;
 					return finalize_placement(rotated_rect, best_node);
@@ -420,26 +725,15 @@ namespace MaxRects {
 	template<typename RectType, typename Numeric>
 	auto MaxRectsBin<RectType, Numeric>::find_best_position(Numeric width, Numeric height) -> Rectangle<Numeric> {
 		auto best_node = Rectangle<Numeric>{};
-		auto best_short_side = std::numeric_limits<Numeric>::max();
-		auto best_long_side = std::numeric_limits<Numeric>::max();
-		
-		for (auto& free_rect : this->free_rectangles) {
-			if (free_rect.w >= width && free_rect.h >= height) {
-				const auto leftover_horizontal = free_rect.w - width;
-				const auto leftover_vertical = free_rect.h - height;
-				const auto short_side = std::min(leftover_horizontal, leftover_vertical);
-				const auto long_side = std::max(leftover_horizontal, leftover_vertical);
-				
-				if (short_side < best_short_side || 
-					(short_side == best_short_side && long_side < best_long_side)) {
-					best_node.x = free_rect.x;
-					best_node.y = free_rect.y;
-					best_node.w = width;
-					best_node.h = height;
-					best_short_side = short_side;
-					best_long_side = long_side;
-				}
-			}
+		
+		stats_recorder.count_scan(this->free_rectangles.size());
+		const auto score = this->options.logic == PackingLogic::BottomLeft ? FreeRectScore::BottomLeft : FreeRectScore::ShortSide;
+		const auto fit = find_free_rect(width, height, score);
+		if (fit.found()) {
+			best_node.x = this->free_rectangles.x[fit.index];
+			best_node.y = this->free_rectangles.y[fit.index];
+			best_node.w = width;
+			best_node.h = height;
 		}
 		
 		return best_node;
@@ -447,8 +741,11 @@ namespace MaxRects {
 
 	template<typename RectType, typename Numeric>
 	auto MaxRectsBin<RectType, Numeric>::finalize_placement(const RectType& rect, const Rectangle<Numeric>& position) -> RectType {
-		split_free_node(position);
-		prune_free_list();
+		stats_recorder.count_insert();
+		prune_new_free_rects(split_free_node(position));
+		refit_free_rect_grid();
+		refresh_capacity();
+		add_contact_edges(position);
 		update_bin_size(position);
 		
 		auto placed_rect = rect;
@@ -465,12 +762,38 @@ namespace MaxRects {
 	}
 
 	template<typename RectType, typename Numeric>
-	auto MaxRectsBin<RectType, Numeric>::split_free_node(const Rectangle<Numeric>& used_node) -> void {
-		for (auto i = this->free_rectangles.size(); i-- > std::size_t{};) {
+	auto MaxRectsBin<RectType, Numeric>::free_rect_version() const noexcept -> std::uint32_t {
+		return free_version;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::split_free_node(const Rectangle<Numeric>& used_node) -> std::size_t {
+		const auto num_rects_to_process = this->free_rectangles.size();
+		free_rect_marks.assign(num_rects_to_process, std::uint8_t{0});
+		auto split_count = std::size_t{0};
+		for (auto i = num_rects_to_process; i-- > std::size_t{};) {
 			if (split_free_rect_by_node(this->free_rectangles[i], used_node)) {
-				this->free_rectangles.erase(this->free_rectangles.begin() + i);
+				free_rect_marks[i] = std::uint8_t{1};
+				++split_count;
+			}
+		}
+		if (split_count == 0) {
+			return num_rects_to_process;
+		}
+		free_rect_marks.resize(this->free_rectangles.size(), std::uint8_t{0});
+		if (free_rect_grid.is_configured()) {
+			for (auto i = std::size_t{0}; i < num_rects_to_process; ++i) {
+				if (free_rect_marks[i]) {
+					free_rect_grid.erase(this->free_rectangles.id[i], this->free_rectangles.x[i], this->free_rectangles.y[i],
+										this->free_rectangles.w[i], this->free_rectangles.h[i]);
+				}
 			}
 		}
+		this->free_rectangles.compact(free_rect_marks);
+		
+		const auto first_new = num_rects_to_process - split_count;
+		index_new_free_rects(first_new);
+		return first_new;
 	}
 	template<typename RectType, typename Numeric>
 	auto MaxRectsBin<RectType, Numeric>::split_free_rect_by_node(const Rectangle<Numeric>& free_rect, const Rectangle<Numeric>& used_node) -> bool {
@@ -481,42 +804,30 @@ namespace MaxRects {
 			return false;
 		}
 		
-		auto new_rects = std::vector<Rectangle<Numeric>>{};
-		new_rects.reserve(4);
-		
+		const auto pieces_before = this->free_rectangles.size();
 		if (used_node.x < free_rect.x + free_rect.w && used_node.x + used_node.w > free_rect.x) {
 			if (used_node.y > free_rect.y && used_node.y < free_rect.y + free_rect.h) {
-				auto new_node = free_rect;
-				new_node.h = used_node.y - new_node.y;
-				new_rects.emplace_back(new_node);
+				this->free_rectangles.emplace_back(free_rect.w, used_node.y - free_rect.y, free_rect.x, free_rect.y);
 			}
 			
 			if (used_node.y + used_node.h < free_rect.y + free_rect.h) {
-				auto new_node = free_rect;
-				new_node.y = used_node.y + used_node.h;
-				new_node.h = free_rect.y + free_rect.h - (used_node.y + used_node.h);
-				new_rects.emplace_back(new_node);
+				this->free_rectangles.emplace_back(free_rect.w, free_rect.y + free_rect.h - (used_node.y + used_node.h),
+												free_rect.x, used_node.y + used_node.h);
 			}
 		}
 		
 		if (used_node.y < free_rect.y + free_rect.h && used_node.y + used_node.h > free_rect.y) {
 			if (used_node.x > free_rect.x && used_node.x < free_rect.x + free_rect.w) {
-				auto new_node = free_rect;
-				new_node.w = used_node.x - new_node.x;
-				new_rects.emplace_back(new_node);
+				this->free_rectangles.emplace_back(used_node.x - free_rect.x, free_rect.h, free_rect.x, free_rect.y);
 			}
 			
 			if (used_node.x + used_node.w < free_rect.x + free_rect.w) {
-				auto new_node = free_rect;
-				new_node.x = used_node.x + used_node.w;
-				new_node.w = free_rect.x + free_rect.w - (used_node.x + used_node.w);
-				new_rects.emplace_back(new_node);
+				this->free_rectangles.emplace_back(free_rect.x + free_rect.w - (used_node.x + used_node.w), free_rect.h,
+												used_node.x + used_node.w, free_rect.y);
 			}
 		}
-		
-		this->free_rectangles.insert(this->free_rectangles.end(),
-									std::make_move_iterator(new_rects.begin()),
-									std::make_move_iterator(new_rects.end()));
+		stats_recorder.count_splits(this->free_rectangles.size() - pieces_before);
+		stats_recorder.observe_free_rects(this->free_rectangles.size());
 		
 		return true;
 	}
@@ -526,7 +837,8 @@ namespace MaxRects {
 		if (this->free_rectangles.size() <= 1) {
 			return;
 		}
-		auto to_delete = std::vector<bool>(this->free_rectangles.size(), false);
+		auto& to_delete = free_rect_marks;
+		to_delete.assign(this->free_rectangles.size(), std::uint8_t{0});
 		auto delete_count = std::size_t{0};
 		
 		for (auto i = std::size_t{0}; i < this->free_rectangles.size(); ++i) {
@@ -537,69 +849,157 @@ namespace MaxRects {
 				if (to_delete[j]) {
 					continue;
 				}
-				if (this->free_rectangles[j].contains(this->free_rectangles[i])) {
-					to_delete[i] = true;
+				stats_recorder.count_prune_pairs(1);
+				if (this->free_rectangles.contains(j, i)) {
+					to_delete[i] = std::uint8_t{1};
 					++delete_count;
 					break;   
-				} else if (this->free_rectangles[i].contains(this->free_rectangles[j])) {
-					to_delete[j] = true;
+				} else if (this->free_rectangles.contains(i, j)) {
+					to_delete[j] = std::uint8_t{1};
 					++delete_count;
 				}
 			}
 		}
 		if (delete_count > 0) {
-			if (delete_count > this->free_rectangles.size() / 2) {
-				auto new_free_rects = std::vector<Rectangle<Numeric>>{};
-				new_free_rects.reserve(this->free_rectangles.size() - delete_count);
+			if (free_rect_grid.is_configured()) {
 				for (auto i = std::size_t{0}; i < this->free_rectangles.size(); ++i) {
-					if (!to_delete[i]) {
-						new_free_rects.push_back(std::move(this->free_rectangles[i]));
-					}
-				}
-				this->free_rectangles = std::move(new_free_rects);
-			} else {
-				for (auto i = this->free_rectangles.size(); i-- > 0;) {
 					if (to_delete[i]) {
-						this->free_rectangles.erase(this->free_rectangles.begin() + i);
+						free_rect_grid.erase(this->free_rectangles.id[i], this->free_rectangles.x[i], this->free_rectangles.y[i],
+											this->free_rectangles.w[i], this->free_rectangles.h[i]);
 					}
 				}
 			}
+			this->free_rectangles.compact(to_delete);
 		}
 	}
 
 	template<typename RectType, typename Numeric>
-	auto MaxRectsBin<RectType, Numeric>::update_bin_size(const Rectangle<Numeric>& placed_rect) -> void {
-		if (this->options.smart) {
-			const auto right_edge = placed_rect.x + placed_rect.w;
-			const auto bottom_edge = placed_rect.y + placed_rect.h;
-			
-			if (this->options.pot) {
-				this->width = next_power_of_two(std::max(this->width, right_edge));
-				this->height = next_power_of_two(std::max(this->height, bottom_edge));
+	auto MaxRectsBin<RectType, Numeric>::prune_new_free_rects(std::size_t first_new) -> void {
+		if (this->options.prune_mode == PruneMode::Sweep) {
+			prune_free_list();
+			return;
+		}
+		
+		const auto count = this->free_rectangles.size();
+		if (first_new >= count) {
+			return;
+		}
+		
+		// Pieces cut from a free rect lie inside it, so they can never contain an
+		// older survivor of a pruned list; only the new pieces need checking.
+		const auto use_grid = free_rect_grid.is_configured();
+		auto& to_delete = free_rect_marks;
+		to_delete.assign(count, std::uint8_t{0});
+		auto delete_count = std::size_t{0};
+		
+		for (auto i = first_new; i < count; ++i) {
+			auto contained = false;
+			if (use_grid) {
+				stats_recorder.count_prune_pairs(1);
+				contained = free_rect_grid.is_contained(this->free_rectangles.id[i],
+					this->free_rectangles.x[i], this->free_rectangles.y[i],
+					this->free_rectangles.w[i], this->free_rectangles.h[i]);
 			} else {
-				this->width = std::max(this->width, right_edge);
-				this->height = std::max(this->height, bottom_edge);
+				for (auto j = std::size_t{0}; j < count; ++j) {
+					if (j == i || to_delete[j]) {
+						continue;
+					}
+					stats_recorder.count_prune_pairs(1);
+					if (this->free_rectangles.contains(j, i) &&
+						(j > i || !this->free_rectangles.contains(i, j))) {
+						contained = true;
+						break;
+					}
+				}
 			}
 			
-			if (this->options.square) {
-				const auto max_dimension = std::max(this->width, this->height);
-				this->width = max_dimension;
-				this->height = max_dimension;
+			if (contained) {
+				to_delete[i] = std::uint8_t{1};
+				++delete_count;
+				if (use_grid) {
+					free_rect_grid.erase(this->free_rectangles.id[i], this->free_rectangles.x[i], this->free_rectangles.y[i],
+										this->free_rectangles.w[i], this->free_rectangles.h[i]);
+				}
 			}
 		}
+		
+		if (delete_count > 0) {
+			this->free_rectangles.compact(to_delete);
+		}
 	}
 
 	template<typename RectType, typename Numeric>
-	auto MaxRectsBin<RectType, Numeric>::next_power_of_two(Numeric value) -> Numeric {
-		if (value <= Numeric{}) return Numeric{1};
-		if constexpr (std::is_floating_point_v<Numeric>) {
-			return static_cast<Numeric>(std::pow(Numeric{2}, std::ceil(std::log2(value))));
-		} else {
-			Numeric power = Numeric{1};
-			while (power < value) {
-				power *= Numeric{2};
-			}
-			return power;
+	auto MaxRectsBin<RectType, Numeric>::free_rect_count() const noexcept -> std::size_t {
+		return free_rectangles.size();
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::capacity() const noexcept -> BinCapacity<Numeric> {
+		return free_capacity;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::stats() const noexcept -> PackingStats {
+		return stats_recorder.snapshot();
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::refresh_capacity() noexcept -> void {
+		free_capacity = BinCapacity<Numeric>{};
+		for (auto i = std::size_t{0}; i < free_rectangles.size(); ++i) {
+			const auto w = free_rectangles.w[i];
+			const auto h = free_rectangles.h[i];
+			free_capacity.max_w = std::max(free_capacity.max_w, w);
+			free_capacity.max_h = std::max(free_capacity.max_h, h);
+			free_capacity.max_area = std::max(free_capacity.max_area, w * h);
+		}
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::rebuild_free_rect_grid() -> void {
+		if (this->options.prune_mode != PruneMode::Grid && !free_rect_grid.is_configured()) {
+			return;
+		}
+		free_rect_grid.fit_to(this->max_width, this->max_height, free_rectangles.size());
+		index_new_free_rects(std::size_t{0});
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::refit_free_rect_grid() -> void {
+		if (free_rect_grid.is_configured() && free_rect_grid.needs_refit(free_rectangles.size())) {
+			rebuild_free_rect_grid();
+		}
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::renumber_free_rects() -> void {
+		if (free_rectangles.next_id < free_rect_id_limit) {
+			return;
+		}
+		free_rectangles.renumber();
+		++free_version;
+		if (free_rect_grid.is_configured()) {
+			rebuild_free_rect_grid();
+		}
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::index_new_free_rects(std::size_t first_new) -> void {
+		if (!free_rect_grid.is_configured()) {
+			return;
+		}
+		for (auto i = first_new; i < free_rectangles.size(); ++i) {
+			free_rect_grid.insert(free_rectangles.id[i], free_rectangles.x[i], free_rectangles.y[i],
+								free_rectangles.w[i], free_rectangles.h[i]);
+		}
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::update_bin_size(const Rectangle<Numeric>& placed_rect) -> void {
+		if (this->options.smart) {
+			extent_x = std::max(extent_x, placed_rect.x + placed_rect.w);
+			extent_y = std::max(extent_y, placed_rect.y + placed_rect.h);
+			this->apply_extents(extent_x, extent_y);
 		}
 	}
 
@@ -608,21 +1008,104 @@ namespace MaxRects {
 		Numeric width, Numeric height, 
 		Numeric& best_y, Numeric& best_x) const -> bool {
 		
-		best_x = std::numeric_limits<Numeric>::max();
-		best_y = std::numeric_limits<Numeric>::max();
-		
-		for (const auto& free_rect : free_rectangles) {
-			if (free_rect.w >= width && free_rect.h >= height) {
-				
-				if (free_rect.y + height < best_y || 
-					(free_rect.y + height == best_y && free_rect.x < best_x)) {
-					best_x = free_rect.x;
-					best_y = free_rect.y + height;
+		const auto fit = free_rectangles.find_best(width, height, FreeRectScore::BottomLeft);
+		best_y = fit.primary;
+		best_x = fit.secondary;
+		return fit.found();
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::find_position_for_new_node_contact_point(Numeric width, Numeric height) const -> FreeRectFit<Numeric> {
+		auto best = FreeRectFit<Numeric>{};
+		for (auto i = std::size_t{0}; i < free_rectangles.size(); ++i) {
+			if (free_rectangles.w[i] >= width && free_rectangles.h[i] >= height) {
+				const auto primary = -contact_score(free_rectangles.x[i], free_rectangles.y[i], width, height);
+				const auto secondary = free_rectangles.y[i] + height;
+				if (primary < best.primary ||
+					(primary == best.primary && secondary < best.secondary)) {
+					best.index = i;
+					best.primary = primary;
+					best.secondary = secondary;
 				}
 			}
 		}
-		
-		return best_y != std::numeric_limits<Numeric>::max();
+		return best;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::contact_score(Numeric x, Numeric y, Numeric width, Numeric height) const noexcept -> Numeric {
+		// A candidate's left and top sides touch solids lying before those
+		// lines, its right and bottom sides solids lying after them. Those
+		// solids are disjoint, so only the one edge before the lower bound can
+		// start ahead of the span and still reach into it.
+		const auto overlap = [](const ContactEdgeSet& edges, const ContactEdge& query) {
+			const auto on_line = [&query](const ContactEdge& edge) { return edge.at == query.at && edge.side == query.side; };
+			auto it = edges.lower_bound(query);
+			if (it != edges.begin()) {
+				const auto previous = std::prev(it);
+				if (on_line(*previous) && previous->to > query.from) {
+					it = previous;
+				}
+			}
+			auto total = Numeric{};
+			for (; it != edges.end() && on_line(*it) && it->from < query.to; ++it) {
+				const auto low = std::max(query.from, it->from);
+				const auto high = std::min(query.to, it->to);
+				if (high > low) {
+					total += high - low;
+				}
+			}
+			return total;
+		};
+		return overlap(vertical_edges, ContactEdge{x, y, y + height, ContactSide::Before}) +
+			overlap(vertical_edges, ContactEdge{x + width, y, y + height, ContactSide::After}) +
+			overlap(horizontal_edges, ContactEdge{y, x, x + width, ContactSide::Before}) +
+			overlap(horizontal_edges, ContactEdge{y + height, x, x + width, ContactSide::After});
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::add_contact_edges(const Rectangle<Numeric>& node) -> void {
+		update_contact_edges(node, false, true);
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::remove_contact_edges(const Rectangle<Numeric>& node) -> void {
+		update_contact_edges(node, false, false);
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::update_contact_edges(const Rectangle<Numeric>& node, bool border, bool insert) -> void {
+		if (this->options.logic != PackingLogic::ContactPoint) {
+			return;
+		}
+		// A placed rect lies after its left and top edges and before its right
+		// and bottom ones.
+		const auto near = border ? ContactSide::Before : ContactSide::After;
+		const auto far = border ? ContactSide::After : ContactSide::Before;
+		const auto update = [insert](ContactEdgeSet& edges, const ContactEdge& edge) {
+			if (insert) {
+				edges.insert(edge);
+				return;
+			}
+			for (auto [it, last] = edges.equal_range(edge); it != last; ++it) {
+				if (it->to == edge.to) {
+					edges.erase(it);
+					return;
+				}
+			}
+		};
+		update(vertical_edges, ContactEdge{node.x, node.y, node.y + node.h, near});
+		update(vertical_edges, ContactEdge{node.x + node.w, node.y, node.y + node.h, far});
+		update(horizontal_edges, ContactEdge{node.y, node.x, node.x + node.w, near});
+		update(horizontal_edges, ContactEdge{node.y + node.h, node.x, node.x + node.w, far});
+	}
+
+	template<typename RectType, typename Numeric>
+	auto MaxRectsBin<RectType, Numeric>::reset_contact_edges() -> void {
+		vertical_edges.clear();
+		horizontal_edges.clear();
+		// The empty bin's free rect is exactly the border the first rects rest on.
+		update_contact_edges(free_rectangles[0], true, true);
 	}
 
 
@@ -632,4 +1115,8 @@ namespace MaxRects {
 
 	template class MaxRectsBin<Rectangle<int>, int>;
 
+	template class MaxRectsBin<CompactRect<std::int16_t>, int>;
+
+	template class MaxRectsBin<CompactRect<std::int32_t>, int>;
+
 }
@@ -1,10 +1,13 @@
 #pragma once
 
 #include "abstract_bin.h"
+#include "free_rect_list.h"
+#include "free_rect_grid.h"
 #include <algorithm>
 #include <cmath>
 #include <optional>
 #include <limits>
+#include <set>
 #include <span>
 
 namespace MaxRects {
@@ -15,6 +18,21 @@ namespace MaxRects {
 	template<typename Numeric = float>
 	constexpr Numeric edge_min_value = Numeric{128};
 
+	constexpr std::size_t parallel_fit_chunk = 256;
+
+	constexpr auto free_rect_score(PackingLogic logic) noexcept -> FreeRectScore {
+		switch (logic) {
+			case PackingLogic::MaxArea:
+				return FreeRectScore::Area;
+			case PackingLogic::MaxEdge:
+				return FreeRectScore::LongSide;
+			case PackingLogic::BottomLeft:
+				return FreeRectScore::BottomLeft;
+			default:
+				return FreeRectScore::ShortSide;
+		}
+	}
+
 	template<typename RectType = Rectangle<float>, typename Numeric = float>
 	class MaxRectsBin : public AbstractBin<RectType, Numeric> {
 	public:
@@ -23,22 +41,61 @@ namespace MaxRects {
 		Numeric border{Numeric{}};
 
 		explicit MaxRectsBin(Numeric max_w = edge_max_value<Numeric>, Numeric max_h = edge_max_value<Numeric>,
-							Numeric padding = Numeric{}, const PackingOptions<Numeric>& opts = {});    auto add(const RectType& rect) -> RectType* override;
+							Numeric padding = Numeric{}, const PackingOptions<Numeric>& opts = {},
+							std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+		auto add(const RectType& rect) -> RectType* override;
 		
 		auto add(RectType&& rect) -> RectType* override;
 
+		using AbstractBin<RectType, Numeric>::find_fit;
+
+		[[nodiscard]] auto find_fit(Numeric w, Numeric h) const -> BinFit<Numeric> override;
+
+		auto find_fits(std::span<const Size<Numeric>> sizes, std::span<CachedFit<Numeric>> fits,
+						ThreadPool* pool = nullptr) const -> void override;
+
+		auto commit_fit(RectType rect, const BinFit<Numeric>& fit) -> RectType* override;
+
+		auto reserve_fit(const BinFit<Numeric>& fit) -> bool override;
+
+		using AbstractBin<RectType, Numeric>::remove;
+
+		auto remove(std::size_t index) -> bool override;
+
+		// Returns a region to the free list, merging it with the free rects it
+		// touches so the list stays maximal.
+		auto free_region(const Rectangle<Numeric>& region) -> void;
+
 		auto add(Numeric width, Numeric height, std::any data) -> RectType*;
 		
 		auto add_bulk(std::span<RectType> rects) -> std::vector<RectType*>;
 
-		auto repack() -> std::vector<RectType> override;
+		auto repack() -> std::pmr::vector<RectType> override;
 
 		auto reset(bool deep_reset = false) -> void;
 
-		auto clone() const -> std::unique_ptr<AbstractBin<RectType, Numeric>> override;
+		using AbstractBin<RectType, Numeric>::clone;
+
+		auto clone(std::pmr::memory_resource* resource) const -> std::unique_ptr<AbstractBin<RectType, Numeric>> override;
+
+		// The free list and contact edges are stored as they are, so a
+		// restore copies them back instead of replaying the placements.
+		auto save(SnapshotWriter& writer, const SnapshotPayloadWriter<RectType>& payload = {}) const -> bool override;
+
+		auto restore(const SnapshotReader& reader, std::size_t first_section,
+					const SnapshotPayloadReader<RectType>& payload = {}) -> bool override;
 
 		auto find_position_for_new_node_bottom_left(Numeric width, Numeric height, 
-												Numeric& best_y, Numeric& best_x) const -> bool;    auto find_position_for_new_node_best_short_side_fit(Numeric width, Numeric height,
+												Numeric& best_y, Numeric& best_x) const -> bool;
+
+		// Picks the fitting free rect whose corner shares the most edge length
+		// with placed rects and the bin border. Ties fall back to bottom-left.
+		[[nodiscard]] auto find_position_for_new_node_contact_point(Numeric width, Numeric height) const -> FreeRectFit<Numeric>;
+
+		[[nodiscard]] auto contact_score(Numeric x, Numeric y, Numeric width, Numeric height) const noexcept -> Numeric;
+
+		auto find_position_for_new_node_best_short_side_fit(Numeric width, Numeric height,
 														Numeric& best_short_side_fit, Numeric& best_long_side_fit) -> Rectangle<Numeric>;
 
 		auto find_position_for_new_node_best_long_side_fit(Numeric width, Numeric height,
@@ -49,11 +106,22 @@ namespace MaxRects {
 
 		auto place_rectangle(const Rectangle<Numeric>& node) -> void;
 
-		auto split_free_node(const Rectangle<Numeric>& used_node) -> void;
+		// Takes node out of the free space and grows the extents over it.
+		auto occupy(const Rectangle<Numeric>& node) -> void;
+
+		auto split_free_node(const Rectangle<Numeric>& used_node) -> std::size_t;
 		
 		auto split_free_rect_by_node(const Rectangle<Numeric>& free_rect, const Rectangle<Numeric>& used_node) -> bool;
 
 		auto prune_free_list() -> void;
+
+		auto prune_new_free_rects(std::size_t first_new) -> void;
+
+		[[nodiscard]] auto free_rect_count() const noexcept -> std::size_t;
+
+		[[nodiscard]] auto capacity() const noexcept -> BinCapacity<Numeric> override;
+
+		[[nodiscard]] auto stats() const noexcept -> PackingStats override;
 		
 		auto place(const RectType& rect) -> std::optional<RectType>;
 
@@ -61,15 +129,100 @@ namespace MaxRects {
 
 		auto finalize_placement(const RectType& rect, const Rectangle<Numeric>& position) -> RectType;
 
+		[[nodiscard]] auto free_rect_version() const noexcept -> std::uint32_t;
+
 		auto update_bin_size(const Rectangle<Numeric>& placed_rect) -> void;
-		
-		auto next_power_of_two(Numeric value) -> Numeric;
 
 	protected:
-		std::vector<Rectangle<Numeric>> free_rectangles{};
-		std::vector<Rectangle<Numeric>> used_rectangles{};
+		FreeRectList<Numeric> free_rectangles{};
+		std::pmr::vector<Rectangle<Numeric>> used_rectangles{};
+		std::pmr::vector<std::uint8_t> free_rect_marks{};
+		FreeRectGrid<Numeric> free_rect_grid{};
+		// Scratch id lists for the grid queries made while freeing a region.
+		std::pmr::vector<std::uint32_t> merge_neighbours{};
+		std::pmr::vector<std::uint32_t> candidate_neighbours{};
+		Numeric extent_x{Numeric{}};
+		Numeric extent_y{Numeric{}};
+		BinCapacity<Numeric> free_capacity{};
+		// Bumped whenever free space can grow, which voids every CachedFit.
+		std::uint32_t free_version{1};
+		[[no_unique_address]] mutable StatsRecorder<> stats_recorder{};
+
+		// Edges of placed rects and of the bin border, keyed by the line they lie
+		// on, the side of it their solid lies on, then where they start. Solids
+		// on one side of a line never overlap, so the edges under a candidate's
+		// side are one contiguous, disjoint run found by a binary search. Only
+		// kept up to date for PackingLogic::ContactPoint.
+		enum struct ContactSide : std::uint32_t {
+			Before = 0,
+			After = 1
+		};
+
+		struct ContactEdge {
+			Numeric at{Numeric{}};
+			Numeric from{Numeric{}};
+			Numeric to{Numeric{}};
+			ContactSide side{ContactSide::Before};
+		};
+
+		struct ContactEdgeOrder {
+			[[nodiscard]] auto operator()(const ContactEdge& a, const ContactEdge& b) const noexcept -> bool {
+				if (a.at != b.at) return a.at < b.at;
+				if (a.side != b.side) return a.side < b.side;
+				return a.from < b.from;
+			}
+		};
+
+		using ContactEdgeSet = std::pmr::multiset<ContactEdge, ContactEdgeOrder>;
+
+		ContactEdgeSet vertical_edges{};
+		ContactEdgeSet horizontal_edges{};
 
 		auto calculate_max_dimensions() -> void override;
+
+		[[nodiscard]] auto make_fit(const FreeRectFit<Numeric>& best, Numeric width, Numeric height,
+									bool rotated) const noexcept -> BinFit<Numeric>;
+
+		auto rebuild_free_rect_grid() -> void;
+
+		// Re-lays the grid out once the free list has outgrown or shrunk well
+		// below the size it was fitted to. Only called with the grid in step.
+		auto refit_free_rect_grid() -> void;
+
+		auto index_new_free_rects(std::size_t first_new) -> void;
+
+		// Renumbers the free list once its ids near free_rect_id_limit. Cached
+		// fits are voided through free_version and the grid is reindexed.
+		auto renumber_free_rects() -> void;
+
+		auto refresh_capacity() noexcept -> void;
+
+		auto add_free_candidate(Numeric x, Numeric y, Numeric w, Numeric h) -> void;
+
+		[[nodiscard]] auto find_free_rect(Numeric width, Numeric height, FreeRectScore score) const -> FreeRectFit<Numeric>;
+
+		// find_fit without touching the stats recorder, so it is safe to call
+		// from several threads at once.
+		[[nodiscard]] auto score_fit(Numeric w, Numeric h) const -> BinFit<Numeric>;
+
+		// Brings a cached fit up to date and returns how many free rects that
+		// took scanning.
+		auto refresh_fit(const Size<Numeric>& size, CachedFit<Numeric>& entry) const -> std::size_t;
+
+		// Places whichever of sizes scores best, over and over until none
+		// fits, handing each winner's index and fit to commit.
+		template<typename Commit>
+		auto place_best_first(std::span<const Size<Numeric>> sizes, Commit&& commit) -> void;
+
+		auto add_contact_edges(const Rectangle<Numeric>& node) -> void;
+
+		// Inserts or erases node's four edges. The bin border is a hole in the
+		// solid, so its edges face the other way.
+		auto update_contact_edges(const Rectangle<Numeric>& node, bool border, bool insert) -> void;
+
+		auto remove_contact_edges(const Rectangle<Numeric>& node) -> void;
+
+		auto reset_contact_edges() -> void;
 	};
 
 }
@@ -1,13 +1,20 @@
 #include "maxrects_packer.h"
 #include <algorithm>   
+#include <cmath>
 #include <iterator>    
+#include <numeric>
+#include <unordered_map>
+#include <utility>
 
 namespace MaxRects {
 
 	template<typename Numeric, typename RectType>
 	MaxRectsPacker<Numeric, RectType>::MaxRectsPacker(Numeric w, Numeric h,
-														Numeric pad, const PackingOptions<Numeric>& opts)
-		: width{w}, height{h}, padding{pad}, options{opts}, current_bin_index{std::size_t{0}} {
+														Numeric pad, const PackingOptions<Numeric>& opts,
+														std::pmr::memory_resource* resource)
+		: bins{resource}, width{w}, height{h}, padding{pad}, options{opts}, current_bin_index{std::size_t{0}},
+		memory_resource{resource}, bin_fits{resource}, fit_candidates{resource}, capacity_index{resource}, capacity_revisions{resource}, tag_index{resource}, slot_map{resource},
+		stream_states{resource} {
 	}
 	template<typename Numeric, typename RectType>
 	auto MaxRectsPacker<Numeric, RectType>::add(Numeric rect_width, Numeric rect_height, std::any data) -> RectType* {
@@ -21,64 +28,232 @@ namespace MaxRects {
 	}
 	template<typename Numeric, typename RectType>
 	auto MaxRectsPacker<Numeric, RectType>::add(const RectType& rect) -> RectType* {
+		return add(RectType{rect});
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::add(RectType&& rect) -> RectType* {
+		refresh_capacity_index();
+		return add_slotted(std::move(rect), slot_map.allocate());
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::insert(const RectType& rect) -> RectHandle {
+		return insert(RectType{rect});
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::insert(RectType&& rect) -> RectHandle {
+		refresh_capacity_index();
+		const auto slot = slot_map.allocate();
+		add_slotted(std::move(rect), slot);
+		return slot_map.handle(slot);
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::remove(const RectHandle& handle) -> bool {
+		const auto* rect = get(handle);
+		if (!rect) {
+			return false;
+		}
+		const auto location = *slot_map.find(handle);
+		const auto area = static_cast<double>(rect->w) * static_cast<double>(rect->h);
+		auto& bin = *bins[location.bin];
+		if (!bin.remove(location.index)) {
+			return false;
+		}
+		slot_map.release(handle.slot);
+		if (location.index < bin.rect_slots.size() && bin.rect_slots[location.index] != no_rect_slot) {
+			slot_map.place(bin.rect_slots[location.index], location.bin, location.index);
+		}
+		refresh_capacity_index();
+		index_capacity(location.bin);
+		if (location.bin < stream_states.size() && stream_states[location.bin].rect_count != no_bin) {
+			stream_states[location.bin].used_area -= area;
+			stream_states[location.bin].rect_count = bin.rects.size();
+		}
+		return true;
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::get(const RectHandle& handle) noexcept -> RectType* {
+		return const_cast<RectType*>(std::as_const(*this).get(handle));
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::get(const RectHandle& handle) const noexcept -> const RectType* {
+		const auto* location = slot_map.find(handle);
+		if (!location || location->bin >= bins.size() || location->index >= bins[location->bin]->rects.size()) {
+			return nullptr;
+		}
+		return &bins[location->bin]->rects[location->index];
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::locate(const RectHandle& handle) const noexcept -> std::optional<RectLocation> {
+		if (!get(handle)) {
+			return std::nullopt;
+		}
+		return *slot_map.find(handle);
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::handle_at(std::size_t bin, std::size_t index) const noexcept -> RectHandle {
+		if (bin >= bins.size() || index >= bins[bin]->rect_slots.size()) {
+			return RectHandle{};
+		}
+		return slot_map.handle(bins[bin]->rect_slots[index]);
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::add_slotted(RectType&& rect, std::uint32_t slot) -> RectType* {
+		close_bins();
+		sync_capacity_index();
+		const auto area = static_cast<double>(rect.w) * static_cast<double>(rect.h);
+		const auto tag = options.tag ? tag_of(rect) : TagKey{};
 		
 		if (!can_fit_in_bin(rect)) {
-			bins.push_back(std::make_unique<OversizedElementBin<RectType, Numeric>>(rect));
+			bins.emplace_back(new (memory_resource) OversizedElementBin<RectType, Numeric>(std::move(rect), memory_resource));
+			bins.back()->tag = tag;
+			index_capacity(bins.size() - 1);
+			track(bins.size() - 1, slot);
+			observe_placement(bins.size() - 1, area);
 			return &bins.back()->rects[std::size_t{0}];
 		}
 		
-		
-		for (auto i = std::size_t{current_bin_index}; i < bins.size(); ++i) {
-			if (auto* added = bins[i]->add(rect)) {
-				return added;
-			}
+		if (const auto [index, fit] = find_bin(rect.w, rect.h, tag); fit.found) {
+			auto* added = bins[index]->commit_fit(std::move(rect), fit);
+			index_capacity(index);
+			track(index, slot);
+			observe_placement(index, area);
+			return added;
 		}
 
 		
-		auto bin = std::make_unique<MaxRectsBin<RectType, Numeric>>(width, height, padding, options);
-		bins.push_back(std::move(bin));
+		bins.push_back(make_bin(tag));
 		
 		
-		return bins.back()->add(rect);
+		auto* added = bins.back()->add(std::move(rect));
+		index_capacity(bins.size() - 1);
+		if (added) {
+			track(bins.size() - 1, slot);
+			observe_placement(bins.size() - 1, area);
+		} else {
+			slot_map.release(slot);
+		}
+		return added;
 	}
 
 	template<typename Numeric, typename RectType>
-	auto MaxRectsPacker<Numeric, RectType>::add(RectType&& rect) -> RectType* {
-		
-		if (!can_fit_in_bin(rect)) {
-			bins.push_back(std::make_unique<OversizedElementBin<RectType, Numeric>>(std::move(rect)));
-			return &bins.back()->rects[std::size_t{0}];
+	auto MaxRectsPacker<Numeric, RectType>::find_bin(Numeric w, Numeric h, TagKey tag) -> std::pair<std::size_t, BinFit<Numeric>> {
+		const auto rotate = options.allow_rotation;
+		if (options.tag) {
+			sync_tag_index();
+			fit_candidates.clear();
+			for (auto i : tag_index.bins_of(tag)) {
+				if (i >= current_bin_index && capacity_index.admits(i, w, h, rotate)) {
+					fit_candidates.push_back(i);
+				}
+			}
+			if (auto found = probe_candidates(w, h); found.second.found || options.exclusive_tag) {
+				return found;
+			}
 		}
 		
+		const auto skip = [&](std::size_t i) { return options.tag && bins[i]->tag == tag; };
+		if (options.bin_selection == BinSelection::FirstFit) {
+			for (auto i = capacity_index.find_first(current_bin_index, w, h, rotate);
+				i < bins.size(); i = capacity_index.find_first(i + 1, w, h, rotate)) {
+				if (skip(i)) {
+					continue;
+				}
+				stats_recorder.count_bins_probed(1);
+				if (const auto fit = bins[i]->find_fit(w, h); fit.found) {
+					return {i, fit};
+				}
+			}
+			return {no_bin, BinFit<Numeric>{}};
+		}
 		
-		for (auto i = std::size_t{current_bin_index}; i < bins.size(); ++i) {
-			if (auto* added = bins[i]->add(rect)) {
-				return added;
+		fit_candidates.clear();
+		for (auto i = capacity_index.find_first(current_bin_index, w, h, rotate);
+			i < bins.size(); i = capacity_index.find_first(i + 1, w, h, rotate)) {
+			if (!skip(i)) {
+				fit_candidates.push_back(i);
 			}
 		}
+		return probe_candidates(w, h);
+	}
 
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::probe_candidates(Numeric w, Numeric h) -> std::pair<std::size_t, BinFit<Numeric>> {
+		if (options.bin_selection == BinSelection::FirstFit) {
+			for (auto i : fit_candidates) {
+				stats_recorder.count_bins_probed(1);
+				if (const auto fit = bins[i]->find_fit(w, h); fit.found) {
+					return {i, fit};
+				}
+			}
+			return {no_bin, BinFit<Numeric>{}};
+		}
 		
-		auto bin = std::make_unique<MaxRectsBin<RectType, Numeric>>(width, height, padding, options);
-		bins.push_back(std::move(bin));
+		const auto candidate_count = fit_candidates.size();
+		bin_fits.resize(candidate_count);
+		stats_recorder.count_bins_probed(candidate_count);
 		
+		// Scoring only reads the bins, so candidates can be evaluated concurrently.
+		if (candidate_count >= parallel_fit_min_bins) {
+			pool().parallel_for(candidate_count, [&](std::size_t i) {
+				bin_fits[i] = bins[fit_candidates[i]]->find_fit(w, h);
+			});
+		} else {
+			for (auto i = std::size_t{0}; i < candidate_count; ++i) {
+				bin_fits[i] = bins[fit_candidates[i]]->find_fit(w, h);
+			}
+		}
 		
-		return bins.back()->add(std::move(rect));
-	}	template<typename Numeric, typename RectType>
+		auto best = BinFit<Numeric>{};
+		auto best_index = no_bin;
+		for (auto i = std::size_t{0}; i < candidate_count; ++i) {
+			if (bin_fits[i].better_than(best)) {
+				best = bin_fits[i];
+				best_index = fit_candidates[i];
+			}
+		}
+		return {best_index, best};
+	}
+
+	template<typename Numeric, typename RectType>
 	auto MaxRectsPacker<Numeric, RectType>::add_array(std::span<const RectType> rects) -> void {
+		add_array_slotted(rects, std::span<const std::uint32_t>{});
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::add_array_slotted(std::span<const RectType> rects,
+															std::span<const std::uint32_t> slots) -> void {
 		if (rects.empty()) {
 			return;
 		}
-		auto sorted_rects = std::vector<RectType>{};
-		sorted_rects.reserve(rects.size());
-		std::transform(rects.begin(), rects.end(), std::back_inserter(sorted_rects),
-			[](const auto& rect) -> RectType { return rect; 
-		});
-		sort_rects(sorted_rects);
-		if (bins.empty() && !sorted_rects.empty()) {
-			bins.reserve(1 + sorted_rects.size() / 16);
+		refresh_capacity_index();
+		if (options.shard != ShardMode::Off) {
+			pack_sharded(rects, slots, options.shard);
+			return;
 		}
-		for (auto& rect : sorted_rects) {
-			add(std::move(rect));
+		if (options.best_of) {
+			pack_best_of(rects, slots);
+			return;
+		}
+		if (options.global_fit) {
+			pack_global(rects, slots);
+			return;
+		}
+		const auto order = sort_rects(rects);
+		if (bins.empty()) {
+			bins.reserve(1 + rects.size() / 16);
+		}
+		for (auto index : order) {
+			const auto slot = slots.empty() || slots[index] == no_rect_slot ? slot_map.allocate() : slots[index];
+			add_slotted(RectType{rects[index]}, slot);
 		}
 	}
 
@@ -87,41 +262,486 @@ namespace MaxRects {
 		add_array(std::span<const RectType>{rects_ptr, count});
 	}
 
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::add_array(std::span<const Size<Numeric>> sizes,
+													std::span<Placement<Numeric>> placements) -> std::size_t {
+		sizes = sizes.first(std::min(sizes.size(), placements.size()));
+		if (sizes.empty()) {
+			return 0;
+		}
+		refresh_capacity_index();
+		const auto order = sort_rects(sizes);
+		
+		auto placed = std::size_t{0};
+		for (auto index : order) {
+			close_bins();
+			sync_capacity_index();
+			const auto size = sizes[index];
+			auto& placement = placements[index];
+			placement = Placement<Numeric>{};
+			if (!can_fit_in_bin(size)) {
+				continue;
+			}
+			
+			auto [bin, fit] = find_bin(size.w, size.h);
+			if (!fit.found) {
+				bins.push_back(make_bin());
+				index_capacity(bins.size() - 1);
+				if (bin_sink) {
+					sync_stream_states();
+				}
+				bin = bins.size() - 1;
+				fit = bins[bin]->find_fit(size.w, size.h);
+			}
+			if (!fit.found || !bins[bin]->reserve(fit)) {
+				continue;
+			}
+			index_capacity(bin);
+			observe_placement(bin, static_cast<double>(size.w) * static_cast<double>(size.h));
+			placement = Placement<Numeric>{bin_serial(bin), fit.x, fit.y, fit.rotated};
+			++placed;
+		}
+		return placed;
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::add_array_best_of(std::span<const RectType> rects) -> HeuristicResult {
+		return pack_best_of(rects, std::span<const std::uint32_t>{});
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::pack_best_of(std::span<const RectType> rects,
+														std::span<const std::uint32_t> slots) -> HeuristicResult {
+		constexpr auto sort_orders = std::array{SortOrder::MaxEdge, SortOrder::Area};
+		constexpr auto candidate_count = packing_logics.size() * sort_orders.size();
+		close_bins();
+		
+		auto candidates = std::vector<std::unique_ptr<MaxRectsPacker>>{};
+		auto results = std::vector<HeuristicResult>(candidate_count);
+		candidates.reserve(candidate_count);
+		for (auto i = std::size_t{0}; i < candidate_count; ++i) {
+			auto candidate_options = options;
+			candidate_options.logic = packing_logics[i / sort_orders.size()];
+			candidate_options.sort = sort_orders[i % sort_orders.size()];
+			candidate_options.best_of = false;
+			candidate_options.threads = 1;
+			
+			// Candidates grow concurrently, so they must not share a possibly
+			// unsynchronized arena; the winner's bins are cloned back below.
+			auto* candidate_resource = std::pmr::new_delete_resource();
+			auto candidate = std::make_unique<MaxRectsPacker>(width, height, padding, candidate_options, candidate_resource);
+			candidate->bins.reserve(bins.size());
+			for (const auto& bin : bins) {
+				candidate->bins.push_back(bin->clone(candidate_resource));
+			}
+			candidate->current_bin_index = current_bin_index;
+			candidate->slot_map = slot_map;
+			candidates.push_back(std::move(candidate));
+			results[i].logic = candidate_options.logic;
+			results[i].sort = candidate_options.sort;
+		}
+		
+		pool().parallel_for(candidate_count, [&](std::size_t i) {
+			candidates[i]->add_array_slotted(rects, slots);
+			results[i].bin_count = candidates[i]->bins.size();
+			results[i].occupancy = candidates[i]->occupancy();
+		});
+		
+		auto best = std::size_t{0};
+		for (auto i = std::size_t{1}; i < candidate_count; ++i) {
+			if (results[i].bin_count < results[best].bin_count ||
+				(results[i].bin_count == results[best].bin_count && results[i].occupancy > results[best].occupancy)) {
+				best = i;
+			}
+		}
+		
+		stats_recorder.merge(candidates[best]->stats_recorder.snapshot());
+		bins.clear();
+		bins.reserve(candidates[best]->bins.size());
+		for (const auto& bin : candidates[best]->bins) {
+			bins.push_back(bin->clone(memory_resource));
+		}
+		current_bin_index = candidates[best]->current_bin_index;
+		// The clones start at revision zero, so they are reindexed on the next
+		// sync rather than taking over the winner's index.
+		capacity_index.clear();
+		capacity_revisions.clear();
+		tag_index.clear();
+		slot_map = std::move(candidates[best]->slot_map);
+		// The winner started from clones of the open bins in order, so their
+		// stream states still line up; its new bins get fresh serials.
+		observe_bins();
+		return results[best];
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::add_array_sharded(std::span<const RectType> rects) -> ShardResult {
+		return pack_sharded(rects, std::span<const std::uint32_t>{},
+			options.shard == ShardMode::Off ? ShardMode::RoundRobin : options.shard);
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::pack_sharded(std::span<const RectType> rects,
+														std::span<const std::uint32_t> slots, ShardMode mode) -> ShardResult {
+		close_bins();
+		const auto order = sort_rects(rects);
+		auto shard_of = std::pmr::vector<std::size_t>(rects.size(), memory_resource);
+		const auto default_shards = options.deterministic ? deterministic_shard_count : pool().size();
+		auto shard_count = std::max<std::size_t>(std::min(options.shards == 0 ? default_shards : options.shards, rects.size()), 1);
+		
+		if (mode == ShardMode::Tag) {
+			auto shard_of_tag = std::pmr::unordered_map<TagKey, std::size_t, TagKeyHash>{memory_resource};
+			for (auto index : order) {
+				shard_of[index] = shard_of_tag.try_emplace(tag_of(rects[index]), shard_of_tag.size()).first->second;
+			}
+			shard_count = std::max<std::size_t>(shard_of_tag.size(), 1);
+		} else if (mode == ShardMode::SizeClass) {
+			auto total = 0.0;
+			for (const auto& rect : rects) {
+				total += static_cast<double>(rect.w) * static_cast<double>(rect.h);
+			}
+			auto shard = std::size_t{0};
+			auto covered = 0.0;
+			for (auto index : order) {
+				shard_of[index] = shard;
+				covered += static_cast<double>(rects[index].w) * static_cast<double>(rects[index].h);
+				if (shard + 1 < shard_count && covered * static_cast<double>(shard_count) >= total * static_cast<double>(shard + 1)) {
+					++shard;
+				}
+			}
+		} else {
+			for (auto position = std::size_t{0}; position < order.size(); ++position) {
+				shard_of[order[position]] = position % shard_count;
+			}
+		}
+		
+		// Slots are handed out here in sorted order, as a sequential pack would,
+		// and the shards only record them in their bins.
+		auto shard_rects = std::vector<std::vector<RectType>>(shard_count);
+		auto shard_slots = std::vector<std::vector<std::uint32_t>>(shard_count);
+		for (auto index : order) {
+			shard_rects[shard_of[index]].push_back(rects[index]);
+			shard_slots[shard_of[index]].push_back(slots.empty() || slots[index] == no_rect_slot ? slot_map.allocate() : slots[index]);
+		}
+		
+		// Shards grow concurrently, so they must not share a possibly
+		// unsynchronized arena.
+		auto* shard_resource = std::pmr::new_delete_resource();
+		auto shards = std::vector<std::unique_ptr<MaxRectsPacker>>{};
+		shards.reserve(shard_count);
+		for (auto i = std::size_t{0}; i < shard_count; ++i) {
+			auto shard_options = options;
+			shard_options.shard = ShardMode::Off;
+			shard_options.threads = 1;
+			shards.push_back(std::make_unique<MaxRectsPacker>(width, height, padding, shard_options, shard_resource));
+		}
+		pool().parallel_for(shard_count, [&](std::size_t i) {
+			shards[i]->add_array_slotted(shard_rects[i], shard_slots[i]);
+		});
+		
+		refresh_capacity_index();
+		const auto first_bin = bins.size();
+		for (auto& shard : shards) {
+			stats_recorder.merge(shard->stats_recorder.snapshot());
+			for (auto& bin : shard->bins) {
+				bins.push_back(memory_resource == shard_resource ? std::move(bin) : bin->clone(memory_resource));
+			}
+		}
+		auto used_area = 0.0;
+		for (auto i = first_bin; i < bins.size(); ++i) {
+			index_capacity(i);
+			relocate_slots(i);
+			for (const auto& rect : bins[i]->rects) {
+				used_area += static_cast<double>(rect.w) * static_cast<double>(rect.h);
+			}
+		}
+		observe_bins();
+		
+		const auto bin_count = bins.size() - first_bin;
+		const auto bin_area = static_cast<double>(width) * static_cast<double>(height);
+		// Oversized rects take a bin each; the rest need at least their area.
+		auto oversized = std::size_t{0};
+		auto fitting_area = 0.0;
+		for (const auto& rect : rects) {
+			const auto fits = (rect.w <= width && rect.h <= height) ||
+				(options.allow_rotation && rect.h <= width && rect.w <= height);
+			if (fits) {
+				fitting_area += static_cast<double>(rect.w) * static_cast<double>(rect.h);
+			} else {
+				++oversized;
+			}
+		}
+		const auto area_bound = bin_area > 0.0 ? static_cast<std::size_t>(std::ceil(fitting_area / bin_area)) : std::size_t{0};
+		const auto packed_area = bin_area * static_cast<double>(bin_count);
+		return ShardResult{shard_count, bin_count, oversized + area_bound, packed_area > 0.0 ? used_area / packed_area : 0.0};
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::pack_global(std::span<const RectType> rects,
+														std::span<const std::uint32_t> slots) -> void {
+		const auto slot_for = [&](std::size_t index) {
+			return slots.empty() || slots[index] == no_rect_slot ? slot_map.allocate() : slots[index];
+		};
+		const auto tag_for = [&](std::size_t index) {
+			return options.tag ? tag_of(rects[index]) : TagKey{};
+		};
+		
+		auto pending = std::pmr::vector<std::size_t>{memory_resource};
+		pending.reserve(rects.size());
+		for (auto index : sort_rects(rects)) {
+			if (can_fit_in_bin(rects[index])) {
+				pending.push_back(index);
+			} else {
+				add_slotted(RectType{rects[index]}, slot_for(index));
+			}
+		}
+		close_bins();
+		sync_capacity_index();
+		if (options.tag) {
+			std::stable_sort(pending.begin(), pending.end(), [&](std::size_t a, std::size_t b) {
+				return tag_for(a).value < tag_for(b).value;
+			});
+		}
+		
+		// The sort order is kept throughout, so ties go to the rect that would
+		// have been inserted first. A rect that misses a bin once can be
+		// dropped from it for good, because placing only ever shrinks the
+		// free space. Fits stay next to their rect so the bin can refresh them
+		// instead of rescoring.
+		auto candidates = std::pmr::vector<std::size_t>{memory_resource};
+		auto sizes = std::pmr::vector<Size<Numeric>>{memory_resource};
+		auto fits = std::pmr::vector<CachedFit<Numeric>>{memory_resource};
+		auto placed = std::pmr::vector<std::uint8_t>(rects.size(), std::uint8_t{0}, memory_resource);
+		const auto fill = [&](std::size_t bin, std::pmr::vector<std::size_t>& group) {
+			candidates = group;
+			sizes.resize(candidates.size());
+			fits.assign(candidates.size(), CachedFit<Numeric>{});
+			for (auto i = std::size_t{0}; i < candidates.size(); ++i) {
+				sizes[i] = Size<Numeric>{rects[candidates[i]].w, rects[candidates[i]].h};
+			}
+			auto placed_in_bin = std::size_t{0};
+			while (!candidates.empty()) {
+				bins[bin]->find_fits(sizes, fits, &pool());
+				stats_recorder.count_bins_probed(1);
+				
+				auto best = no_bin;
+				for (auto i = std::size_t{0}; i < candidates.size(); ++i) {
+					if (fits[i].fit.better_than(best == no_bin ? BinFit<Numeric>{} : fits[best].fit)) {
+						best = i;
+					}
+				}
+				if (best == no_bin) {
+					break;
+				}
+				
+				const auto index = candidates[best];
+				bins[bin]->commit_fit(RectType{rects[index]}, fits[best].fit);
+				index_capacity(bin);
+				track(bin, slot_for(index));
+				observe_placement(bin, static_cast<double>(rects[index].w) * static_cast<double>(rects[index].h));
+				placed[index] = std::uint8_t{1};
+				++placed_in_bin;
+				
+				auto kept = std::size_t{0};
+				for (auto i = std::size_t{0}; i < candidates.size(); ++i) {
+					if (i != best && fits[i].fit.found) {
+						candidates[kept] = candidates[i];
+						sizes[kept] = sizes[i];
+						fits[kept] = fits[i];
+						++kept;
+					}
+				}
+				candidates.resize(kept);
+				sizes.resize(kept);
+				fits.resize(kept);
+			}
+			std::erase_if(group, [&](std::size_t index) { return placed[index] != 0; });
+			return placed_in_bin;
+		};
+		
+		// Each tag fills its own open bins first, then any other open bin when
+		// tags are not exclusive, then fresh bins of its tag.
+		auto group = std::pmr::vector<std::size_t>{memory_resource};
+		auto open_bins = std::pmr::vector<std::size_t>{memory_resource};
+		for (auto first = std::size_t{0}; first < pending.size();) {
+			const auto tag = tag_for(pending[first]);
+			auto last = first;
+			while (last < pending.size() && tag_for(pending[last]) == tag) {
+				++last;
+			}
+			group.assign(pending.begin() + static_cast<std::ptrdiff_t>(first), pending.begin() + static_cast<std::ptrdiff_t>(last));
+			first = last;
+			
+			open_bins.clear();
+			if (options.tag) {
+				sync_tag_index();
+				for (auto bin : tag_index.bins_of(tag)) {
+					if (bin >= current_bin_index) {
+						open_bins.push_back(bin);
+					}
+				}
+			}
+			for (auto bin = current_bin_index; bin < bins.size() && !(options.tag && options.exclusive_tag); ++bin) {
+				if (!options.tag || bins[bin]->tag != tag) {
+					open_bins.push_back(bin);
+				}
+			}
+			for (auto bin : open_bins) {
+				if (group.empty()) {
+					break;
+				}
+				fill(bin, group);
+			}
+			
+			while (!group.empty()) {
+				bins.push_back(make_bin(tag));
+				index_capacity(bins.size() - 1);
+				if (bin_sink) {
+					sync_stream_states();
+				}
+				if (fill(bins.size() - 1, group) == 0) {
+					for (auto index : group) {
+						if (!slots.empty() && slots[index] != no_rect_slot) {
+							slot_map.release(slots[index]);
+						}
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::stream(BinSink sink, StreamPolicy policy) -> void {
+		bin_sink = std::move(sink);
+		stream_policy = policy;
+		stream_states.clear();
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::closed_bin_count() const noexcept -> std::size_t {
+		return closed_bins;
+	}
+
 	template<typename Numeric, typename RectType>
 	auto MaxRectsPacker<Numeric, RectType>::reset() -> void {
 		bins.clear();
+		capacity_index.clear();
+		capacity_revisions.clear();
+		tag_index.clear();
+		slot_map.clear();
+		stats_recorder.reset();
+		stream_states.clear();
+		next_bin_serial = std::size_t{0};
+		closed_bins = std::size_t{0};
 		current_bin_index = std::size_t{0};
 	}
 	template<typename Numeric, typename RectType>
 	auto MaxRectsPacker<Numeric, RectType>::repack(bool quick) -> void {
+		close_bins();
+		for (auto& state : stream_states) {
+			state.rect_count = no_bin;
+		}
 		if (quick) {
-			auto unpacked = std::vector<RectType>{};
+			auto unpacked = std::pmr::vector<RectType>{memory_resource};
+			auto unpacked_slots = std::pmr::vector<std::uint32_t>{memory_resource};
 			unpacked.reserve(bins.size() * 16);
 			
-			for (auto& bin : bins) {
-				if (bin->is_dirty()) {
-					auto bin_unpacked = bin->repack();
-					unpacked.insert(unpacked.end(), 
-								std::make_move_iterator(bin_unpacked.begin()), 
-								std::make_move_iterator(bin_unpacked.end()));
+			refresh_capacity_index();
+			auto dirty = std::pmr::vector<std::size_t>{memory_resource};
+			for (auto i = std::size_t{0}; i < bins.size(); ++i) {
+				if (bins[i]->is_dirty()) {
+					dirty.push_back(i);
+				}
+			}
+			
+			// A bin repack only touches that bin, so they can run concurrently
+			// as long as the bins allocate from a synchronized resource. The
+			// leftovers are gathered in bin order either way.
+			auto leftovers = std::pmr::vector<std::pmr::vector<RectType>>{memory_resource};
+			leftovers.resize(dirty.size());
+			const auto repack_bin = [&](std::size_t k) {
+				leftovers[k] = bins[dirty[k]]->repack();
+			};
+			if (dirty.size() > 1 && concurrent_resource()) {
+				pool().parallel_for(dirty.size(), repack_bin);
+			} else {
+				for (auto k = std::size_t{0}; k < dirty.size(); ++k) {
+					repack_bin(k);
+				}
+			}
+			
+			for (auto k = std::size_t{0}; k < dirty.size(); ++k) {
+				const auto i = dirty[k];
+				auto& bin_unpacked = leftovers[k];
+				auto& bin_slots = bins[i]->unpacked_slots;
+				if (bin_slots.size() != bin_unpacked.size()) {
+					bin_slots.assign(bin_unpacked.size(), no_rect_slot);
 				}
+				index_capacity(i);
+				relocate_slots(i);
+				unpacked.insert(unpacked.end(), 
+							std::make_move_iterator(bin_unpacked.begin()), 
+							std::make_move_iterator(bin_unpacked.end()));
+				unpacked_slots.insert(unpacked_slots.end(), bin_slots.begin(), bin_slots.end());
 			}
 			if (!unpacked.empty()) {
-				add_array(std::span<const RectType>{unpacked.data(), unpacked.size()});
+				add_array_slotted(unpacked, unpacked_slots);
 			}
 			return;
 		}
 
 		if (!is_dirty()) return;
 		
-		auto all_rects = std::vector<RectType>{};
-		get_all_rects_into(all_rects);
-		reset();
-		add_array(std::span<const RectType>{all_rects.data(), all_rects.size()});
+		// Bins holding reserved regions keep their index, since placements
+		// refer to them by it, and are only repacked in place. The bins before
+		// them are swapped for empty ones and the rest are dropped.
+		auto kept_bins = std::size_t{0};
+		for (auto i = std::size_t{0}; i < bins.size(); ++i) {
+			if (!bins[i]->reserved.empty()) {
+				kept_bins = i + 1;
+			}
+		}
+		auto all_rects = std::pmr::vector<RectType>{memory_resource};
+		auto all_slots = std::pmr::vector<std::uint32_t>{memory_resource};
+		for (auto i = std::size_t{0}; i < bins.size(); ++i) {
+			auto& bin = bins[i];
+			if (!bin->reserved.empty()) {
+				auto leftovers = bin->repack();
+				bin->unpacked_slots.resize(leftovers.size(), no_rect_slot);
+				all_rects.insert(all_rects.end(), std::make_move_iterator(leftovers.begin()),
+								std::make_move_iterator(leftovers.end()));
+				all_slots.insert(all_slots.end(), bin->unpacked_slots.begin(), bin->unpacked_slots.end());
+				continue;
+			}
+			bin->rect_slots.resize(bin->rects.size(), no_rect_slot);
+			all_rects.insert(all_rects.end(), bin->rects.begin(), bin->rects.end());
+			all_slots.insert(all_slots.end(), bin->rect_slots.begin(), bin->rect_slots.end());
+			if (i < kept_bins) {
+				bin = make_bin(bin->tag);
+			}
+		}
+		bins.resize(kept_bins);
+		capacity_index.clear();
+		capacity_revisions.clear();
+		tag_index.clear();
+		stream_states.resize(std::min(stream_states.size(), kept_bins));
+		current_bin_index = std::size_t{0};
+		for (auto i = std::size_t{0}; i < bins.size(); ++i) {
+			relocate_slots(i);
+		}
+		add_array_slotted(all_rects, all_slots);
 	}
 
 	template<typename Numeric, typename RectType>
 	auto MaxRectsPacker<Numeric, RectType>::next() -> std::size_t {
+		if (bin_sink) {
+			sync_stream_states();
+			for (auto& state : stream_states) {
+				state.closing = true;
+			}
+			close_bins();
+		}
 		current_bin_index = bins.size();
 		return current_bin_index;
 	}
@@ -131,11 +751,38 @@ namespace MaxRects {
 		return current_bin_index;
 	}
 
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::get_memory_resource() const noexcept -> std::pmr::memory_resource* {
+		return memory_resource;
+	}
+
 	template<typename Numeric, typename RectType>
 	auto MaxRectsPacker<Numeric, RectType>::is_dirty() const noexcept -> bool {
 		return std::any_of(bins.begin(), bins.end(),
 						[](const auto& bin) { return bin->is_dirty(); });
 	}
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::occupancy() const noexcept -> double {
+		auto used_area = 0.0;
+		auto bin_area = 0.0;
+		for (const auto& bin : bins) {
+			bin_area += static_cast<double>(bin->width) * static_cast<double>(bin->height);
+			for (const auto& rect : bin->rects) {
+				used_area += static_cast<double>(rect.w) * static_cast<double>(rect.h);
+			}
+		}
+		return bin_area > 0.0 ? used_area / bin_area : 0.0;
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::stats() const noexcept -> PackingStats {
+		auto total = stats_recorder.snapshot();
+		for (const auto& bin : bins) {
+			total.merge(bin->stats());
+		}
+		return total;
+	}
+
 	template<typename Numeric, typename RectType>
 	auto MaxRectsPacker<Numeric, RectType>::get_all_rects() const -> std::vector<RectType> {
 		auto all_rects = std::vector<RectType>{};
@@ -159,21 +806,319 @@ namespace MaxRects {
 	}
 
 	template<typename Numeric, typename RectType>
-	auto MaxRectsPacker<Numeric, RectType>::can_fit_in_bin(const RectType& rect) const noexcept -> bool {
+	template<typename Item>
+	auto MaxRectsPacker<Numeric, RectType>::can_fit_in_bin(const Item& rect) const noexcept -> bool {
 		return (rect.w <= width && rect.h <= height) ||
 			(options.allow_rotation && rect.w <= height && rect.h <= width);
 	}
 	template<typename Numeric, typename RectType>
-	auto MaxRectsPacker<Numeric, RectType>::sort_rects(std::vector<RectType>& rects) const -> void {
-		std::sort(rects.begin(), rects.end(), [this](const auto& a, const auto& b) {
-			if (options.logic == PackingLogic::MaxEdge) {
-				return std::max(a.w, a.h) > std::max(b.w, b.h);
-			} else {
-				return a.area() > b.area();
-			}
+	template<typename Item>
+	auto MaxRectsPacker<Numeric, RectType>::sort_rects(std::span<const Item> rects) const -> std::pmr::vector<std::size_t> {
+		const auto by_edge = options.sort == SortOrder::MaxEdge ||
+			(options.sort == SortOrder::Auto && options.logic == PackingLogic::MaxEdge);
+		auto order = std::pmr::vector<std::size_t>(rects.size(), memory_resource);
+		std::iota(order.begin(), order.end(), std::size_t{0});
+		// Ties keep their input order, so the result does not depend on how a
+		// particular std::sort happens to shuffle equal keys.
+		std::sort(order.begin(), order.end(), [by_edge, rects](std::size_t a, std::size_t b) {
+			const auto key_a = by_edge ? std::max(rects[a].w, rects[a].h) : rects[a].area();
+			const auto key_b = by_edge ? std::max(rects[b].w, rects[b].h) : rects[b].area();
+			return key_a > key_b || (key_a == key_b && a < b);
 		});
+		return order;
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::make_bin(TagKey tag) -> std::unique_ptr<AbstractBin<RectType, Numeric>> {
+		auto bin = std::unique_ptr<AbstractBin<RectType, Numeric>>{};
+		if (options.bin_algorithm == BinAlgorithm::Skyline) {
+			bin.reset(new (memory_resource) SkylineBin<RectType, Numeric>(width, height, padding, options, memory_resource));
+		} else if (options.bin_algorithm == BinAlgorithm::Guillotine) {
+			bin.reset(new (memory_resource) GuillotineBin<RectType, Numeric>(width, height, padding, options, memory_resource));
+		} else {
+			bin.reset(new (memory_resource) MaxRectsBin<RectType, Numeric>(width, height, padding, options, memory_resource));
+		}
+		bin->tag = tag;
+		return bin;
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::track(std::size_t bin, std::uint32_t slot) -> void {
+		auto& target = *bins[bin];
+		target.rect_slots.resize(target.rects.size() - 1, no_rect_slot);
+		target.rect_slots.push_back(slot);
+		slot_map.place(slot, bin, target.rects.size() - 1);
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::relocate_slots(std::size_t bin) noexcept -> void {
+		const auto& slots = bins[bin]->rect_slots;
+		for (auto index = std::size_t{0}; index < slots.size(); ++index) {
+			if (slots[index] != no_rect_slot) {
+				slot_map.place(slots[index], bin, index);
+			}
+		}
 	}
 	
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::sync_capacity_index() -> void {
+		if (capacity_index.size() == bins.size() && capacity_revisions.size() == bins.size()) {
+			return;
+		}
+		capacity_index.clear();
+		capacity_revisions.clear();
+		for (auto i = std::size_t{0}; i < bins.size(); ++i) {
+			index_capacity(i);
+		}
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::refresh_capacity_index() -> void {
+		sync_capacity_index();
+		// Bins before current_bin_index are never probed again.
+		for (auto i = current_bin_index; i < bins.size(); ++i) {
+			if (capacity_revisions[i] != bins[i]->revision) {
+				index_capacity(i);
+			}
+		}
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::index_capacity(std::size_t bin) -> void {
+		if (bin < capacity_index.size()) {
+			capacity_index.assign(bin, bins[bin]->capacity());
+			capacity_revisions[bin] = bins[bin]->revision;
+		} else {
+			capacity_index.push_back(bins[bin]->capacity());
+			capacity_revisions.push_back(bins[bin]->revision);
+		}
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::sync_tag_index() -> void {
+		if (tag_index.size() > bins.size()) {
+			tag_index.clear();
+		}
+		while (tag_index.size() < bins.size()) {
+			tag_index.push_back(bins[tag_index.size()]->tag);
+		}
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::sync_stream_states() -> void {
+		while (stream_states.size() < bins.size()) {
+			stream_states.push_back(StreamState{next_bin_serial++});
+			stream_states.back().rect_count = no_bin;
+		}
+		for (auto i = std::size_t{0}; i < bins.size(); ++i) {
+			auto& state = stream_states[i];
+			const auto& rects = bins[i]->rects;
+			if (state.rect_count == rects.size()) {
+				continue;
+			}
+			state.used_area = 0.0;
+			for (const auto& rect : rects) {
+				state.used_area += static_cast<double>(rect.w) * static_cast<double>(rect.h);
+			}
+			state.rect_count = rects.size();
+		}
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::observe_placement(std::size_t bin, double area) -> void {
+		if (!bin_sink) {
+			return;
+		}
+		// New and repacked bins are summed from their rects by the sync below.
+		if (bin < stream_states.size() && stream_states[bin].rect_count != no_bin) {
+			stream_states[bin].used_area += area;
+			stream_states[bin].rect_count = bins[bin]->rects.size();
+		}
+		sync_stream_states();
+		for (auto i = std::size_t{0}; i < bins.size(); ++i) {
+			auto& state = stream_states[i];
+			state.misses = i == bin ? std::size_t{0} : state.misses + 1;
+			state.closing = state.closing || must_close(i);
+		}
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::observe_bins() -> void {
+		if (!bin_sink) {
+			return;
+		}
+		for (auto& state : stream_states) {
+			state.rect_count = no_bin;
+		}
+		sync_stream_states();
+		for (auto i = std::size_t{0}; i < bins.size(); ++i) {
+			stream_states[i].closing = stream_states[i].closing || must_close(i);
+		}
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::must_close(std::size_t bin) const noexcept -> bool {
+		const auto& state = stream_states[bin];
+		const auto bin_area = static_cast<double>(width) * static_cast<double>(height);
+		return bins[bin]->capacity().max_area <= Numeric{} ||
+			state.used_area >= stream_policy.close_occupancy * bin_area ||
+			(stream_policy.close_after_misses > 0 && state.misses >= stream_policy.close_after_misses);
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::close_bins() -> void {
+		if (!bin_sink || stream_states.size() != bins.size()) {
+			return;
+		}
+		auto kept = std::size_t{0};
+		auto kept_before_current = std::size_t{0};
+		for (auto i = std::size_t{0}; i < bins.size(); ++i) {
+			if (!stream_states[i].closing) {
+				if (i < current_bin_index) {
+					++kept_before_current;
+				}
+				if (kept != i) {
+					bins[kept] = std::move(bins[i]);
+					stream_states[kept] = stream_states[i];
+				}
+				++kept;
+				continue;
+			}
+			auto& bin = *bins[i];
+			bin_sink(stream_states[i].serial, bin);
+			for (auto slot : bin.rect_slots) {
+				if (slot != no_rect_slot) {
+					slot_map.release(slot);
+				}
+			}
+			stats_recorder.merge(bin.stats());
+			bins[i].reset();
+			++closed_bins;
+		}
+		if (kept == bins.size()) {
+			return;
+		}
+		
+		bins.resize(kept);
+		stream_states.resize(kept);
+		current_bin_index = kept_before_current;
+		capacity_index.clear();
+		capacity_revisions.clear();
+		tag_index.clear();
+		for (auto i = std::size_t{0}; i < bins.size(); ++i) {
+			relocate_slots(i);
+		}
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::bin_serial(std::size_t bin) const noexcept -> std::size_t {
+		return bin_sink && bin < stream_states.size() ? stream_states[bin].serial : bin;
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::pool() -> ThreadPool& {
+		if (!thread_pool) {
+			thread_pool = std::make_unique<ThreadPool>(options.threads);
+		}
+		return *thread_pool;
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::snapshot(std::vector<std::byte>& out,
+													const SnapshotPayloadWriter<RectType>& payload) const -> bool {
+		auto writer = SnapshotWriter{snapshot_format<RectType, Numeric>(), memory_resource};
+		writer.add(SnapshotPacker<Numeric>{width, height, padding, bins.size(), current_bin_index,
+			next_bin_serial, closed_bins, to_snapshot(options)});
+		auto serials = std::pmr::vector<std::uint64_t>{memory_resource};
+		serials.reserve(bins.size());
+		for (auto i = std::size_t{0}; i < bins.size(); ++i) {
+			serials.push_back(bin_serial(i));
+		}
+		writer.add(std::span<const std::uint64_t>{serials});
+		slot_map.save(writer);
+		for (const auto& bin : bins) {
+			if (!bin->save(writer, payload)) {
+				return false;
+			}
+		}
+		writer.write(out);
+		return true;
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::restore(std::span<const std::byte> bytes,
+													const SnapshotPayloadReader<RectType>& payload) -> bool {
+		const auto reader = SnapshotReader{bytes};
+		const auto info = reader.section<SnapshotPacker<Numeric>>(static_cast<std::size_t>(SnapshotPackerSection::Packer));
+		if (!reader.valid() || reader.format() != snapshot_format<RectType, Numeric>() || info.size() != 1) {
+			return false;
+		}
+		const auto bin_count = reader.section_count() - snapshot_packer_sections;
+		const auto serials = reader.section<std::uint64_t>(static_cast<std::size_t>(SnapshotPackerSection::BinSerials));
+		if (bin_count % snapshot_bin_sections != 0 || info[0].bin_count != bin_count / snapshot_bin_sections ||
+			serials.size() != info[0].bin_count || info[0].current_bin_index > info[0].bin_count) {
+			return false;
+		}
+		
+		auto restored_slots = RectSlotMap{memory_resource};
+		if (!restored_slots.restore(reader, static_cast<std::size_t>(SnapshotPackerSection::Slots))) {
+			return false;
+		}
+		auto restored = std::pmr::vector<std::unique_ptr<AbstractBin<RectType, Numeric>>>{memory_resource};
+		restored.reserve(static_cast<std::size_t>(info[0].bin_count));
+		for (auto i = std::size_t{0}; i < info[0].bin_count; ++i) {
+			const auto first = snapshot_packer_sections + i * snapshot_bin_sections;
+			const auto bin_info = reader.section<SnapshotBin<Numeric>>(snapshot_index(first, SnapshotSection::Bin));
+			if (bin_info.size() != 1) {
+				return false;
+			}
+			auto bin = std::unique_ptr<AbstractBin<RectType, Numeric>>{};
+			if (bin_info[0].kind == SnapshotBinKind::Oversized) {
+				bin.reset(new (memory_resource) OversizedElementBin<RectType, Numeric>(RectType{}, memory_resource));
+			} else {
+				bin.reset(new (memory_resource) MaxRectsBin<RectType, Numeric>(bin_info[0].max_width, bin_info[0].max_height,
+					Numeric{}, from_snapshot(bin_info[0].options), memory_resource));
+			}
+			if (!bin->restore(reader, first, payload)) {
+				return false;
+			}
+			restored.push_back(std::move(bin));
+		}
+		
+		bins = std::move(restored);
+		width = info[0].width;
+		height = info[0].height;
+		padding = info[0].padding;
+		options = from_snapshot(info[0].options);
+		current_bin_index = static_cast<std::size_t>(info[0].current_bin_index);
+		next_bin_serial = static_cast<std::size_t>(info[0].next_bin_serial);
+		closed_bins = static_cast<std::size_t>(info[0].closed_bins);
+		slot_map = std::move(restored_slots);
+		thread_pool.reset();
+		capacity_index.clear();
+		capacity_revisions.clear();
+		sync_capacity_index();
+		tag_index.clear();
+		stream_states.clear();
+		for (auto i = std::size_t{0}; i < bins.size(); ++i) {
+			relocate_slots(i);
+			if (bin_sink) {
+				stream_states.push_back(StreamState{static_cast<std::size_t>(serials[i])});
+				stream_states.back().rect_count = no_bin;
+			}
+		}
+		if (bin_sink) {
+			sync_stream_states();
+		}
+		return true;
+	}
+
+	template<typename Numeric, typename RectType>
+	auto MaxRectsPacker<Numeric, RectType>::concurrent_resource() const noexcept -> bool {
+		return memory_resource == std::pmr::new_delete_resource() ||
+			dynamic_cast<std::pmr::synchronized_pool_resource*>(memory_resource) != nullptr;
+	}
+
 	template<typename Numeric, typename RectType>
 	auto MaxRectsPacker<Numeric, RectType>::reserve(std::size_t capacity) -> void {
 		bins.reserve(capacity / 16 + 1);
@@ -188,4 +1133,8 @@ namespace MaxRects {
 
 	template class MaxRectsPacker<int, Rectangle<int>>;
 
+	template class MaxRectsPacker<int, CompactRect<std::int16_t>>;
+
+	template class MaxRectsPacker<int, CompactRect<std::int32_t>>;
+
 }
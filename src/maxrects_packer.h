@@ -1,57 +1,249 @@
 #pragma once
 
+#include "bin_capacity_index.h"
+#include "bin_tag_index.h"
 #include "maxrects_bin.h"
 #include "oversized_element_bin.h"
+#include "skyline_bin.h"
+#include "guillotine_bin.h"
+#include "rect_slot_map.h"
+#include "thread_pool.h"
 #include <memory>
+#include <memory_resource>
+#include <optional>
 #include <vector>
 #include <algorithm>
+#include <functional>
 #include <span>
+#include <utility>
 
 namespace MaxRects {
 
+	constexpr std::size_t parallel_fit_min_bins = 32;
+
+	constexpr std::size_t deterministic_shard_count = 8;
+
+	struct HeuristicResult {
+		PackingLogic logic{PackingLogic::MaxEdge};
+		SortOrder sort{SortOrder::MaxEdge};
+		std::size_t bin_count{};
+		double occupancy{};
+	};
+
+	// Outcome of a sharded add_array. Shards pack without seeing each other
+	// and each ends in a part-filled bin, so a sharded pack typically needs a
+	// few more bins than a sequential one, often about one per extra shard.
+	// Nothing bounds that. area_bound_bins is the fewest bins any pack of
+	// the input could use, sequential included, so bin_count minus it caps
+	// the overhead this call paid. maxrects_bench prints the measured
+	// overhead against a sequential pack for each workload.
+	struct ShardResult {
+		std::size_t shard_count{};
+		std::size_t bin_count{};
+		std::size_t area_bound_bins{};
+		double occupancy{};
+	};
+
+	// When a streaming packer hands a bin to its sink. Bins that cannot take
+	// anything more are always closed; next() closes every open bin.
+	struct StreamPolicy {
+		double close_occupancy{1.0};
+		std::size_t close_after_misses{0};
+	};
+
 	template<typename Numeric = float, typename RectType = Rectangle<Numeric>>
 	class MaxRectsPacker {
 	public:
-		std::vector<std::unique_ptr<AbstractBin<RectType, Numeric>>> bins{};
+		// Bins may be changed directly, e.g. a rect removed or a bin repacked;
+		// the next add, insert, remove or repack notices through
+		// AbstractBin::revision and refreshes that bin's capacity.
+		std::pmr::vector<std::unique_ptr<AbstractBin<RectType, Numeric>>> bins{};
 		PackingOptions<Numeric> options{};
 		Numeric width{};
 		Numeric height{};
 		Numeric padding{};
 
+		using BinSink = std::function<void(std::size_t serial, AbstractBin<RectType, Numeric>& bin)>;
+
 		explicit MaxRectsPacker(Numeric w = Numeric{}, Numeric h = Numeric{},
-							Numeric pad = Numeric{}, const PackingOptions<Numeric>& opts = {});
+							Numeric pad = Numeric{}, const PackingOptions<Numeric>& opts = {},
+							std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 		auto add(Numeric rect_width, Numeric rect_height, std::any data = {}) -> RectType*;
 
 		auto add(const RectType& rect) -> RectType*;
 		
 		auto add(RectType&& rect) -> RectType*;
 
+		auto insert(const RectType& rect) -> RectHandle;
+
+		auto insert(RectType&& rect) -> RectHandle;
+
+		// Frees the rect's area in place, without repacking its bin.
+		auto remove(const RectHandle& handle) -> bool;
+
+		[[nodiscard]] auto get(const RectHandle& handle) noexcept -> RectType*;
+
+		[[nodiscard]] auto get(const RectHandle& handle) const noexcept -> const RectType*;
+
+		[[nodiscard]] auto locate(const RectHandle& handle) const noexcept -> std::optional<RectLocation>;
+
+		[[nodiscard]] auto handle_at(std::size_t bin, std::size_t index) const noexcept -> RectHandle;
+
 		auto add_array(std::span<const RectType> rects) -> void;
 
 		auto add_array(const RectType* rects_ptr, std::size_t count) -> void;
 
+		// Packs bare sizes and writes each result to the placement at the same
+		// index, without constructing a RectType. Sizes that fit no bin are left
+		// unplaced. The regions are kept in each bin's reserved list and hold
+		// no rects, so handles and get_all_rects() do not cover them; repack()
+		// never moves them or places rects over them. Returns the number of
+		// sizes placed.
+		auto add_array(std::span<const Size<Numeric>> sizes, std::span<Placement<Numeric>> placements) -> std::size_t;
+
+		auto add_array_best_of(std::span<const RectType> rects) -> HeuristicResult;
+
+		// Splits rects into PackingOptions::shards shards (one per worker when
+		// zero, or deterministic_shard_count in deterministic mode) and packs
+		// each into fresh bins on its own thread; round-robin unless
+		// PackingOptions::shard says otherwise. Open bins are not filled, and
+		// the new bins are appended in shard order.
+		auto add_array_sharded(std::span<const RectType> rects) -> ShardResult;
+
+		// Streams closed bins to sink, which gets each bin's serial (its order of
+		// creation) before the bin and the handles of its rects are released.
+		// Bins close at the start of the next packer call, so open bins shift
+		// down and Placement::bin holds the serial instead of an index. An empty
+		// sink turns streaming off.
+		auto stream(BinSink sink, StreamPolicy policy = {}) -> void;
+
+		[[nodiscard]] auto closed_bin_count() const noexcept -> std::size_t;
+
 		auto reset() -> void;
 
+		// A quick repack repacks each dirty bin in place, on the thread pool when
+		// there are several, and then reinserts what no longer fits in bin
+		// order. A full repack packs every rect again from scratch.
 		auto repack(bool quick = true) -> void;
 
 		auto next() -> std::size_t;
 
 		[[nodiscard]] auto get_current_bin_index() const noexcept -> std::size_t;
 
+		[[nodiscard]] auto get_memory_resource() const noexcept -> std::pmr::memory_resource*;
+
 		[[nodiscard]] auto is_dirty() const noexcept -> bool;
 
+		[[nodiscard]] auto occupancy() const noexcept -> double;
+
+		[[nodiscard]] auto stats() const noexcept -> PackingStats;
+
 		[[nodiscard]]		auto get_all_rects() const -> std::vector<RectType>;
 		
 		auto get_all_rects_into(std::vector<RectType>& output) const -> void;
 		
 		auto reserve(std::size_t capacity) -> void;
 
+		// Writes the packer, every bin with its free space, and the handle
+		// table to out as one versioned snapshot. payload is called for each
+		// rect to save what it carries beyond its geometry. Fails, leaving out
+		// untouched, when a bin type has no snapshot form (skyline and
+		// guillotine bins).
+		auto snapshot(std::vector<std::byte>& out, const SnapshotPayloadWriter<RectType>& payload = {}) const -> bool;
+
+		// Replaces the packer's state with a snapshot written by the same
+		// Numeric. bytes must be aligned to snapshot_alignment, as a mapped
+		// file or a std::vector<std::byte> is; free lists are copied back as
+		// they are. The packer is left unchanged when the snapshot is
+		// rejected. The sink and policy of stream() are kept.
+		auto restore(std::span<const std::byte> bytes, const SnapshotPayloadReader<RectType>& payload = {}) -> bool;
+
 	private:
 		std::size_t current_bin_index{};
+		std::pmr::memory_resource* memory_resource{};
+		std::unique_ptr<ThreadPool> thread_pool{};
+		std::pmr::vector<BinFit<Numeric>> bin_fits{};
+		std::pmr::vector<std::size_t> fit_candidates{};
+		BinCapacityIndex<Numeric> capacity_index{};
+		// Revision of each bin when its capacity_index entry was taken.
+		std::pmr::vector<std::size_t> capacity_revisions{};
+		BinTagIndex tag_index{};
+		[[no_unique_address]] StatsRecorder<> stats_recorder{};
+		RectSlotMap slot_map{};
+		BinSink bin_sink{};
+		StreamPolicy stream_policy{};
+		std::size_t next_bin_serial{};
+		std::size_t closed_bins{};
+
+		struct StreamState {
+			std::size_t serial{};
+			std::size_t rect_count{};
+			double used_area{};
+			std::size_t misses{};
+			bool closing{false};
+		};
+
+		std::pmr::vector<StreamState> stream_states{};
+
+		auto pool() -> ThreadPool&;
+
+		// Whether bins may allocate from several threads at once.
+		[[nodiscard]] auto concurrent_resource() const noexcept -> bool;
+
+		auto add_slotted(RectType&& rect, std::uint32_t slot) -> RectType*;
+
+		auto add_array_slotted(std::span<const RectType> rects, std::span<const std::uint32_t> slots) -> void;
+
+		auto pack_best_of(std::span<const RectType> rects, std::span<const std::uint32_t> slots) -> HeuristicResult;
+
+		auto pack_sharded(std::span<const RectType> rects, std::span<const std::uint32_t> slots, ShardMode mode) -> ShardResult;
+
+		// Fills one bin at a time, each step placing whichever pending rect
+		// scores best against the bin's current free space.
+		auto pack_global(std::span<const RectType> rects, std::span<const std::uint32_t> slots) -> void;
+
+		// With PackingOptions::tag, only bins of the given tag are probed, and
+		// when tags are not exclusive every other bin after them.
+		[[nodiscard]] auto find_bin(Numeric w, Numeric h, TagKey tag = {}) -> std::pair<std::size_t, BinFit<Numeric>>;
+
+		[[nodiscard]] auto probe_candidates(Numeric w, Numeric h) -> std::pair<std::size_t, BinFit<Numeric>>;
+
+		auto track(std::size_t bin, std::uint32_t slot) -> void;
+
+		auto relocate_slots(std::size_t bin) noexcept -> void;
+
+		// Rebuilds capacity_index when bins were added or dropped outside it.
+		auto sync_capacity_index() -> void;
+
+		// Also refreshes the entries of open bins changed since they were
+		// indexed. It looks at each of them, so only entry points call it.
+		auto refresh_capacity_index() -> void;
+
+		auto index_capacity(std::size_t bin) -> void;
+
+		auto sync_tag_index() -> void;
+
+		auto sync_stream_states() -> void;
+
+		auto observe_placement(std::size_t bin, double area) -> void;
+
+		// Catches the stream states up after a batch replaced or appended
+		// bins wholesale, and marks the ones that are now full for closing.
+		auto observe_bins() -> void;
+
+		[[nodiscard]] auto must_close(std::size_t bin) const noexcept -> bool;
+
+		auto close_bins() -> void;
+
+		[[nodiscard]] auto bin_serial(std::size_t bin) const noexcept -> std::size_t;
+
+		template<typename Item>
+		[[nodiscard]] auto can_fit_in_bin(const Item& rect) const noexcept -> bool;
 
-		[[nodiscard]] auto can_fit_in_bin(const RectType& rect) const noexcept -> bool;
+		template<typename Item>
+		[[nodiscard]] auto sort_rects(std::span<const Item> rects) const -> std::pmr::vector<std::size_t>;
 
-		auto sort_rects(std::vector<RectType>& rects) const -> void;
+		[[nodiscard]] auto make_bin(TagKey tag = {}) -> std::unique_ptr<AbstractBin<RectType, Numeric>>;
 	};
 
 }
@@ -2,7 +2,8 @@
 
 namespace MaxRects {	
 	template<typename RectType, typename Numeric>
-	OversizedElementBin<RectType, Numeric>::OversizedElementBin(const RectType& rect) {
+	OversizedElementBin<RectType, Numeric>::OversizedElementBin(const RectType& rect, std::pmr::memory_resource* resource)
+		: AbstractBin<RectType, Numeric>{Numeric{}, Numeric{}, PackingOptions<Numeric>{}, resource} {
 		this->width = rect.w;
 		this->height = rect.h;
 		this->max_width = rect.w;
@@ -15,7 +16,8 @@ namespace MaxRects {
 	}
 
 	template<typename RectType, typename Numeric>
-	OversizedElementBin<RectType, Numeric>::OversizedElementBin(RectType&& rect) {
+	OversizedElementBin<RectType, Numeric>::OversizedElementBin(RectType&& rect, std::pmr::memory_resource* resource)
+		: AbstractBin<RectType, Numeric>{Numeric{}, Numeric{}, PackingOptions<Numeric>{}, resource} {
 		this->width = rect.w;
 		this->height = rect.h;
 		this->max_width = rect.w;
@@ -27,7 +29,9 @@ namespace MaxRects {
 	}
 
 	template<typename RectType, typename Numeric>
-	OversizedElementBin<RectType, Numeric>::OversizedElementBin(Numeric width, Numeric height, std::any data) {
+	OversizedElementBin<RectType, Numeric>::OversizedElementBin(Numeric width, Numeric height, std::any data,
+																std::pmr::memory_resource* resource)
+		: AbstractBin<RectType, Numeric>{Numeric{}, Numeric{}, PackingOptions<Numeric>{}, resource} {
 		this->width = width;
 		this->height = height;
 		this->max_width = width;
@@ -56,6 +60,11 @@ namespace MaxRects {
 		return nullptr;
 	}
 
+	template<typename RectType, typename Numeric>
+	auto OversizedElementBin<RectType, Numeric>::capacity() const noexcept -> BinCapacity<Numeric> {
+		return BinCapacity<Numeric>{};
+	}
+
 	template<typename RectType, typename Numeric>
 	auto OversizedElementBin<RectType, Numeric>::add(Numeric width, Numeric height, std::any data) -> RectType* {
 		
@@ -66,16 +75,44 @@ namespace MaxRects {
 	}
 
 	template<typename RectType, typename Numeric>
-	auto OversizedElementBin<RectType, Numeric>::repack() -> std::vector<RectType> {
-		return std::vector<RectType>{};
+	auto OversizedElementBin<RectType, Numeric>::repack() -> std::pmr::vector<RectType> {
+		return std::pmr::vector<RectType>{this->memory_resource};
 	}
 
 	template<typename RectType, typename Numeric>
-	auto OversizedElementBin<RectType, Numeric>::clone() const -> std::unique_ptr<AbstractBin<RectType, Numeric>> {
+	auto OversizedElementBin<RectType, Numeric>::clone(std::pmr::memory_resource* resource) const -> std::unique_ptr<AbstractBin<RectType, Numeric>> {
 		if (!this->rects.empty()) {
-			return std::make_unique<OversizedElementBin<RectType, Numeric>>(this->rects[0]);
+			auto cloned = std::unique_ptr<OversizedElementBin<RectType, Numeric>>(
+				new (resource) OversizedElementBin<RectType, Numeric>(this->rects[0], resource));
+			cloned->rect_slots = this->rect_slots;
+			cloned->tag = this->tag;
+			return cloned;
+		}
+		return std::unique_ptr<OversizedElementBin<RectType, Numeric>>(
+			new (resource) OversizedElementBin<RectType, Numeric>(this->width, this->height, std::any{}, resource));
+	}
+
+	template<typename RectType, typename Numeric>
+	auto OversizedElementBin<RectType, Numeric>::save(SnapshotWriter& writer, const SnapshotPayloadWriter<RectType>& payload) const -> bool {
+		this->save_common(writer, SnapshotBin<Numeric>{SnapshotBinKind::Oversized}, payload);
+		writer.add(std::span<const Numeric>{});
+		writer.add(std::span<const Numeric>{});
+		writer.add(std::span<const Numeric>{});
+		writer.add(std::span<const Numeric>{});
+		writer.add(std::span<const std::uint32_t>{});
+		writer.add(std::span<const Numeric>{});
+		writer.add(std::span<const Numeric>{});
+		return true;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto OversizedElementBin<RectType, Numeric>::restore(const SnapshotReader& reader, std::size_t first_section,
+														const SnapshotPayloadReader<RectType>& payload) -> bool {
+		if (!this->can_restore_common(reader, first_section, SnapshotBinKind::Oversized)) {
+			return false;
 		}
-		return std::make_unique<OversizedElementBin<RectType, Numeric>>(this->width, this->height);
+		this->restore_common(reader, first_section, payload);
+		return true;
 	}
 
 	template<typename RectType, typename Numeric>
@@ -98,4 +135,8 @@ namespace MaxRects {
 
 	template class OversizedElementBin<Rectangle<int>, int>;
 
+	template class OversizedElementBin<CompactRect<std::int16_t>, int>;
+
+	template class OversizedElementBin<CompactRect<std::int32_t>, int>;
+
 }
@@ -6,11 +6,14 @@ namespace MaxRects {
 
 	template<typename RectType = Rectangle<float>, typename Numeric = float>
 	class OversizedElementBin : public AbstractBin<RectType, Numeric> {
-	public:		explicit OversizedElementBin(const RectType& rect);
+	public:		explicit OversizedElementBin(const RectType& rect,
+									std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 		
-		explicit OversizedElementBin(RectType&& rect);
+		explicit OversizedElementBin(RectType&& rect,
+									std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
-		explicit OversizedElementBin(Numeric width, Numeric height, std::any data = {});
+		explicit OversizedElementBin(Numeric width, Numeric height, std::any data = {},
+									std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
 		auto add(const RectType&) -> RectType* override;
 		
@@ -18,9 +21,18 @@ namespace MaxRects {
 		
 		auto add(Numeric width, Numeric height, std::any data) -> RectType*;
 
-		auto repack() -> std::vector<RectType> override;
+		[[nodiscard]] auto capacity() const noexcept -> BinCapacity<Numeric> override;
 
-		auto clone() const -> std::unique_ptr<AbstractBin<RectType, Numeric>> override;
+		auto repack() -> std::pmr::vector<RectType> override;
+
+		using AbstractBin<RectType, Numeric>::clone;
+
+		auto clone(std::pmr::memory_resource* resource) const -> std::unique_ptr<AbstractBin<RectType, Numeric>> override;
+
+		auto save(SnapshotWriter& writer, const SnapshotPayloadWriter<RectType>& payload = {}) const -> bool override;
+
+		auto restore(const SnapshotReader& reader, std::size_t first_section,
+					const SnapshotPayloadReader<RectType>& payload = {}) -> bool override;
 		
 		auto reset() -> void override;
 
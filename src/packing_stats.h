@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace MaxRects {
+
+#if defined(MAXRECTS_ENABLE_STATS)
+	inline constexpr bool stats_enabled = true;
+#else
+	inline constexpr bool stats_enabled = false;
+#endif
+
+	struct PackingStats {
+		std::uint64_t inserts{};
+		std::uint64_t free_rects_scanned{};
+		std::uint64_t rotation_retries{};
+		std::uint64_t splits{};
+		// Containment tests made while pruning; a grid lookup counts as one.
+		std::uint64_t prune_pairs{};
+		std::uint64_t peak_free_rects{};
+		std::uint64_t bins_probed{};
+
+		auto merge(const PackingStats& other) noexcept -> void {
+			inserts += other.inserts;
+			free_rects_scanned += other.free_rects_scanned;
+			rotation_retries += other.rotation_retries;
+			splits += other.splits;
+			prune_pairs += other.prune_pairs;
+			peak_free_rects = std::max(peak_free_rects, other.peak_free_rects);
+			bins_probed += other.bins_probed;
+		}
+	};
+
+	// Counters are only kept when the library is built with
+	// MAXRECTS_ENABLE_STATS; otherwise every call is an empty inline function
+	// and the member takes no space.
+	template<bool Enabled = stats_enabled>
+	class StatsRecorder {
+	public:
+		auto count_insert() noexcept -> void { ++values.inserts; }
+
+		auto count_scan(std::size_t free_rects) noexcept -> void { values.free_rects_scanned += free_rects; }
+
+		auto count_rotation_retry() noexcept -> void { ++values.rotation_retries; }
+
+		auto count_splits(std::size_t pieces) noexcept -> void { values.splits += pieces; }
+
+		auto count_prune_pairs(std::size_t pairs) noexcept -> void { values.prune_pairs += pairs; }
+
+		auto observe_free_rects(std::size_t free_rects) noexcept -> void {
+			values.peak_free_rects = std::max(values.peak_free_rects, std::uint64_t{free_rects});
+		}
+
+		auto count_bins_probed(std::size_t bins) noexcept -> void { values.bins_probed += bins; }
+
+		auto merge(const PackingStats& other) noexcept -> void { values.merge(other); }
+
+		auto reset() noexcept -> void { values = PackingStats{}; }
+
+		[[nodiscard]] auto snapshot() const noexcept -> PackingStats { return values; }
+
+	private:
+		PackingStats values{};
+	};
+
+	template<>
+	class StatsRecorder<false> {
+	public:
+		auto count_insert() noexcept -> void {}
+
+		auto count_scan(std::size_t) noexcept -> void {}
+
+		auto count_rotation_retry() noexcept -> void {}
+
+		auto count_splits(std::size_t) noexcept -> void {}
+
+		auto count_prune_pairs(std::size_t) noexcept -> void {}
+
+		auto observe_free_rects(std::size_t) noexcept -> void {}
+
+		auto count_bins_probed(std::size_t) noexcept -> void {}
+
+		auto merge(const PackingStats&) noexcept -> void {}
+
+		auto reset() noexcept -> void {}
+
+		[[nodiscard]] auto snapshot() const noexcept -> PackingStats { return PackingStats{}; }
+	};
+
+}
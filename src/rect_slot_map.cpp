@@ -0,0 +1,112 @@
+#include "rect_slot_map.h"
+
+namespace MaxRects {
+
+	RectSlotMap::RectSlotMap(std::pmr::memory_resource* resource)
+		: slots{resource}, free_slots{resource} {
+	}
+
+	auto RectSlotMap::size() const noexcept -> std::size_t {
+		return live_count;
+	}
+
+	auto RectSlotMap::clear() noexcept -> void {
+		free_slots.clear();
+		for (auto slot = slots.size(); slot > std::size_t{0}; --slot) {
+			auto& entry = slots[slot - std::size_t{1}];
+			if (entry.live) {
+				entry.live = false;
+				++entry.generation;
+			}
+			free_slots.push_back(static_cast<std::uint32_t>(slot - std::size_t{1}));
+		}
+		live_count = std::size_t{0};
+	}
+
+	auto RectSlotMap::allocate() -> std::uint32_t {
+		auto slot = std::uint32_t{};
+		if (free_slots.empty()) {
+			slot = static_cast<std::uint32_t>(slots.size());
+			slots.emplace_back();
+		} else {
+			slot = free_slots.back();
+			free_slots.pop_back();
+		}
+		slots[slot].live = true;
+		++live_count;
+		return slot;
+	}
+
+	auto RectSlotMap::release(std::uint32_t slot) noexcept -> void {
+		if (slot >= slots.size() || !slots[slot].live) {
+			return;
+		}
+		slots[slot].live = false;
+		++slots[slot].generation;
+		free_slots.push_back(slot);
+		--live_count;
+	}
+
+	auto RectSlotMap::place(std::uint32_t slot, std::size_t bin, std::size_t index) noexcept -> void {
+		if (slot < slots.size()) {
+			slots[slot].location = RectLocation{bin, index};
+		}
+	}
+
+	auto RectSlotMap::handle(std::uint32_t slot) const noexcept -> RectHandle {
+		if (slot >= slots.size() || !slots[slot].live) {
+			return RectHandle{};
+		}
+		return RectHandle{slot, slots[slot].generation};
+	}
+
+	auto RectSlotMap::save(SnapshotWriter& writer) const -> void {
+		auto states = std::pmr::vector<SnapshotSlot>{slots.get_allocator()};
+		states.reserve(slots.size());
+		for (const auto& slot : slots) {
+			states.push_back(SnapshotSlot{slot.generation, slot.live ? 1u : 0u});
+		}
+		writer.add(std::span<const SnapshotSlot>{states});
+		writer.add(std::span<const std::uint32_t>{free_slots});
+	}
+
+	auto RectSlotMap::restore(const SnapshotReader& reader, std::size_t first_section) -> bool {
+		const auto states = reader.section<SnapshotSlot>(first_section);
+		const auto free = reader.section<std::uint32_t>(first_section + 1);
+		auto live = std::size_t{0};
+		for (const auto& state : states) {
+			live += state.live != 0 ? 1 : 0;
+		}
+		if (free.size() != states.size() - live) {
+			return false;
+		}
+		auto listed = std::pmr::vector<std::uint8_t>(states.size(), std::uint8_t{0}, slots.get_allocator());
+		for (auto slot : free) {
+			if (slot >= states.size() || states[slot].live != 0 || listed[slot] != 0) {
+				return false;
+			}
+			listed[slot] = std::uint8_t{1};
+		}
+		
+		slots.clear();
+		slots.reserve(states.size());
+		for (const auto& state : states) {
+			slots.push_back(Slot{RectLocation{}, state.generation, state.live != 0});
+		}
+		free_slots.assign(free.begin(), free.end());
+		live_count = live;
+		return true;
+	}
+
+	auto RectSlotMap::find(const RectHandle& handle) const noexcept -> const RectLocation* {
+		if (handle.slot >= slots.size()) {
+			return nullptr;
+		}
+		const auto& entry = slots[handle.slot];
+		if (!entry.live || entry.generation != handle.generation) {
+			return nullptr;
+		}
+		return &entry.location;
+	}
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "snapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <vector>
+
+namespace MaxRects {
+
+	constexpr auto no_rect_slot = std::numeric_limits<std::uint32_t>::max();
+
+	// Stable reference to a packed rect. It stays valid across later inserts
+	// and repacks and goes stale once the rect leaves the packer.
+	struct RectHandle {
+		std::uint32_t slot{no_rect_slot};
+		std::uint32_t generation{};
+
+		[[nodiscard]] constexpr auto valid() const noexcept -> bool {
+			return slot != no_rect_slot;
+		}
+
+		[[nodiscard]] constexpr auto operator==(const RectHandle& other) const noexcept -> bool = default;
+	};
+
+	struct RectLocation {
+		std::size_t bin{};
+		std::size_t index{};
+	};
+
+	// Slot map from handles to (bin, index) locations. Released slots are
+	// reused with a bumped generation so old handles fail the lookup.
+	class RectSlotMap {
+	public:
+		RectSlotMap() = default;
+
+		explicit RectSlotMap(std::pmr::memory_resource* resource);
+
+		[[nodiscard]] auto size() const noexcept -> std::size_t;
+
+		auto clear() noexcept -> void;
+
+		auto allocate() -> std::uint32_t;
+
+		auto release(std::uint32_t slot) noexcept -> void;
+
+		auto place(std::uint32_t slot, std::size_t bin, std::size_t index) noexcept -> void;
+
+		[[nodiscard]] auto handle(std::uint32_t slot) const noexcept -> RectHandle;
+
+		[[nodiscard]] auto find(const RectHandle& handle) const noexcept -> const RectLocation*;
+
+		// Writes the generations and the free order as two sections, so old
+		// handles resolve again after a restore. Locations are not saved; the
+		// owner places every live slot again.
+		auto save(SnapshotWriter& writer) const -> void;
+
+		auto restore(const SnapshotReader& reader, std::size_t first_section) -> bool;
+
+	private:
+		struct Slot {
+			RectLocation location{};
+			std::uint32_t generation{};
+			bool live{false};
+		};
+
+		std::pmr::vector<Slot> slots{};
+		std::pmr::vector<std::uint32_t> free_slots{};
+		std::size_t live_count{};
+	};
+
+}
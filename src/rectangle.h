@@ -1,5 +1,6 @@
 #pragma once
 
+#include "tag_key.h"
 #include <cstddef>
 #include <any>
 #include <type_traits>
@@ -18,6 +19,7 @@ namespace MaxRects {
 		Numeric x{Numeric{}};
 		Numeric y{Numeric{}};
 		std::any data{};   
+		TagKey tag{};
 		std::size_t dirty_counter{std::size_t{0}};
 
 		struct {
@@ -0,0 +1,376 @@
+#include "skyline_bin.h"
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+
+namespace MaxRects {
+
+	template<typename RectType, typename Numeric>
+	SkylineBin<RectType, Numeric>::SkylineBin(Numeric max_w, Numeric max_h, Numeric padding, const PackingOptions<Numeric>& opts,
+											std::pmr::memory_resource* resource)
+		: AbstractBin<RectType, Numeric>{max_w, max_h, opts, resource}, border{opts.border}, skyline{resource},
+		padding{padding} {
+		this->width = this->options.smart ? Numeric{} : max_w;
+		this->height = this->options.smart ? Numeric{} : max_h;
+		right = this->max_width + padding - border;
+		ceiling = this->max_height + padding - border;
+		reset_skyline();
+	}
+
+	template<typename RectType, typename Numeric>
+	auto SkylineBin<RectType, Numeric>::add(const RectType& rect) -> RectType* {
+		const auto fit = find_fit(rect);
+		if (!fit.found) {
+			return nullptr;
+		}
+		return commit_fit(rect, fit);
+	}
+
+	template<typename RectType, typename Numeric>
+	auto SkylineBin<RectType, Numeric>::add(RectType&& rect) -> RectType* {
+		const auto fit = find_fit(rect);
+		if (!fit.found) {
+			return nullptr;
+		}
+		return commit_fit(std::move(rect), fit);
+	}
+
+	template<typename RectType, typename Numeric>
+	auto SkylineBin<RectType, Numeric>::find_fit(Numeric w, Numeric h) const -> BinFit<Numeric> {
+		auto best = BinFit<Numeric>{};
+		if (w <= Numeric{} || h <= Numeric{}) {
+			return best;
+		}
+		stats_recorder.count_scan(skyline.size());
+		scan_fits(w, h, false, best);
+		if (this->options.allow_rotation && w != h) {
+			stats_recorder.count_rotation_retry();
+			stats_recorder.count_scan(skyline.size());
+			scan_fits(h, w, true, best);
+		}
+		return best;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto SkylineBin<RectType, Numeric>::scan_fits(Numeric w, Numeric h, bool rotated, BinFit<Numeric>& best) const -> void {
+		const auto count = skyline.size();
+		// covered_before[k] is the area under segments 0..k-1.
+		auto covered_before = std::pmr::vector<Numeric>(count + 1, Numeric{}, this->memory_resource);
+		for (auto k = std::size_t{0}; k < count; ++k) {
+			covered_before[k + 1] = covered_before[k] + skyline[k].y * skyline[k].w;
+		}
+		// Window indices with strictly falling heights; the front is the highest.
+		auto highest = std::pmr::vector<std::size_t>(count, std::size_t{0}, this->memory_resource);
+		auto head = std::size_t{0};
+		auto tail = std::size_t{0};
+		auto entered = std::size_t{0};
+
+		for (auto index = std::size_t{0}; index < count; ++index) {
+			const auto x = skyline[index].x;
+			const auto end = x + w;
+			if (end > right) {
+				return;
+			}
+			while (head < tail && highest[head] < index) {
+				++head;
+			}
+			while (entered <= index || skyline[entered - 1].x + skyline[entered - 1].w < end) {
+				if (entered == count) {
+					return;
+				}
+				while (head < tail && skyline[highest[tail - 1]].y <= skyline[entered].y) {
+					--tail;
+				}
+				highest[tail++] = entered++;
+			}
+
+			const auto y = skyline[highest[head]].y;
+			if (y + h > ceiling) {
+				continue;
+			}
+			// Waste under the rect is y * w minus the area the segments cover;
+			// the last one may reach past the rect.
+			const auto last = entered - 1;
+			const auto covered_area = covered_before[last] - covered_before[index] + skyline[last].y * (end - skyline[last].x);
+
+			auto fit = BinFit<Numeric>{};
+			fit.x = x;
+			fit.y = y;
+			fit.w = w;
+			fit.h = h;
+			fit.rotated = rotated;
+			fit.found = true;
+			if (this->options.skyline == SkylineHeuristic::MinWaste) {
+				fit.primary = y * w - covered_area;
+				fit.secondary = y + h;
+			} else {
+				fit.primary = y + h;
+				fit.secondary = skyline[index].w;
+			}
+			if (fit.better_than(best)) {
+				best = fit;
+			}
+		}
+	}
+
+	template<typename RectType, typename Numeric>
+	auto SkylineBin<RectType, Numeric>::commit_fit(RectType rect, const BinFit<Numeric>& fit) -> RectType* {
+		if (!reserve_fit(fit)) {
+			return nullptr;
+		}
+
+		rect.x = fit.x;
+		rect.y = fit.y;
+		rect.rot = fit.rotated;
+		if (fit.rotated) {
+			std::swap(rect.w, rect.h);
+		}
+
+		this->rects.push_back(std::move(rect));
+		this->set_dirty(true);
+		return &this->rects.back();
+	}
+
+	template<typename RectType, typename Numeric>
+	auto SkylineBin<RectType, Numeric>::reserve_fit(const BinFit<Numeric>& fit) -> bool {
+		const auto at = std::lower_bound(skyline.begin(), skyline.end(), fit.x,
+			[](const Segment& segment, Numeric x) { return segment.x < x; });
+		if (!fit.found || at == skyline.end() || at->x != fit.x) {
+			return false;
+		}
+		stats_recorder.count_insert();
+
+		const auto index = static_cast<std::size_t>(at - skyline.begin());
+		const auto end = fit.x + fit.w;
+		skyline.insert(skyline.begin() + static_cast<std::ptrdiff_t>(index), Segment{fit.x, fit.y + fit.h, fit.w});
+
+		auto next = index + 1;
+		while (next < skyline.size() && skyline[next].x < end) {
+			const auto overlap = end - skyline[next].x;
+			if (overlap < skyline[next].w) {
+				skyline[next].x += overlap;
+				skyline[next].w -= overlap;
+				break;
+			}
+			skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(next));
+		}
+
+		const auto first = index > 0 ? index - 1 : index;
+		for (auto i = first; i + 1 < skyline.size() && i <= index + 1;) {
+			if (skyline[i].y == skyline[i + 1].y) {
+				skyline[i].w += skyline[i + 1].w;
+				skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(i + 1));
+			} else {
+				++i;
+			}
+		}
+		stats_recorder.observe_free_rects(skyline.size());
+		refresh_capacity();
+
+		if (this->options.smart) {
+			extent_x = std::max(extent_x, end);
+			extent_y = std::max(extent_y, fit.y + fit.h);
+			this->apply_extents(extent_x, extent_y);
+		}
+		return true;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto SkylineBin<RectType, Numeric>::occupy(const Rectangle<Numeric>& region) -> void {
+		const auto end = region.x + region.w;
+		const auto top = region.y + region.h;
+		auto raised = std::pmr::vector<Segment>{skyline.get_allocator()};
+		raised.reserve(skyline.size() + 2);
+		for (const auto& segment : skyline) {
+			const auto segment_end = segment.x + segment.w;
+			if (segment_end <= region.x || segment.x >= end || segment.y >= top) {
+				raised.push_back(segment);
+				continue;
+			}
+			if (segment.x < region.x) {
+				raised.push_back(Segment{segment.x, segment.y, region.x - segment.x});
+			}
+			const auto from = std::max(segment.x, region.x);
+			raised.push_back(Segment{from, top, std::min(segment_end, end) - from});
+			if (segment_end > end) {
+				raised.push_back(Segment{end, segment.y, segment_end - end});
+			}
+		}
+		skyline.clear();
+		for (const auto& segment : raised) {
+			if (!skyline.empty() && skyline.back().y == segment.y) {
+				skyline.back().w += segment.w;
+			} else {
+				skyline.push_back(segment);
+			}
+		}
+		refresh_capacity();
+
+		if (this->options.smart) {
+			extent_x = std::max(extent_x, end);
+			extent_y = std::max(extent_y, top);
+			this->apply_extents(extent_x, extent_y);
+		}
+	}
+
+	template<typename RectType, typename Numeric>
+	auto SkylineBin<RectType, Numeric>::remove(std::size_t index) -> bool {
+		if (!AbstractBin<RectType, Numeric>::remove(index)) {
+			return false;
+		}
+		this->set_dirty(true);
+		return true;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto SkylineBin<RectType, Numeric>::capacity() const noexcept -> BinCapacity<Numeric> {
+		return free_capacity;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto SkylineBin<RectType, Numeric>::stats() const noexcept -> PackingStats {
+		return stats_recorder.snapshot();
+	}
+
+	template<typename RectType, typename Numeric>
+	auto SkylineBin<RectType, Numeric>::segments() const noexcept -> std::span<const Segment> {
+		return skyline;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto SkylineBin<RectType, Numeric>::repack() -> std::pmr::vector<RectType> {
+		auto unpacked = std::pmr::vector<RectType>{this->memory_resource};
+		this->rect_slots.resize(this->rects.size(), no_rect_slot);
+		this->unpacked_slots.clear();
+		reset_skyline();
+		for (const auto& region : this->reserved) {
+			occupy(region);
+		}
+
+		auto indices = std::pmr::vector<std::size_t>(this->rects.size(), this->memory_resource);
+		std::iota(indices.begin(), indices.end(), std::size_t{0});
+		std::sort(indices.begin(), indices.end(), [this](auto a, auto b) {
+			const auto max_a = std::max(this->rects[a].w, this->rects[a].h);
+			const auto max_b = std::max(this->rects[b].w, this->rects[b].h);
+			return max_b < max_a || (max_b == max_a && a < b);
+		});
+		auto kept = std::pmr::vector<std::uint8_t>(this->rects.size(), std::uint8_t{1}, this->memory_resource);
+		for (auto idx : indices) {
+			auto& rect = this->rects[idx];
+			const auto fit = find_fit(rect.w, rect.h);
+			if (!fit.found || !reserve_fit(fit)) {
+				unpacked.push_back(rect);
+				this->unpacked_slots.push_back(this->rect_slots[idx]);
+				kept[idx] = std::uint8_t{0};
+				continue;
+			}
+			rect.x = fit.x;
+			rect.y = fit.y;
+			if (fit.rotated) {
+				std::swap(rect.w, rect.h);
+				rect.rot = !rect.rot;
+			}
+		}
+
+		if (!unpacked.empty()) {
+			auto count = std::size_t{0};
+			for (auto i = std::size_t{0}; i < this->rects.size(); ++i) {
+				if (kept[i]) {
+					if (count != i) {
+						this->rects[count] = std::move(this->rects[i]);
+						this->rect_slots[count] = this->rect_slots[i];
+					}
+					++count;
+				}
+			}
+			this->rects.resize(count);
+			this->rect_slots.resize(count);
+		}
+		this->set_dirty(false);
+		return unpacked;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto SkylineBin<RectType, Numeric>::clone(std::pmr::memory_resource* resource) const -> std::unique_ptr<AbstractBin<RectType, Numeric>> {
+		auto cloned = std::unique_ptr<SkylineBin<RectType, Numeric>>(new (resource) SkylineBin<RectType, Numeric>(
+			this->max_width, this->max_height, padding, this->options, resource));
+
+		cloned->width = this->width;
+		cloned->height = this->height;
+		cloned->extent_x = extent_x;
+		cloned->extent_y = extent_y;
+		cloned->skyline = skyline;
+		cloned->free_capacity = free_capacity;
+		cloned->stats_recorder = stats_recorder;
+		cloned->rects = this->rects;
+		cloned->rect_slots = this->rect_slots;
+		cloned->reserved = this->reserved;
+		cloned->tag = this->tag;
+
+		return cloned;
+	}
+
+	template<typename RectType, typename Numeric>
+	auto SkylineBin<RectType, Numeric>::reset() -> void {
+		AbstractBin<RectType, Numeric>::reset();
+		this->width = this->options.smart ? Numeric{} : this->max_width;
+		this->height = this->options.smart ? Numeric{} : this->max_height;
+		reset_skyline();
+	}
+
+	template<typename RectType, typename Numeric>
+	auto SkylineBin<RectType, Numeric>::calculate_max_dimensions() -> void {
+		extent_x = Numeric{};
+		extent_y = Numeric{};
+
+		if (this->rects.empty() && this->reserved.empty()) {
+			this->width = this->options.smart ? Numeric{} : this->max_width;
+			this->height = this->options.smart ? Numeric{} : this->max_height;
+			return;
+		}
+
+		std::tie(extent_x, extent_y) = this->content_extents();
+
+		this->apply_extents(extent_x, extent_y);
+	}
+
+	template<typename RectType, typename Numeric>
+	auto SkylineBin<RectType, Numeric>::reset_skyline() -> void {
+		extent_x = Numeric{};
+		extent_y = Numeric{};
+		skyline.clear();
+		if (right > border && ceiling > border) {
+			skyline.push_back(Segment{border, border, right - border});
+		}
+		refresh_capacity();
+	}
+
+	template<typename RectType, typename Numeric>
+	auto SkylineBin<RectType, Numeric>::refresh_capacity() noexcept -> void {
+		free_capacity = BinCapacity<Numeric>{};
+		if (skyline.empty()) {
+			return;
+		}
+		// Anything placed sits on or above the lowest segment and within the
+		// skyline's span, which bounds what the bin can still take.
+		auto lowest = skyline.front().y;
+		for (const auto& segment : skyline) {
+			lowest = std::min(lowest, segment.y);
+		}
+		free_capacity.max_w = right - border;
+		free_capacity.max_h = ceiling - lowest;
+		free_capacity.max_area = free_capacity.max_w * free_capacity.max_h;
+	}
+
+
+	template class SkylineBin<Rectangle<float>, float>;
+
+	template class SkylineBin<Rectangle<double>, double>;
+
+	template class SkylineBin<Rectangle<int>, int>;
+
+	template class SkylineBin<CompactRect<std::int16_t>, int>;
+
+	template class SkylineBin<CompactRect<std::int32_t>, int>;
+
+}
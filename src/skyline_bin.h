@@ -0,0 +1,85 @@
+#pragma once
+
+#include "abstract_bin.h"
+#include <span>
+
+namespace MaxRects {
+
+	// Bin that only tracks the top edge of the packed area, as horizontal
+	// segments sorted by x. Inserts cost O(segments) and never fragment a free
+	// list, at the price of the space left under overhanging rects.
+	template<typename RectType = Rectangle<float>, typename Numeric = float>
+	class SkylineBin : public AbstractBin<RectType, Numeric> {
+	public:
+		struct Segment {
+			Numeric x{Numeric{}};
+			Numeric y{Numeric{}};
+			Numeric w{Numeric{}};
+		};
+
+		Numeric border{Numeric{}};
+
+		explicit SkylineBin(Numeric max_w, Numeric max_h, Numeric padding = Numeric{},
+							const PackingOptions<Numeric>& opts = {},
+							std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+		auto add(const RectType& rect) -> RectType* override;
+
+		auto add(RectType&& rect) -> RectType* override;
+
+		using AbstractBin<RectType, Numeric>::find_fit;
+
+		[[nodiscard]] auto find_fit(Numeric w, Numeric h) const -> BinFit<Numeric> override;
+
+		auto commit_fit(RectType rect, const BinFit<Numeric>& fit) -> RectType* override;
+
+		auto reserve_fit(const BinFit<Numeric>& fit) -> bool override;
+
+		using AbstractBin<RectType, Numeric>::remove;
+
+		// The space under a skyline cannot be handed back in place, so removal
+		// marks the bin dirty and the next repack() reclaims it.
+		auto remove(std::size_t index) -> bool override;
+
+		[[nodiscard]] auto capacity() const noexcept -> BinCapacity<Numeric> override;
+
+		[[nodiscard]] auto stats() const noexcept -> PackingStats override;
+
+		[[nodiscard]] auto segments() const noexcept -> std::span<const Segment>;
+
+		auto repack() -> std::pmr::vector<RectType> override;
+
+		using AbstractBin<RectType, Numeric>::clone;
+
+		auto clone(std::pmr::memory_resource* resource) const -> std::unique_ptr<AbstractBin<RectType, Numeric>> override;
+
+		auto reset() -> void override;
+
+	protected:
+		std::pmr::vector<Segment> skyline{};
+		Numeric padding{Numeric{}};
+		Numeric right{Numeric{}};
+		Numeric ceiling{Numeric{}};
+		Numeric extent_x{Numeric{}};
+		Numeric extent_y{Numeric{}};
+		BinCapacity<Numeric> free_capacity{};
+		[[no_unique_address]] mutable StatsRecorder<> stats_recorder{};
+
+		auto calculate_max_dimensions() -> void override;
+
+		// Scores w by h at every segment start in one pass and keeps the best
+		// in best. The segments under the rect form a window that only slides
+		// right, so a monotonic deque gives its resting height and prefix sums
+		// the area it covers.
+		auto scan_fits(Numeric w, Numeric h, bool rotated, BinFit<Numeric>& best) const -> void;
+
+		auto reset_skyline() -> void;
+
+		// Raises the skyline over region, for a reserved region replayed into
+		// a fresh skyline; the space left under it is lost until a reset.
+		auto occupy(const Rectangle<Numeric>& region) -> void;
+
+		auto refresh_capacity() noexcept -> void;
+	};
+
+}
@@ -0,0 +1,107 @@
+#include "snapshot.h"
+#include <cstring>
+#include <limits>
+
+namespace MaxRects {
+
+	namespace {
+		constexpr auto align_up(std::size_t value) noexcept -> std::size_t {
+			return (value + snapshot_alignment - 1) / snapshot_alignment * snapshot_alignment;
+		}
+
+		constexpr auto table_offset = align_up(sizeof(SnapshotHeader));
+	}
+
+	SnapshotWriter::SnapshotWriter(SnapshotFormat format, std::pmr::memory_resource* resource)
+		: format{format}, data{resource}, sections{resource} {
+	}
+
+	auto SnapshotWriter::add_bytes(std::span<const std::byte> bytes, std::size_t element_size, std::size_t count) -> void {
+		const auto offset = align_up(data.size());
+		data.resize(offset);
+		data.insert(data.end(), bytes.begin(), bytes.end());
+		sections.push_back(SnapshotSectionEntry{offset, count, element_size});
+	}
+
+	auto SnapshotWriter::section_count() const noexcept -> std::size_t {
+		return sections.size();
+	}
+
+	auto SnapshotWriter::size() const noexcept -> std::size_t {
+		return align_up(table_offset + sections.size() * sizeof(SnapshotSectionEntry)) + data.size();
+	}
+
+	auto SnapshotWriter::write(std::vector<std::byte>& out) const -> void {
+		const auto data_offset = align_up(table_offset + sections.size() * sizeof(SnapshotSectionEntry));
+		out.assign(data_offset + data.size(), std::byte{});
+
+		auto header = SnapshotHeader{};
+		header.format = format;
+		header.size = out.size();
+		header.section_count = sections.size();
+		std::memcpy(out.data(), &header, sizeof(header));
+
+		auto* table = out.data() + table_offset;
+		for (auto entry : sections) {
+			entry.offset += data_offset;
+			std::memcpy(table, &entry, sizeof(entry));
+			table += sizeof(entry);
+		}
+		if (!data.empty()) {
+			std::memcpy(out.data() + data_offset, data.data(), data.size());
+		}
+	}
+
+	SnapshotReader::SnapshotReader(std::span<const std::byte> bytes) noexcept
+		: bytes{bytes} {
+		if (bytes.size() < table_offset || reinterpret_cast<std::uintptr_t>(bytes.data()) % snapshot_alignment != 0) {
+			return;
+		}
+		std::memcpy(&header, bytes.data(), sizeof(header));
+		if (header.magic != snapshot_magic || header.byte_order != snapshot_byte_order ||
+			header.version == 0 || header.version > snapshot_version || header.size > bytes.size() ||
+			header.size < table_offset) {
+			return;
+		}
+
+		// The section table must fit inside the snapshot before any entry is read.
+		const auto available = (header.size - table_offset) / sizeof(SnapshotSectionEntry);
+		if (header.section_count > available) {
+			return;
+		}
+		sections = reinterpret_cast<const SnapshotSectionEntry*>(bytes.data() + table_offset);
+		for (auto i = std::size_t{0}; i < header.section_count; ++i) {
+			const auto& entry = sections[i];
+			if (entry.offset % snapshot_alignment != 0 || entry.offset > header.size || entry.element_size == 0 ||
+				entry.count > (header.size - entry.offset) / entry.element_size) {
+				return;
+			}
+		}
+		ok = true;
+	}
+
+	auto SnapshotReader::valid() const noexcept -> bool {
+		return ok;
+	}
+
+	auto SnapshotReader::format() const noexcept -> SnapshotFormat {
+		return header.format;
+	}
+
+	auto SnapshotReader::version() const noexcept -> std::uint32_t {
+		return header.version;
+	}
+
+	auto SnapshotReader::section_count() const noexcept -> std::size_t {
+		return ok ? static_cast<std::size_t>(header.section_count) : std::size_t{0};
+	}
+
+	auto SnapshotReader::section_bytes(std::size_t index, std::size_t element_size) const noexcept -> std::span<const std::byte> {
+		if (index >= section_count() || sections[index].element_size != element_size) {
+			return {};
+		}
+		const auto& entry = sections[index];
+		return bytes.subspan(static_cast<std::size_t>(entry.offset), static_cast<std::size_t>(entry.count * entry.element_size));
+	}
+
+}
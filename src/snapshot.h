@@ -0,0 +1,243 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace MaxRects {
+
+	constexpr std::uint32_t snapshot_magic = 0x4B50524Du;
+
+	constexpr std::uint32_t snapshot_version = 2;
+
+	constexpr std::uint32_t snapshot_byte_order = 0x01020304u;
+
+	// Every section starts on this boundary, so a snapshot read from a
+	// suitably aligned buffer (a mapped file is) can be viewed in place.
+	constexpr std::size_t snapshot_alignment = 16;
+
+	// The sections every bin writes, in order. A bin always writes all of
+	// them, empty or not, so the sections of bin i sit at a fixed index.
+	enum struct SnapshotSection : std::uint32_t {
+		Bin = 0,
+		Rects = 1,
+		Slots = 2,
+		PayloadOffsets = 3,
+		Payload = 4,
+		Reserved = 5,
+		FreeX = 6,
+		FreeY = 7,
+		FreeW = 8,
+		FreeH = 9,
+		FreeId = 10,
+		VerticalEdges = 11,
+		HorizontalEdges = 12
+	};
+
+	constexpr std::size_t snapshot_bin_sections = 13;
+
+	constexpr auto snapshot_index(std::size_t first_section, SnapshotSection section) noexcept -> std::size_t {
+		return first_section + static_cast<std::size_t>(section);
+	}
+
+	enum struct SnapshotBinKind : std::uint32_t {
+		MaxRects = 0,
+		Oversized = 1
+	};
+
+	enum struct SnapshotRectKind : std::uint32_t {
+		Rectangle = 1,
+		Compact = 2
+	};
+
+	// Which Numeric and rect type a snapshot was written with; restoring into
+	// another one is refused rather than converted, since narrower rect
+	// coordinates could not hold what was saved.
+	struct SnapshotFormat {
+		std::uint32_t numeric_kind{};
+		std::uint32_t numeric_size{};
+		SnapshotRectKind rect_kind{};
+		std::uint32_t coord_size{};
+
+		[[nodiscard]] constexpr auto operator==(const SnapshotFormat& other) const noexcept -> bool = default;
+	};
+
+	template<typename Numeric>
+	constexpr auto snapshot_format(SnapshotRectKind rect_kind, std::size_t coord_size) noexcept -> SnapshotFormat {
+		return SnapshotFormat{std::is_floating_point_v<Numeric> ? 1u : (std::is_signed_v<Numeric> ? 2u : 3u),
+			static_cast<std::uint32_t>(sizeof(Numeric)), rect_kind, static_cast<std::uint32_t>(coord_size)};
+	}
+
+	struct SnapshotHeader {
+		std::uint32_t magic{snapshot_magic};
+		std::uint32_t version{snapshot_version};
+		std::uint32_t byte_order{snapshot_byte_order};
+		std::uint32_t reserved{};
+		SnapshotFormat format{};
+		std::uint64_t size{};
+		std::uint64_t section_count{};
+	};
+
+	struct SnapshotSectionEntry {
+		std::uint64_t offset{};
+		std::uint64_t count{};
+		std::uint64_t element_size{};
+	};
+
+	template<typename Numeric>
+	struct SnapshotOptions {
+		std::uint32_t flags{};
+		std::uint8_t logic{};
+		std::uint8_t prune_mode{};
+		std::uint8_t sort{};
+		std::uint8_t bin_selection{};
+		std::uint8_t bin_algorithm{};
+		std::uint8_t skyline{};
+		std::uint8_t guillotine_split{};
+		std::uint8_t shard{};
+		std::uint64_t threads{};
+		std::uint64_t shards{};
+		Numeric border{};
+	};
+
+	template<typename Numeric>
+	struct SnapshotRect {
+		Numeric x{};
+		Numeric y{};
+		Numeric w{};
+		Numeric h{};
+		std::uint64_t tag{};
+		std::uint32_t flags{};
+		std::uint32_t index{};
+	};
+
+	constexpr std::uint32_t snapshot_rect_rotated = 1u;
+	constexpr std::uint32_t snapshot_rect_allow_rotation = 2u;
+	constexpr std::uint32_t snapshot_rect_oversized = 4u;
+
+	template<typename Numeric>
+	struct SnapshotBin {
+		SnapshotBinKind kind{};
+		std::uint32_t flags{};
+		std::uint64_t tag{};
+		Numeric width{};
+		Numeric height{};
+		Numeric max_width{};
+		Numeric max_height{};
+		Numeric extent_x{};
+		Numeric extent_y{};
+		Numeric border{};
+		Numeric stage_w{};
+		Numeric stage_h{};
+		std::uint32_t free_version{};
+		std::uint32_t next_free_id{};
+		SnapshotOptions<Numeric> options{};
+	};
+
+	constexpr std::uint32_t snapshot_bin_dirty = 1u;
+	constexpr std::uint32_t snapshot_bin_vertical_expand = 2u;
+
+	template<typename Numeric>
+	struct SnapshotPacker {
+		Numeric width{};
+		Numeric height{};
+		Numeric padding{};
+		std::uint64_t bin_count{};
+		std::uint64_t current_bin_index{};
+		std::uint64_t next_bin_serial{};
+		std::uint64_t closed_bins{};
+		SnapshotOptions<Numeric> options{};
+	};
+
+	struct SnapshotSlot {
+		std::uint32_t generation{};
+		std::uint32_t live{};
+	};
+
+	// A packer snapshot starts with its own sections, followed by every bin's.
+	enum struct SnapshotPackerSection : std::uint32_t {
+		Packer = 0,
+		BinSerials = 1,
+		Slots = 2,
+		FreeSlots = 3
+	};
+
+	constexpr std::size_t snapshot_packer_sections = 4;
+
+	// Serializes whatever a rect carries beyond its geometry, appending the
+	// bytes for one rect to out.
+	template<typename RectType>
+	using SnapshotPayloadWriter = std::function<void(const RectType& rect, std::pmr::vector<std::byte>& out)>;
+
+	template<typename RectType>
+	using SnapshotPayloadReader = std::function<void(RectType& rect, std::span<const std::byte> payload)>;
+
+	// Collects trivially copyable sections and lays them out behind a header
+	// and an offset table. Nothing is encoded: sections are copied as is, in
+	// native byte order.
+	class SnapshotWriter {
+	public:
+		explicit SnapshotWriter(SnapshotFormat format, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+		template<typename T>
+		auto add(std::span<const T> items) -> void {
+			static_assert(std::is_trivially_copyable_v<T>);
+			add_bytes(std::as_bytes(items), sizeof(T), items.size());
+		}
+
+		template<typename T>
+		auto add(const T& item) -> void {
+			add(std::span<const T>{&item, 1});
+		}
+
+		auto add_bytes(std::span<const std::byte> bytes, std::size_t element_size, std::size_t count) -> void;
+
+		[[nodiscard]] auto section_count() const noexcept -> std::size_t;
+
+		[[nodiscard]] auto size() const noexcept -> std::size_t;
+
+		auto write(std::vector<std::byte>& out) const -> void;
+
+	private:
+		SnapshotFormat format{};
+		std::pmr::vector<std::byte> data{};
+		std::pmr::vector<SnapshotSectionEntry> sections{};
+	};
+
+	// Checks the header and that every section lies inside the buffer, which
+	// takes time in the number of sections only. Sections are then handed out
+	// as spans straight into the buffer, so it may be a mapped file.
+	class SnapshotReader {
+	public:
+		explicit SnapshotReader(std::span<const std::byte> bytes) noexcept;
+
+		[[nodiscard]] auto valid() const noexcept -> bool;
+
+		[[nodiscard]] auto format() const noexcept -> SnapshotFormat;
+
+		[[nodiscard]] auto version() const noexcept -> std::uint32_t;
+
+		[[nodiscard]] auto section_count() const noexcept -> std::size_t;
+
+		// Empty when the section does not exist or holds another type.
+		template<typename T>
+		[[nodiscard]] auto section(std::size_t index) const noexcept -> std::span<const T> {
+			static_assert(std::is_trivially_copyable_v<T>);
+			const auto bytes = section_bytes(index, sizeof(T));
+			return {reinterpret_cast<const T*>(bytes.data()), bytes.size() / sizeof(T)};
+		}
+
+		[[nodiscard]] auto section_bytes(std::size_t index, std::size_t element_size) const noexcept -> std::span<const std::byte>;
+
+	private:
+		std::span<const std::byte> bytes{};
+		SnapshotHeader header{};
+		const SnapshotSectionEntry* sections{};
+		bool ok{false};
+	};
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace MaxRects {
+
+	// Cheap, hashable tag that routes rects to bins of the same tag. The zero
+	// key means untagged.
+	struct TagKey {
+		std::uint64_t value{};
+
+		[[nodiscard]] constexpr auto tagged() const noexcept -> bool {
+			return value != std::uint64_t{0};
+		}
+
+		[[nodiscard]] constexpr auto operator==(const TagKey& other) const noexcept -> bool = default;
+	};
+
+	// FNV-1a of the name, so tags can be derived from material or level names.
+	[[nodiscard]] constexpr auto make_tag(std::string_view name) noexcept -> TagKey {
+		auto hash = std::uint64_t{14695981039346656037ull};
+		for (const auto c : name) {
+			hash ^= static_cast<std::uint8_t>(c);
+			hash *= std::uint64_t{1099511628211ull};
+		}
+		return TagKey{hash == std::uint64_t{0} ? std::uint64_t{1} : hash};
+	}
+
+	struct TagKeyHash {
+		[[nodiscard]] auto operator()(const TagKey& key) const noexcept -> std::size_t {
+			auto mixed = key.value;
+			mixed ^= mixed >> 33;
+			mixed *= std::uint64_t{0xff51afd7ed558ccdull};
+			mixed ^= mixed >> 33;
+			return static_cast<std::size_t>(mixed);
+		}
+	};
+
+	// Rect types without a tag member, like CompactRect, are always untagged.
+	template<typename RectType>
+	[[nodiscard]] constexpr auto tag_of(const RectType& rect) noexcept -> TagKey {
+		if constexpr (requires { rect.tag; }) {
+			return rect.tag;
+		} else {
+			return TagKey{};
+		}
+	}
+
+}
@@ -0,0 +1,110 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+namespace MaxRects {
+
+	namespace {
+		thread_local bool inside_task = false;
+	}
+
+	ThreadPool::ThreadPool(std::size_t thread_count) {
+		if (thread_count == 0) {
+			thread_count = std::max(std::size_t{std::thread::hardware_concurrency()}, std::size_t{1});
+		}
+		workers.reserve(thread_count - 1);
+		for (auto i = std::size_t{1}; i < thread_count; ++i) {
+			workers.emplace_back([this]() { worker_loop(); });
+		}
+	}
+
+	ThreadPool::~ThreadPool() {
+		{
+			auto lock = std::lock_guard{mutex};
+			stopping = true;
+		}
+		wake.notify_all();
+		for (auto& worker : workers) {
+			worker.join();
+		}
+	}
+
+	auto ThreadPool::size() const noexcept -> std::size_t {
+		return workers.size() + 1;
+	}
+
+	auto ThreadPool::parallel_for(std::size_t count, const std::function<void(std::size_t)>& task) -> void {
+		if (count == 0) {
+			return;
+		}
+		if (workers.empty() || count == 1 || inside_task) {
+			for (auto i = std::size_t{0}; i < count; ++i) {
+				task(i);
+			}
+			return;
+		}
+
+		{
+			auto lock = std::unique_lock{mutex};
+			job = &task;
+			job_count = count;
+			next_index.store(0, std::memory_order_relaxed);
+			failure = nullptr;
+			active_workers = workers.size();
+			++generation;
+		}
+		wake.notify_all();
+
+		run_tasks(task, count);
+
+		auto lock = std::unique_lock{mutex};
+		done.wait(lock, [this]() { return active_workers == 0; });
+		job = nullptr;
+		if (failure) {
+			auto error = failure;
+			failure = nullptr;
+			std::rethrow_exception(error);
+		}
+	}
+
+	auto ThreadPool::worker_loop() -> void {
+		auto seen_generation = std::size_t{0};
+		while (true) {
+			const std::function<void(std::size_t)>* task = nullptr;
+			auto count = std::size_t{0};
+			{
+				auto lock = std::unique_lock{mutex};
+				wake.wait(lock, [&]() { return stopping || generation != seen_generation; });
+				if (stopping) {
+					return;
+				}
+				seen_generation = generation;
+				task = job;
+				count = job_count;
+			}
+
+			run_tasks(*task, count);
+
+			{
+				auto lock = std::lock_guard{mutex};
+				--active_workers;
+			}
+			done.notify_one();
+		}
+	}
+
+	auto ThreadPool::run_tasks(const std::function<void(std::size_t)>& task, std::size_t count) -> void {
+		inside_task = true;
+		for (auto i = next_index.fetch_add(1); i < count; i = next_index.fetch_add(1)) {
+			try {
+				task(i);
+			} catch (...) {
+				auto lock = std::lock_guard{mutex};
+				if (!failure) {
+					failure = std::current_exception();
+				}
+			}
+		}
+		inside_task = false;
+	}
+
+}
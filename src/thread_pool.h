@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace MaxRects {
+
+	class ThreadPool {
+	public:
+		explicit ThreadPool(std::size_t thread_count = 0);
+
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool(ThreadPool&&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+		ThreadPool& operator=(ThreadPool&&) = delete;
+
+		[[nodiscard]] auto size() const noexcept -> std::size_t;
+
+		// Runs task(i) for every i in [0, count) and returns once all calls have
+		// finished. The calling thread takes part; calls made from inside a task
+		// run inline.
+		auto parallel_for(std::size_t count, const std::function<void(std::size_t)>& task) -> void;
+
+	private:
+		std::vector<std::thread> workers{};
+		std::mutex mutex{};
+		std::condition_variable wake{};
+		std::condition_variable done{};
+		const std::function<void(std::size_t)>* job{nullptr};
+		std::size_t job_count{};
+		std::size_t generation{};
+		std::size_t active_workers{};
+		std::atomic<std::size_t> next_index{};
+		std::exception_ptr failure{};
+		bool stopping{false};
+
+		auto worker_loop() -> void;
+
+		auto run_tasks(const std::function<void(std::size_t)>& task, std::size_t count) -> void;
+	};
+
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+#include <cstddef>
+
+auto allocation_count() noexcept -> std::size_t;
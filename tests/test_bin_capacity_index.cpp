@@ -0,0 +1,47 @@
+#include "simple_test.h"
+#include "../src/bin_capacity_index.h"
+
+using namespace MaxRects;
+
+TEST("BinCapacityIndex skips bins whose bounds are too small") {
+    auto index = BinCapacityIndex<int>{};
+    index.push_back(BinCapacity<int>{10, 10, 100});
+    index.push_back(BinCapacity<int>{50, 20, 1000});
+    index.push_back(BinCapacity<int>{40, 40, 1600});
+    
+    ASSERT_EQ(index.size(), 3);
+    ASSERT_EQ(index.find_first(0, 5, 5, false), 0);
+    ASSERT_EQ(index.find_first(1, 5, 5, false), 1);
+    ASSERT_EQ(index.find_first(0, 30, 30, false), 2);
+    ASSERT_EQ(index.find_first(0, 50, 30, false), BinCapacityIndex<int>::npos);
+    ASSERT_EQ(index.find_first(3, 1, 1, false), BinCapacityIndex<int>::npos);
+}
+
+TEST("BinCapacityIndex checks both orientations when rotation is allowed") {
+    auto index = BinCapacityIndex<float>{};
+    index.push_back(BinCapacity<float>{10.0f, 60.0f, 600.0f});
+    index.push_back(BinCapacity<float>{60.0f, 10.0f, 600.0f});
+    
+    ASSERT_EQ(index.find_first(0, 50.0f, 8.0f, false), 1);
+    ASSERT_EQ(index.find_first(0, 50.0f, 8.0f, true), 0);
+    ASSERT_TRUE(index.admits(0, 50.0f, 8.0f, true));
+    ASSERT_FALSE(index.admits(0, 50.0f, 8.0f, false));
+}
+
+TEST("BinCapacityIndex reflects updated capacities after growing") {
+    auto index = BinCapacityIndex<int>{};
+    for (auto i{0}; i < 100; ++i) {
+        index.push_back(BinCapacity<int>{8, 8, 64});
+    }
+    ASSERT_EQ(index.find_first(0, 16, 16, false), BinCapacityIndex<int>::npos);
+    
+    index.assign(73, BinCapacity<int>{32, 32, 1024});
+    ASSERT_EQ(index.find_first(0, 16, 16, false), 73);
+    
+    index.assign(73, BinCapacity<int>{});
+    ASSERT_EQ(index.find_first(0, 16, 16, false), BinCapacityIndex<int>::npos);
+    
+    index.clear();
+    ASSERT_EQ(index.size(), 0);
+    ASSERT_EQ(index.find_first(0, 1, 1, false), BinCapacityIndex<int>::npos);
+}
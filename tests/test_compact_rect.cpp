@@ -0,0 +1,68 @@
+#include "simple_test.h"
+#include "../src/maxrects_packer.h"
+
+using namespace MaxRects;
+
+TEST("CompactRect stays small") {
+    ASSERT_EQ(sizeof(CompactRect<std::int16_t>), 16);
+    ASSERT_EQ(sizeof(CompactRect<std::int32_t>), 24);
+    ASSERT_TRUE(sizeof(CompactRect<std::int32_t>) < sizeof(Rectangle<int>));
+    
+    const auto rect = CompactRect<std::int16_t>{30, 40, 7};
+    ASSERT_EQ(rect.area(), 1200);
+    ASSERT_EQ(rect.index, 7);
+    ASSERT_EQ(rect.rot, 0);
+}
+
+TEST("CompactRect keeps the full 32-bit index") {
+    PackingOptions<int> opts{.pot = false, .allow_rotation = true};
+    auto packer = MaxRectsPacker<int, CompactRect<std::int16_t>>{64, 64, 0, opts};
+    const auto top = std::uint32_t{0xFFFFFFFFu};
+    const auto high_bit = std::uint32_t{0x80000000u};
+    packer.add(CompactRect<std::int16_t>{40, 20, top});
+    packer.add(CompactRect<std::int16_t>{20, 40, high_bit});
+    packer.add(CompactRect<std::int16_t>{10, 10, high_bit - 1u});
+    
+    const auto packed{packer.get_all_rects()};
+    ASSERT_EQ(packed.size(), std::size_t{3});
+    ASSERT_EQ(packed[0].index, top);
+    ASSERT_EQ(packed[1].index, high_bit);
+    ASSERT_EQ(packed[2].index, high_bit - 1u);
+    
+    auto bytes = std::vector<std::byte>{};
+    ASSERT_TRUE(packer.snapshot(bytes));
+    auto restored = MaxRectsPacker<int, CompactRect<std::int16_t>>{};
+    ASSERT_TRUE(restored.restore(bytes));
+    ASSERT_EQ(restored.get_all_rects()[0].index, top);
+    ASSERT_EQ(restored.get_all_rects()[1].index, high_bit);
+}
+
+TEST("CompactRect packs like Rectangle and keeps its index") {
+    PackingOptions<int> opts{.pot = false, .allow_rotation = true};
+    auto full = MaxRectsPacker<int, Rectangle<int>>{512, 512, 0, opts};
+    auto compact = MaxRectsPacker<int, CompactRect<std::int16_t>>{512, 512, 0, opts};
+    
+    auto full_input = std::vector<Rectangle<int>>{};
+    auto compact_input = std::vector<CompactRect<std::int16_t>>{};
+    for (auto i{0u}; i < 200u; ++i) {
+        const auto w = static_cast<int>(8 + (i * 37) % 97);
+        const auto h = static_cast<int>(8 + (i * 53) % 89);
+        full_input.emplace_back(w, h);
+        compact_input.emplace_back(w, h, i);
+    }
+    full.add_array(full_input);
+    compact.add_array(compact_input);
+    
+    ASSERT_EQ(compact.bins.size(), full.bins.size());
+    const auto expected{full.get_all_rects()};
+    const auto packed{compact.get_all_rects()};
+    ASSERT_EQ(packed.size(), expected.size());
+    for (auto i = std::size_t{0}; i < packed.size(); ++i) {
+        ASSERT_EQ(packed[i].x, expected[i].x);
+        ASSERT_EQ(packed[i].y, expected[i].y);
+        ASSERT_EQ(packed[i].w, expected[i].w);
+        ASSERT_EQ(static_cast<bool>(packed[i].rot), expected[i].rot);
+        const auto& source = compact_input[packed[i].index];
+        ASSERT_EQ(source.area(), packed[i].area());
+    }
+}
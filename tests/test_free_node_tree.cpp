@@ -0,0 +1,80 @@
+#include "simple_test.h"
+#include "../src/free_node_tree.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace MaxRects;
+
+TEST("FreeNodeTree finds the narrowest node that fits like a full scan") {
+    using Node = FreeNodeTree<int>::Node;
+    auto engine = std::mt19937{42u};
+    auto size_dist = std::uniform_int_distribution<int>{1, 64};
+    auto tree = FreeNodeTree<int>{};
+    auto nodes = std::vector<Node>{};
+    
+    for (auto step{0}; step < 2000; ++step) {
+        if (nodes.empty() || step % 3 != 0) {
+            // Distinct origins keep the keys unique, as disjoint free rects are.
+            const auto node = Node{step, step % 7, size_dist(engine), size_dist(engine)};
+            tree.insert(node);
+            nodes.push_back(node);
+        } else {
+            const auto victim = nodes[static_cast<std::size_t>(step) % nodes.size()];
+            auto it = tree.begin();
+            while (it->x != victim.x || it->y != victim.y) {
+                ++it;
+            }
+            tree.erase(it);
+            std::erase_if(nodes, [&](const Node& n) { return n.x == victim.x && n.y == victim.y; });
+        }
+        ASSERT_EQ(tree.size(), nodes.size());
+        
+        const auto w = size_dist(engine);
+        const auto h = size_dist(engine);
+        const Node* best = nullptr;
+        for (const auto& n : nodes) {
+            if (n.w >= w && n.h >= h &&
+                (best == nullptr || n.w < best->w || (n.w == best->w && (n.h < best->h ||
+                 (n.h == best->h && (n.y < best->y || (n.y == best->y && n.x < best->x))))))) {
+                best = &n;
+            }
+        }
+        auto visited = std::size_t{0};
+        const auto found = tree.find(w, h, visited);
+        if (best == nullptr) {
+            ASSERT_TRUE(found == tree.end());
+        } else {
+            ASSERT_TRUE(found != tree.end());
+            ASSERT_EQ(found->x, best->x);
+            ASSERT_EQ(found->y, best->y);
+        }
+    }
+    
+    auto max_w{0};
+    auto max_h{0};
+    auto max_area{0};
+    for (const auto& n : nodes) {
+        max_w = std::max(max_w, n.w);
+        max_h = std::max(max_h, n.h);
+        max_area = std::max(max_area, n.w * n.h);
+    }
+    ASSERT_EQ(tree.max_w(), max_w);
+    ASSERT_EQ(tree.max_h(), max_h);
+    ASSERT_EQ(tree.max_area(), max_area);
+}
+
+TEST("FreeNodeTree visits few nodes among many thin ones") {
+    auto tree = FreeNodeTree<int>{};
+    for (auto i{0}; i < 4096; ++i) {
+        tree.insert(FreeNodeTree<int>::Node{0, i, 1000 + i, 1});
+    }
+    tree.insert(FreeNodeTree<int>::Node{0, 5000, 1, 100});
+    tree.insert(FreeNodeTree<int>::Node{0, 6000, 6000, 50});
+    
+    auto visited = std::size_t{0};
+    const auto found = tree.find(10, 10, visited);
+    ASSERT_TRUE(found != tree.end());
+    ASSERT_EQ(found->w, 6000);
+    ASSERT_GT(std::size_t{200}, visited);
+}
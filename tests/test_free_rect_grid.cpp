@@ -0,0 +1,88 @@
+#include "simple_test.h"
+#include "../src/free_rect_grid.h"
+#include <algorithm>
+
+using namespace MaxRects;
+
+TEST("FreeRectGrid finds containing rectangles across cells") {
+    auto grid = FreeRectGrid<float>{};
+    grid.configure(1024.0f, 1024.0f, 8);
+    grid.insert(0, 0.0f, 0.0f, 1024.0f, 300.0f);
+    grid.insert(1, 500.0f, 100.0f, 100.0f, 100.0f);
+    grid.insert(2, 700.0f, 700.0f, 50.0f, 50.0f);
+    
+    ASSERT_TRUE(grid.is_contained(1, 500.0f, 100.0f, 100.0f, 100.0f));
+    ASSERT_FALSE(grid.is_contained(0, 0.0f, 0.0f, 1024.0f, 300.0f));
+    ASSERT_FALSE(grid.is_contained(2, 700.0f, 700.0f, 50.0f, 50.0f));
+}
+
+TEST("FreeRectGrid keeps the later of two equal rectangles") {
+    auto grid = FreeRectGrid<int>{};
+    grid.configure(256, 256, 4);
+    grid.insert(3, 10, 10, 20, 20);
+    grid.insert(7, 10, 10, 20, 20);
+    
+    ASSERT_TRUE(grid.is_contained(3, 10, 10, 20, 20));
+    ASSERT_FALSE(grid.is_contained(7, 10, 10, 20, 20));
+    
+    grid.erase(7, 10, 10, 20, 20);
+    ASSERT_FALSE(grid.is_contained(3, 10, 10, 20, 20));
+}
+
+TEST("FreeRectGrid collects touching rectangles once each") {
+    auto grid = FreeRectGrid<int>{};
+    grid.configure(256, 256, 4);
+    grid.insert(0, 0, 0, 256, 40);
+    grid.insert(1, 100, 40, 60, 60);
+    grid.insert(2, 160, 70, 30, 100);
+    grid.insert(3, 10, 200, 20, 20);
+    
+    auto ids = std::pmr::vector<std::uint32_t>{};
+    grid.collect(100, 40, 60, 60, ids);
+    std::sort(ids.begin(), ids.end());
+    ASSERT_EQ(ids.size(), std::size_t{3});
+    ASSERT_EQ(ids[0], 0u);
+    ASSERT_EQ(ids[1], 1u);
+    ASSERT_EQ(ids[2], 2u);
+    
+    ASSERT_TRUE(grid.covers(120, 50, 20, 20));
+    ASSERT_TRUE(grid.covers(10, 200, 20, 20));
+    ASSERT_FALSE(grid.covers(150, 50, 20, 20));
+    
+    grid.erase(0, 0, 0, 256, 40);
+    ids.clear();
+    grid.collect(0, 0, 256, 40, ids);
+    ASSERT_EQ(ids.size(), std::size_t{1});
+    ASSERT_EQ(ids[0], 1u);
+}
+
+TEST("FreeRectGrid fits its cells to the rect count and keeps wide rects findable") {
+    auto grid = FreeRectGrid<float>{};
+    grid.fit_to(8192.0f, 8192.0f, 100);
+    ASSERT_EQ(grid.cell_count(), free_rect_grid_min_cells * free_rect_grid_min_cells);
+    ASSERT_FALSE(grid.needs_refit(100));
+    ASSERT_TRUE(grid.needs_refit(4000));
+    
+    grid.fit_to(8192.0f, 8192.0f, 40000);
+    ASSERT_GT(grid.cell_count(), std::size_t{5000});
+    ASSERT_FALSE(grid.needs_refit(40000));
+    ASSERT_TRUE(grid.needs_refit(1000));
+    
+    grid.fit_to(8192.0f, 2048.0f, 40000);
+    ASSERT_GT(grid.cell_count(), std::size_t{5000});
+    
+    // A full-width strip spans far more cells than it is worth registering in.
+    grid.fit_to(8192.0f, 8192.0f, 40000);
+    grid.insert(1, 0.0f, 100.0f, 8192.0f, 300.0f);
+    grid.insert(2, 4000.0f, 150.0f, 20.0f, 20.0f);
+    ASSERT_TRUE(grid.is_contained(2, 4000.0f, 150.0f, 20.0f, 20.0f));
+    ASSERT_TRUE(grid.covers(10.0f, 110.0f, 8000.0f, 10.0f));
+    auto ids = std::pmr::vector<std::uint32_t>{};
+    grid.collect(4010.0f, 160.0f, 2.0f, 2.0f, ids);
+    std::sort(ids.begin(), ids.end());
+    ASSERT_EQ(ids.size(), std::size_t{2});
+    ASSERT_EQ(ids[0], 1u);
+    
+    grid.erase(1, 0.0f, 100.0f, 8192.0f, 300.0f);
+    ASSERT_FALSE(grid.is_contained(2, 4000.0f, 150.0f, 20.0f, 20.0f));
+}
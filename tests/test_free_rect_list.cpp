@@ -0,0 +1,94 @@
+#include "simple_test.h"
+#include "../src/free_rect_list.h"
+#include <random>
+
+using namespace MaxRects;
+
+template<typename Numeric>
+auto make_random_free_list(std::size_t count, unsigned seed) -> FreeRectList<Numeric> {
+    auto engine = std::mt19937{seed};
+    auto size_dist = std::uniform_int_distribution<int>{1, 64};
+    auto pos_dist = std::uniform_int_distribution<int>{0, 960};
+    auto list = FreeRectList<Numeric>{};
+    for (auto i{static_cast<std::size_t>(0)}; i < count; ++i) {
+        list.emplace_back(static_cast<Numeric>(size_dist(engine)), static_cast<Numeric>(size_dist(engine)),
+                          static_cast<Numeric>(pos_dist(engine)), static_cast<Numeric>(pos_dist(engine)));
+    }
+    return list;
+}
+
+template<typename Numeric>
+auto expect_kernel_matches_scalar() -> void {
+    for (auto count : {0, 1, 3, 7, 8, 9, 31, 257}) {
+        const auto list{make_random_free_list<Numeric>(static_cast<std::size_t>(count), 1234u + count)};
+        for (auto score : {FreeRectScore::ShortSide, FreeRectScore::LongSide, FreeRectScore::Area, FreeRectScore::BottomLeft}) {
+            for (auto size : {1, 8, 17, 40, 65}) {
+                const auto request{static_cast<Numeric>(size)};
+                const auto fast{list.find_best(request, request / 2 + 1, score)};
+                const auto scalar{list.find_best_scalar(request, request / 2 + 1, score)};
+                ASSERT_EQ(scalar.index, fast.index);
+                ASSERT_TRUE(scalar.primary == fast.primary);
+                ASSERT_TRUE(scalar.secondary == fast.secondary);
+            }
+        }
+    }
+}
+
+TEST("FreeRectList stores rectangles as separate coordinate arrays") {
+    auto list = FreeRectList<float>{};
+    list.emplace_back(10.0f, 20.0f, 1.0f, 2.0f);
+    list.push_back(Rectangle<float>{30.0f, 40.0f, 3.0f, 4.0f});
+
+    ASSERT_EQ(list.size(), 2);
+    ASSERT_FLOAT_EQ(list.w[1], 30.0f);
+    ASSERT_FLOAT_EQ(list.y[0], 2.0f);
+    ASSERT_TRUE(list[1] == (Rectangle<float>{30.0f, 40.0f, 3.0f, 4.0f}));
+
+    list.erase(0);
+    ASSERT_EQ(list.size(), 1);
+    ASSERT_FLOAT_EQ(list.x[0], 3.0f);
+}
+
+TEST("FreeRectList reports no fit when nothing is large enough") {
+    auto list = FreeRectList<int>{};
+    list.emplace_back(10, 10, 0, 0);
+
+    ASSERT_FALSE(list.find_best(11, 5, FreeRectScore::ShortSide).found());
+    ASSERT_TRUE(list.find_best(10, 10, FreeRectScore::Area).found());
+}
+
+TEST("FreeRectList prefers the earliest rectangle on equal scores") {
+    auto list = FreeRectList<float>{};
+    for (auto i{0}; i < 20; ++i) {
+        list.emplace_back(i == 13 || i == 17 ? 32.0f : 8.0f, 32.0f, static_cast<float>(i), 0.0f);
+    }
+
+    const auto fit{list.find_best(30.0f, 30.0f, FreeRectScore::ShortSide)};
+    ASSERT_EQ(fit.index, 13);
+}
+
+TEST("FreeRectList renumbers ids from zero in list order") {
+    auto list = FreeRectList<float>{};
+    for (auto i{0}; i < 5; ++i) {
+        list.emplace_back(10.0f, 10.0f, static_cast<float>(i * 10), 0.0f);
+    }
+    list.erase(1);
+    ASSERT_EQ(list.id[1], 2u);
+    
+    list.renumber();
+    ASSERT_EQ(list.next_id, 4u);
+    for (auto i = std::size_t{0}; i < list.size(); ++i) {
+        ASSERT_EQ(list.id[i], static_cast<std::uint32_t>(i));
+    }
+    ASSERT_EQ(list.lower_bound_id(2u), 2);
+    ASSERT_FLOAT_EQ(list.x[1], 20.0f);
+    
+    list.emplace_back(10.0f, 10.0f, 50.0f, 0.0f);
+    ASSERT_EQ(list.id.back(), 4u);
+}
+
+TEST("FreeRectList vector kernel matches scalar scan") {
+    expect_kernel_matches_scalar<float>();
+    expect_kernel_matches_scalar<double>();
+    expect_kernel_matches_scalar<int>();
+}
@@ -0,0 +1,91 @@
+#include "simple_test.h"
+#include "../src/guillotine_bin.h"
+#include "../src/maxrects_packer.h"
+
+using namespace MaxRects;
+
+namespace {
+    template<typename A, typename B>
+    auto overlaps(const A& a, const B& b) -> bool {
+        return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+    }
+}
+
+TEST("GuillotineBin partitions the bin into disjoint used and free rects") {
+    for (auto split : {GuillotineSplit::ShorterLeftoverAxis, GuillotineSplit::LongerLeftoverAxis,
+                       GuillotineSplit::MinArea, GuillotineSplit::MaxArea}) {
+        auto opts = PackingOptions<int>{.smart = false, .pot = false, .allow_rotation = true, .guillotine_split = split};
+        auto bin = GuillotineBin<Rectangle<int>, int>{256, 256, 0, opts};
+        
+        for (auto i{0}; i < 200; ++i) {
+            bin.add(Rectangle<int>{4 + (i * 37) % 40, 4 + (i * 53) % 30});
+        }
+        ASSERT_GT(bin.rects.size(), 40);
+        
+        auto area{0};
+        for (auto a = std::size_t{0}; a < bin.rects.size(); ++a) {
+            const auto& rect = bin.rects[a];
+            area += rect.w * rect.h;
+            ASSERT_GE(256, rect.x + rect.w);
+            ASSERT_GE(256, rect.y + rect.h);
+            for (auto b = a + 1; b < bin.rects.size(); ++b) {
+                ASSERT_FALSE(overlaps(rect, bin.rects[b]));
+            }
+            for (const auto& node : bin.free_rects()) {
+                ASSERT_FALSE(overlaps(rect, node));
+            }
+        }
+        for (auto node = bin.free_rects().begin(); node != bin.free_rects().end(); ++node) {
+            area += node->w * node->h;
+            for (auto other = std::next(node); other != bin.free_rects().end(); ++other) {
+                ASSERT_FALSE(overlaps(*node, *other));
+            }
+        }
+        ASSERT_EQ(area, 256 * 256);
+    }
+}
+
+TEST("GuillotineBin picks the narrowest free rect that fits") {
+    auto bin = GuillotineBin<Rectangle<int>, int>{100, 100, 0, PackingOptions<int>{.smart = false, .pot = false}};
+    
+    ASSERT_NE(bin.add(Rectangle<int>{70, 70}), nullptr);
+    ASSERT_EQ(bin.free_rects().size(), 2);
+    const auto* small{bin.add(Rectangle<int>{20, 20})};
+    ASSERT_NE(small, nullptr);
+    ASSERT_EQ(small->x, 70);
+    ASSERT_EQ(small->y, 0);
+    ASSERT_EQ(bin.add(Rectangle<int>{101, 1}), nullptr);
+}
+
+TEST("GuillotineBin remove merges the freed rect back") {
+    auto bin = GuillotineBin<Rectangle<int>, int>{64, 64, 0, PackingOptions<int>{.smart = false, .pot = false}};
+    ASSERT_NE(bin.add(Rectangle<int>{64, 32}), nullptr);
+    ASSERT_NE(bin.add(Rectangle<int>{64, 32}), nullptr);
+    ASSERT_TRUE(bin.free_rects().empty());
+    ASSERT_EQ(bin.capacity().max_area, 0);
+    
+    ASSERT_TRUE(bin.remove(std::size_t{0}));
+    ASSERT_TRUE(bin.remove(std::size_t{0}));
+    ASSERT_EQ(bin.free_rects().size(), 1);
+    ASSERT_EQ(bin.free_rects().begin()->w, 64);
+    ASSERT_EQ(bin.free_rects().begin()->h, 64);
+    ASSERT_NE(bin.add(Rectangle<int>{64, 64}), nullptr);
+}
+
+TEST("MaxRectsPacker creates guillotine bins when configured") {
+    auto opts = PackingOptions<float>{.pot = false, .allow_rotation = true, .bin_algorithm = BinAlgorithm::Guillotine};
+    auto packer = MaxRectsPacker<float, Rectangle<float>>{128.0f, 128.0f, 0.0f, opts};
+    auto rectangles = std::vector<Rectangle<float>>{};
+    for (auto i{0}; i < 300; ++i) {
+        rectangles.emplace_back(static_cast<float>(4 + (i * 37) % 40), static_cast<float>(4 + (i * 53) % 30));
+    }
+    packer.add_array(rectangles);
+    
+    ASSERT_GT(packer.bins.size(), 1);
+    for (const auto& bin : packer.bins) {
+        const auto* guillotine_bin{dynamic_cast<const GuillotineBin<Rectangle<float>, float>*>(bin.get())};
+        ASSERT_NE(guillotine_bin, nullptr);
+    }
+    ASSERT_EQ(packer.get_all_rects().size(), rectangles.size());
+    ASSERT_GT(packer.occupancy(), 0.5);
+}
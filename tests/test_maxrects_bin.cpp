@@ -1,4 +1,5 @@
 #include "simple_test.h"
+#include "allocation_counter.h"
 #include "../src/maxrects_bin.h"
 
 using namespace MaxRects;
@@ -156,3 +157,342 @@ TEST("MaxRectsBin pot sizing uses power of two") {
     ASSERT_TRUE(is_power_of_two(test.bin->width));
     ASSERT_TRUE(is_power_of_two(test.bin->height));
 }
+
+TEST("MaxRectsBin placement does not allocate in steady state") {
+    maxrects_bin_test test{};
+    test.setup();
+    
+    auto pack_sequence = [&test]() {
+        for (auto i{0}; i < 200; ++i) {
+            test.bin->add(static_cast<float>(8 + (i * 37) % 57), static_cast<float>(8 + (i * 53) % 41), std::any{});
+        }
+    };
+    
+    pack_sequence();
+    const auto packed_count{test.bin->rects.size()};
+    test.bin->reset(true);
+    
+    const auto before{allocation_count()};
+    pack_sequence();
+    const auto after{allocation_count()};
+    
+    ASSERT_EQ(test.bin->rects.size(), packed_count);
+    ASSERT_EQ(before, after);
+}
+
+TEST("MaxRectsBin place does not allocate in steady state") {
+    maxrects_bin_test test{};
+    test.setup();
+    
+    auto place_sequence = [&test]() {
+        auto placed{std::size_t{0}};
+        for (auto i{0}; i < 200; ++i) {
+            const auto rect = Rectangle<float>{static_cast<float>(8 + (i * 29) % 61), static_cast<float>(8 + (i * 31) % 47)};
+            if (test.bin->place(rect).has_value()) {
+                ++placed;
+            }
+        }
+        return placed;
+    };
+    
+    const auto first_pass{place_sequence()};
+    test.bin->reset(true);
+    
+    const auto before{allocation_count()};
+    const auto second_pass{place_sequence()};
+    const auto after{allocation_count()};
+    
+    ASSERT_EQ(first_pass, second_pass);
+    ASSERT_EQ(before, after);
+}
+
+TEST("MaxRectsBin prune modes produce identical layouts") {
+    auto pack_with = [](PruneMode mode) {
+        auto opts = PackingOptions<float>{};
+        opts.allow_rotation = true;
+        opts.prune_mode = mode;
+        auto bin = MaxRectsBin<Rectangle<float>, float>{512.0f, 512.0f, 0.0f, opts};
+        for (auto i{0}; i < 300; ++i) {
+            bin.add(static_cast<float>(4 + (i * 37) % 45), static_cast<float>(4 + (i * 53) % 39), std::any{});
+        }
+        auto unpacked{bin.repack()};
+        return std::make_pair(bin.rects, bin.free_rect_count());
+    };
+    
+    const auto sweep{pack_with(PruneMode::Sweep)};
+    const auto incremental{pack_with(PruneMode::Incremental)};
+    const auto grid{pack_with(PruneMode::Grid)};
+    
+    ASSERT_EQ(sweep.second, incremental.second);
+    ASSERT_EQ(sweep.second, grid.second);
+    ASSERT_TRUE(sweep.first == incremental.first);
+    ASSERT_TRUE(sweep.first == grid.first);
+}
+
+TEST("MaxRectsBin repack moves rects and shrinks extents") {
+    auto opts = PackingOptions<float>{};
+    opts.pot = false;
+    auto bin = MaxRectsBin<Rectangle<float>, float>{1024.0f, 1024.0f, 0.0f, opts};
+    
+    bin.add(300.0f, 400.0f, std::any{});
+    bin.add(100.0f, 100.0f, std::any{});
+    ASSERT_FLOAT_EQ(bin.width, 300.0f);
+    ASSERT_FLOAT_EQ(bin.height, 500.0f);
+    
+    bin.rects[0].set_width(50.0f);
+    bin.rects[0].set_height(50.0f);
+    auto unpacked{bin.repack()};
+    
+    ASSERT_EQ(unpacked.size(), 0);
+    ASSERT_FALSE(bin.rects[0].collides_with(bin.rects[1]));
+    ASSERT_FLOAT_EQ(bin.width, 100.0f);
+    ASSERT_FLOAT_EQ(bin.height, 150.0f);
+    ASSERT_FALSE(bin.is_dirty());
+}
+
+TEST("MaxRectsBin capacity tracks the largest free rectangle") {
+    maxrects_bin_test test{};
+    test.setup();
+    
+    ASSERT_EQ(test.bin->capacity().max_w, 1024.0f);
+    ASSERT_EQ(test.bin->capacity().max_area, 1024.0f * 1024.0f);
+    
+    test.bin->add(1024.0f, 1000.0f, 1);
+    const auto capacity{test.bin->capacity()};
+    ASSERT_EQ(capacity.max_w, 1024.0f);
+    ASSERT_EQ(capacity.max_h, 24.0f);
+    ASSERT_FALSE(capacity.admits(30.0f, 30.0f));
+    
+    test.bin->reset(true);
+    ASSERT_EQ(test.bin->capacity().max_h, 1024.0f);
+}
+
+TEST("MaxRectsBin repack drops every evicted rect and its slot") {
+    auto bin = MaxRectsBin<Rectangle<float>, float>{100.0f, 100.0f, 0.0f, PackingOptions<float>{.smart = false, .pot = false}};
+    bin.add(40.0f, 100.0f, 1);
+    bin.add(30.0f, 100.0f, 2);
+    bin.add(30.0f, 100.0f, 3);
+    bin.rect_slots = {7, 8, 9};
+    
+    bin.rects[0].set_width(90.0f);
+    const auto unpacked{bin.repack()};
+    
+    ASSERT_EQ(unpacked.size(), 2);
+    ASSERT_EQ(bin.rects.size(), 1);
+    ASSERT_EQ(std::any_cast<int>(bin.rects[0].data), 1);
+    ASSERT_EQ(bin.rect_slots.size(), 1);
+    ASSERT_EQ(bin.rect_slots[0], 7);
+    ASSERT_EQ(bin.unpacked_slots.size(), 2);
+}
+
+TEST("MaxRectsBin remove frees space for reuse without repacking") {
+    for (auto mode : {PruneMode::Sweep, PruneMode::Incremental, PruneMode::Grid}) {
+        auto opts = PackingOptions<float>{.smart = false, .pot = false, .allow_rotation = true, .prune_mode = mode};
+        auto bin = MaxRectsBin<Rectangle<float>, float>{256.0f, 256.0f, 0.0f, opts};
+        
+        for (auto round{0}; round < 40; ++round) {
+            for (auto i{0}; i < 12; ++i) {
+                bin.add(static_cast<float>(6 + (round * 31 + i * 37) % 50), static_cast<float>(6 + (round * 17 + i * 53) % 40), std::any{});
+            }
+            for (auto i = std::size_t{0}; i < bin.rects.size(); i += 2) {
+                ASSERT_TRUE(bin.remove(i));
+            }
+            
+            for (auto a = std::size_t{0}; a < bin.rects.size(); ++a) {
+                for (auto b = a + 1; b < bin.rects.size(); ++b) {
+                    const auto& p = bin.rects[a];
+                    const auto& q = bin.rects[b];
+                    ASSERT_TRUE(p.x + p.w <= q.x || q.x + q.w <= p.x || p.y + p.h <= q.y || q.y + q.h <= p.y);
+                }
+            }
+        }
+        
+        const auto& last{bin.rects.back()};
+        const auto last_w{last.w};
+        const auto last_h{last.h};
+        ASSERT_TRUE(bin.remove(last));
+        ASSERT_NE(bin.add(last_w, last_h, std::any{}), nullptr);
+        
+        while (!bin.rects.empty()) {
+            ASSERT_TRUE(bin.remove(bin.rects.size() - 1));
+        }
+        ASSERT_FALSE(bin.remove(0));
+        ASSERT_EQ(bin.free_rect_count(), 1);
+        ASSERT_FLOAT_EQ(bin.capacity().max_area, 256.0f * 256.0f);
+    }
+}
+
+TEST("MaxRectsBin bottom-left logic takes the lowest then leftmost position") {
+    auto opts = PackingOptions<float>{.smart = false, .pot = false, .logic = PackingLogic::BottomLeft};
+    auto bin = MaxRectsBin<Rectangle<float>, float>{100.0f, 100.0f, 0.0f, opts};
+    
+    ASSERT_NE(bin.add(60.0f, 40.0f, std::any{}), nullptr);
+    ASSERT_NE(bin.add(30.0f, 20.0f, std::any{}), nullptr);
+    ASSERT_FLOAT_EQ(bin.rects[1].x, 60.0f);
+    ASSERT_FLOAT_EQ(bin.rects[1].y, 0.0f);
+    
+    auto best_y{0.0f};
+    auto best_x{0.0f};
+    ASSERT_TRUE(bin.find_position_for_new_node_bottom_left(10.0f, 10.0f, best_y, best_x));
+    ASSERT_FLOAT_EQ(best_y, 10.0f);
+    ASSERT_FLOAT_EQ(best_x, 90.0f);
+}
+
+TEST("MaxRectsBin contact-point scores match a scan of placed rects") {
+    auto opts = PackingOptions<int>{.smart = false, .pot = false, .allow_rotation = true, .logic = PackingLogic::ContactPoint};
+    auto bin = MaxRectsBin<Rectangle<int>, int>{128, 128, 0, opts};
+    
+    const auto brute_force = [&bin](int x, int y, int w, int h) {
+        const auto span = [](int a0, int a1, int b0, int b1) { return std::max(0, std::min(a1, b1) - std::max(a0, b0)); };
+        auto total{0};
+        if (x == 0 || x + w == 128) total += h;
+        if (y == 0 || y + h == 128) total += w;
+        for (const auto& r : bin.rects) {
+            if (r.x + r.w == x || r.x == x + w) total += span(y, y + h, r.y, r.y + r.h);
+            if (r.y + r.h == y || r.y == y + h) total += span(x, x + w, r.x, r.x + r.w);
+        }
+        return total;
+    };
+    
+    for (auto i{0}; i < 60; ++i) {
+        const auto w{4 + (i * 37) % 23};
+        const auto h{4 + (i * 53) % 19};
+        const auto fit{bin.find_fit(w, h)};
+        if (!fit.found) {
+            break;
+        }
+        ASSERT_EQ(-fit.primary, brute_force(fit.x, fit.y, fit.w, fit.h));
+        ASSERT_NE(bin.commit_fit(Rectangle<int>{w, h}, fit), nullptr);
+        if (i % 5 == 4) {
+            ASSERT_TRUE(bin.remove(static_cast<std::size_t>(i % 3)));
+        }
+    }
+    ASSERT_GT(bin.rects.size(), std::size_t{20});
+    
+    // A placed rect's own edges face away from its sides, so only its
+    // neighbours and the border count.
+    for (const auto& r : bin.rects) {
+        ASSERT_EQ(bin.contact_score(r.x, r.y, r.w, r.h), brute_force(r.x, r.y, r.w, r.h));
+    }
+    bin.repack();
+    for (const auto& r : bin.rects) {
+        ASSERT_EQ(bin.contact_score(r.x, r.y, r.w, r.h), brute_force(r.x, r.y, r.w, r.h));
+    }
+}
+
+TEST("MaxRectsBin cached fits match a fresh scan after every change") {
+    for (auto logic : {PackingLogic::MaxArea, PackingLogic::MaxEdge, PackingLogic::FillWidth, PackingLogic::BottomLeft}) {
+        auto opts = PackingOptions<float>{.smart = false, .pot = false, .allow_rotation = true, .logic = logic};
+        auto bin = MaxRectsBin<Rectangle<float>, float>{256.0f, 256.0f, 0.0f, opts};
+        
+        auto sizes = std::vector<Size<float>>{};
+        for (auto i{0}; i < 40; ++i) {
+            sizes.push_back(Size<float>{static_cast<float>(4 + (i * 37) % 45), static_cast<float>(4 + (i * 53) % 29)});
+        }
+        auto cached = std::vector<CachedFit<float>>(sizes.size());
+        
+        for (auto step{0}; step < 80; ++step) {
+            auto fresh = std::vector<CachedFit<float>>(sizes.size());
+            bin.find_fits(sizes, cached);
+            bin.find_fits(sizes, fresh);
+            for (auto i = std::size_t{0}; i < sizes.size(); ++i) {
+                ASSERT_EQ(cached[i].fit.found, fresh[i].fit.found);
+                ASSERT_FLOAT_EQ(cached[i].fit.x, fresh[i].fit.x);
+                ASSERT_FLOAT_EQ(cached[i].fit.y, fresh[i].fit.y);
+                ASSERT_EQ(cached[i].fit.rotated, fresh[i].fit.rotated);
+                ASSERT_TRUE(cached[i].fit.primary == fresh[i].fit.primary);
+                ASSERT_TRUE(cached[i].fit.secondary == fresh[i].fit.secondary);
+            }
+            
+            const auto pick{static_cast<std::size_t>(step * 7) % sizes.size()};
+            if (fresh[pick].fit.found) {
+                ASSERT_NE(bin.commit_fit(Rectangle<float>{sizes[pick].w, sizes[pick].h}, fresh[pick].fit), nullptr);
+            }
+            if (step % 9 == 8 && !bin.rects.empty()) {
+                const auto version{bin.free_rect_version()};
+                ASSERT_TRUE(bin.remove(std::size_t{0}));
+                ASSERT_NE(bin.free_rect_version(), version);
+            }
+        }
+    }
+}
+
+class free_id_bin : public MaxRectsBin<Rectangle<float>, float> {
+public:
+    using MaxRectsBin::MaxRectsBin;
+
+    auto skip_free_ids_to(std::uint32_t next) -> void {
+        free_rectangles.next_id = next;
+    }
+
+    [[nodiscard]] auto next_free_id() const noexcept -> std::uint32_t {
+        return free_rectangles.next_id;
+    }
+};
+
+TEST("MaxRectsBin renumbers free rect ids before they wrap") {
+    for (auto prune : {PruneMode::Incremental, PruneMode::Grid}) {
+        auto opts = PackingOptions<float>{.smart = false, .pot = false, .allow_rotation = true, .prune_mode = prune};
+        auto bin = free_id_bin{256.0f, 256.0f, 0.0f, opts};
+        auto reference = MaxRectsBin<Rectangle<float>, float>{256.0f, 256.0f, 0.0f, opts};
+        
+        auto sizes = std::vector<Size<float>>{};
+        for (auto i{0}; i < 40; ++i) {
+            sizes.push_back(Size<float>{static_cast<float>(4 + (i * 37) % 45), static_cast<float>(4 + (i * 53) % 29)});
+        }
+        auto cached = std::vector<CachedFit<float>>(sizes.size());
+        bin.find_fits(sizes, cached);
+        bin.skip_free_ids_to(std::numeric_limits<std::uint32_t>::max() - 8u);
+        
+        for (auto step{0}; step < 60; ++step) {
+            auto fresh = std::vector<CachedFit<float>>(sizes.size());
+            bin.find_fits(sizes, cached);
+            reference.find_fits(sizes, fresh);
+            for (auto i = std::size_t{0}; i < sizes.size(); ++i) {
+                ASSERT_EQ(cached[i].fit.found, fresh[i].fit.found);
+                ASSERT_FLOAT_EQ(cached[i].fit.x, fresh[i].fit.x);
+                ASSERT_FLOAT_EQ(cached[i].fit.y, fresh[i].fit.y);
+                ASSERT_EQ(cached[i].fit.rotated, fresh[i].fit.rotated);
+            }
+            
+            const auto pick{static_cast<std::size_t>(step * 7) % sizes.size()};
+            if (fresh[pick].fit.found) {
+                ASSERT_NE(bin.commit_fit(Rectangle<float>{sizes[pick].w, sizes[pick].h}, fresh[pick].fit), nullptr);
+                ASSERT_NE(reference.commit_fit(Rectangle<float>{sizes[pick].w, sizes[pick].h}, fresh[pick].fit), nullptr);
+                ASSERT_GT(free_rect_id_limit, bin.next_free_id());
+            }
+            if (step % 9 == 8 && !bin.rects.empty()) {
+                ASSERT_TRUE(bin.remove(std::size_t{0}));
+                ASSERT_TRUE(reference.remove(std::size_t{0}));
+            }
+        }
+        ASSERT_EQ(bin.rects.size(), reference.rects.size());
+    }
+}
+
+TEST("MaxRectsBin global fit places batches best-first in add_bulk and repack") {
+    auto opts = PackingOptions<float>{.smart = false, .pot = false, .allow_rotation = true, .global_fit = true};
+    auto bin = MaxRectsBin<Rectangle<float>, float>{128.0f, 128.0f, 0.0f, opts};
+    
+    auto rects = std::vector<Rectangle<float>>{};
+    for (auto i{0}; i < 50; ++i) {
+        rects.emplace_back(static_cast<float>(6 + (i * 37) % 27), static_cast<float>(6 + (i * 53) % 21));
+        rects.back().set_allow_rotation(true);
+    }
+    const auto added{bin.add_bulk(rects)};
+    ASSERT_EQ(added.size(), rects.size());
+    const auto placed{static_cast<std::size_t>(std::count_if(added.begin(), added.end(), [](auto* rect) { return rect != nullptr; }))};
+    ASSERT_EQ(placed, bin.rects.size());
+    ASSERT_GT(placed, std::size_t{20});
+    
+    const auto unpacked{bin.repack()};
+    ASSERT_EQ(bin.rects.size() + unpacked.size(), placed);
+    for (auto a = std::size_t{0}; a < bin.rects.size(); ++a) {
+        const auto& p = bin.rects[a];
+        ASSERT_TRUE(p.x + p.w <= 128.0f && p.y + p.h <= 128.0f);
+        for (auto b = a + 1; b < bin.rects.size(); ++b) {
+            const auto& q = bin.rects[b];
+            ASSERT_TRUE(p.x + p.w <= q.x || q.x + q.w <= p.x || p.y + p.h <= q.y || q.y + q.h <= p.y);
+        }
+    }
+}
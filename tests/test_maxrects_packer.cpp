@@ -1,6 +1,11 @@
 #include "simple_test.h"
+#include "allocation_counter.h"
 #include "../src/maxrects_packer.h"
+#include <array>
+#include <cstddef>
+#include <limits>
 #include <memory>
+#include <memory_resource>
 
 using namespace MaxRects;
 
@@ -159,3 +164,591 @@ TEST("MaxRectsPacker get all rects") {
     auto all_rects = test.packer->get_all_rects();
     ASSERT_EQ(all_rects.size(), 2);
 }
+
+TEST("MaxRectsPacker best-of keeps the best heuristic result") {
+    auto rectangles = std::vector<Rectangle<float>>{};
+    for (auto i{0}; i < 120; ++i) {
+        rectangles.emplace_back(static_cast<float>(16 + (i * 37) % 97), static_cast<float>(16 + (i * 53) % 89));
+    }
+    
+    auto fewest_bins{std::numeric_limits<std::size_t>::max()};
+    for (auto logic : packing_logics) {
+        for (auto sort : {SortOrder::MaxEdge, SortOrder::Area}) {
+            PackingOptions<float> opts{.pot = false, .logic = logic, .sort = sort};
+            auto single = MaxRectsPacker<float, Rectangle<float>>{512.0f, 512.0f, 0.0f, opts};
+            single.add_array(rectangles);
+            fewest_bins = std::min(fewest_bins, single.bins.size());
+        }
+    }
+    
+    PackingOptions<float> opts{.pot = false, .best_of = true, .threads = 4};
+    auto packer = MaxRectsPacker<float, Rectangle<float>>{512.0f, 512.0f, 0.0f, opts};
+    const auto result{packer.add_array_best_of(rectangles)};
+    
+    ASSERT_EQ(packer.bins.size(), fewest_bins);
+    ASSERT_EQ(result.bin_count, fewest_bins);
+    ASSERT_EQ(packer.get_all_rects().size(), rectangles.size());
+    ASSERT_GT(packer.occupancy(), 0.0);
+}
+
+TEST("MaxRectsPacker best-fit commits to the tightest open bin") {
+    PackingOptions<float> opts{.smart = false, .pot = false};
+    auto first_fit = MaxRectsPacker<float, Rectangle<float>>{100.0f, 100.0f, 0.0f, opts};
+    opts.bin_selection = BinSelection::BestFit;
+    auto best_fit = MaxRectsPacker<float, Rectangle<float>>{100.0f, 100.0f, 0.0f, opts};
+    
+    for (auto* packer : {&first_fit, &best_fit}) {
+        packer->add(60.0f, 100.0f, 1);
+        packer->add(70.0f, 100.0f, 2);
+        ASSERT_EQ(packer->bins.size(), 2);
+        ASSERT_NE(packer->add(30.0f, 100.0f, 3), nullptr);
+    }
+    
+    ASSERT_EQ(first_fit.bins[0]->rects.size(), 2);
+    ASSERT_EQ(best_fit.bins[0]->rects.size(), 1);
+    ASSERT_EQ(best_fit.bins[1]->rects.size(), 2);
+    ASSERT_EQ(best_fit.bins[1]->rects.back().x, 70.0f);
+}
+
+TEST("MaxRectsPacker best-fit scoring is identical with and without threads") {
+    auto rectangles = std::vector<Rectangle<float>>{};
+    for (auto i{0}; i < 600; ++i) {
+        rectangles.emplace_back(static_cast<float>(8 + (i * 37) % 53), static_cast<float>(8 + (i * 53) % 47));
+    }
+    
+    auto pack = [&](std::size_t threads) {
+        PackingOptions<float> opts{.pot = false, .threads = threads, .bin_selection = BinSelection::BestFit};
+        auto packer = MaxRectsPacker<float, Rectangle<float>>{64.0f, 64.0f, 0.0f, opts};
+        packer.add_array(rectangles);
+        return packer.get_all_rects();
+    };
+    
+    const auto serial{pack(1)};
+    const auto parallel{pack(4)};
+    ASSERT_EQ(serial.size(), rectangles.size());
+    ASSERT_EQ(parallel.size(), serial.size());
+    for (auto i = std::size_t{0}; i < serial.size(); ++i) {
+        ASSERT_EQ(parallel[i].x, serial[i].x);
+        ASSERT_EQ(parallel[i].y, serial[i].y);
+        ASSERT_EQ(parallel[i].w, serial[i].w);
+    }
+}
+
+TEST("MaxRectsPacker handles survive inserts and repacks") {
+    PackingOptions<float> opts{.smart = false, .pot = false};
+    auto packer = MaxRectsPacker<float, Rectangle<float>>{100.0f, 100.0f, 0.0f, opts};
+    
+    const auto wide{packer.insert(Rectangle<float>{60.0f, 100.0f, std::any{1}})};
+    const auto narrow{packer.insert(Rectangle<float>{40.0f, 100.0f, std::any{2}})};
+    for (auto i{0}; i < 50; ++i) {
+        packer.insert(Rectangle<float>{10.0f, 10.0f, std::any{100 + i}});
+    }
+    
+    ASSERT_EQ(std::any_cast<int>(packer.get(wide)->data), 1);
+    ASSERT_EQ(std::any_cast<int>(packer.get(narrow)->data), 2);
+    ASSERT_EQ(packer.locate(narrow)->bin, 0);
+    ASSERT_EQ(packer.handle_at(0, 1), narrow);
+    
+    packer.get(narrow)->set_width(50.0f);
+    packer.repack();
+    
+    ASSERT_EQ(std::any_cast<int>(packer.get(wide)->data), 1);
+    ASSERT_EQ(packer.locate(wide)->bin, 0);
+    ASSERT_EQ(std::any_cast<int>(packer.get(narrow)->data), 2);
+    ASSERT_EQ(packer.get(narrow)->w, 50.0f);
+    ASSERT_NE(packer.locate(narrow)->bin, 0);
+    ASSERT_EQ(packer.bins[0]->rects.size(), 1);
+    
+    packer.get(wide)->set_width(70.0f);
+    packer.repack(false);
+    ASSERT_EQ(std::any_cast<int>(packer.get(wide)->data), 1);
+    ASSERT_EQ(std::any_cast<int>(packer.get(narrow)->data), 2);
+    ASSERT_EQ(packer.get_all_rects().size(), 52);
+    
+    packer.reset();
+    ASSERT_EQ(packer.get(wide), nullptr);
+    ASSERT_FALSE(packer.locate(narrow).has_value());
+}
+
+TEST("MaxRectsPacker draws all memory from its memory resource") {
+    auto rectangles = std::vector<Rectangle<int>>{};
+    for (auto i{0}; i < 300; ++i) {
+        rectangles.emplace_back(8 + (i * 37) % 90, 8 + (i * 53) % 70);
+    }
+    auto buffer = std::vector<std::byte>(std::size_t{1} << 22);
+    auto arena = std::pmr::monotonic_buffer_resource{buffer.data(), buffer.size(), std::pmr::null_memory_resource()};
+    
+    const auto before{allocation_count()};
+    {
+        PackingOptions<int> opts{.pot = false, .allow_rotation = true, .prune_mode = PruneMode::Grid};
+        auto packer = MaxRectsPacker<int, Rectangle<int>>{256, 256, 0, opts, &arena};
+        packer.add_array(rectangles);
+        const auto handle{packer.insert(Rectangle<int>{300, 40})};
+        packer.bins[0]->rects[0].set_width(200);
+        packer.repack();
+        packer.repack(false);
+        
+        ASSERT_EQ(packer.get_memory_resource(), &arena);
+        ASSERT_NE(packer.get(handle), nullptr);
+        ASSERT_GT(packer.bins.size(), 1);
+        packer.reset();
+    }
+    ASSERT_EQ(allocation_count(), before);
+}
+
+TEST("MaxRectsPacker size batch matches the rect path") {
+    auto sizes = std::vector<Size<float>>{};
+    auto rectangles = std::vector<Rectangle<float>>{};
+    for (auto i{0}; i < 400; ++i) {
+        const auto size = Size<float>{static_cast<float>(8 + (i * 37) % 120), static_cast<float>(8 + (i * 53) % 90)};
+        sizes.push_back(size);
+        rectangles.emplace_back(size.w, size.h, std::any{i});
+    }
+    
+    for (auto selection : {BinSelection::FirstFit, BinSelection::BestFit}) {
+        PackingOptions<float> opts{.pot = false, .allow_rotation = true, .bin_selection = selection};
+        auto by_rect = MaxRectsPacker<float, Rectangle<float>>{256.0f, 256.0f, 0.0f, opts};
+        by_rect.add_array(rectangles);
+        
+        auto by_size = MaxRectsPacker<float, Rectangle<float>>{256.0f, 256.0f, 0.0f, opts};
+        auto placements = std::vector<Placement<float>>(sizes.size());
+        ASSERT_EQ(by_size.add_array(sizes, placements), sizes.size());
+        ASSERT_EQ(by_size.bins.size(), by_rect.bins.size());
+        ASSERT_TRUE(by_size.get_all_rects().empty());
+        
+        for (auto bin = std::size_t{0}; bin < by_rect.bins.size(); ++bin) {
+            for (const auto& rect : by_rect.bins[bin]->rects) {
+                const auto& placement = placements[static_cast<std::size_t>(std::any_cast<int>(rect.data))];
+                ASSERT_EQ(placement.bin, bin);
+                ASSERT_EQ(placement.x, rect.x);
+                ASSERT_EQ(placement.y, rect.y);
+                ASSERT_EQ(placement.rotated, rect.rot);
+            }
+        }
+        
+        const auto oversized = std::array{Size<float>{600.0f, 20.0f}};
+        auto oversized_placement = std::array<Placement<float>, 1>{};
+        ASSERT_EQ(by_size.add_array(oversized, oversized_placement), 0);
+        ASSERT_FALSE(oversized_placement[0].placed());
+    }
+}
+
+TEST("MaxRectsPacker repack keeps regions placed through the span API") {
+    for (auto algorithm : {BinAlgorithm::MaxRects, BinAlgorithm::Skyline, BinAlgorithm::Guillotine}) {
+        PackingOptions<float> opts{.pot = false, .bin_algorithm = algorithm};
+        auto packer = MaxRectsPacker<float, Rectangle<float>>{128.0f, 128.0f, 0.0f, opts};
+        
+        auto handles = std::vector<RectHandle>{};
+        for (auto i{0}; i < 60; ++i) {
+            handles.push_back(packer.insert(Rectangle<float>{static_cast<float>(6 + (i * 37) % 30), static_cast<float>(6 + (i * 53) % 26)}));
+        }
+        auto sizes = std::vector<Size<float>>{};
+        for (auto i{0}; i < 80; ++i) {
+            sizes.push_back(Size<float>{static_cast<float>(5 + (i * 29) % 33), static_cast<float>(5 + (i * 41) % 27)});
+        }
+        auto placements = std::vector<Placement<float>>(sizes.size());
+        ASSERT_EQ(packer.add_array(sizes, placements), sizes.size());
+        for (auto i{0}; i < 60; ++i) {
+            handles.push_back(packer.insert(Rectangle<float>{static_cast<float>(4 + (i * 31) % 28), static_cast<float>(4 + (i * 43) % 24)}));
+        }
+        for (auto i = std::size_t{0}; i < handles.size(); i += 2) {
+            ASSERT_TRUE(packer.remove(handles[i]));
+        }
+        for (auto i = std::size_t{1}; i < handles.size(); i += 6) {
+            auto* rect = packer.get(handles[i]);
+            ASSERT_NE(rect, nullptr);
+            rect->set_width(rect->w + 10.0f);
+        }
+        
+        const auto check = [&]() {
+            auto reserved = std::size_t{0};
+            for (const auto& bin : packer.bins) {
+                reserved += bin->reserved.size();
+            }
+            ASSERT_EQ(reserved, sizes.size());
+            for (auto bin = std::size_t{0}; bin < packer.bins.size(); ++bin) {
+                auto regions = std::vector<Rectangle<float>>{};
+                for (auto i = std::size_t{0}; i < placements.size(); ++i) {
+                    if (placements[i].bin == bin) {
+                        regions.emplace_back(sizes[i].w, sizes[i].h, placements[i].x, placements[i].y);
+                    }
+                }
+                for (const auto& rect : packer.bins[bin]->rects) {
+                    regions.emplace_back(rect.w, rect.h, rect.x, rect.y);
+                }
+                for (auto a = std::size_t{0}; a < regions.size(); ++a) {
+                    const auto& p = regions[a];
+                    ASSERT_TRUE(p.x + p.w <= packer.bins[bin]->width && p.y + p.h <= packer.bins[bin]->height);
+                    for (auto b = a + 1; b < regions.size(); ++b) {
+                        const auto& q = regions[b];
+                        ASSERT_TRUE(p.x + p.w <= q.x || q.x + q.w <= p.x || p.y + p.h <= q.y || q.y + q.h <= p.y);
+                    }
+                }
+            }
+            ASSERT_EQ(packer.get_all_rects().size(), handles.size() / 2);
+            for (auto i = std::size_t{1}; i < handles.size(); i += 2) {
+                ASSERT_NE(packer.get(handles[i]), nullptr);
+            }
+        };
+        packer.repack(true);
+        check();
+        packer.repack(false);
+        check();
+    }
+}
+
+TEST("MaxRectsPacker streaming emits closed bins and keeps a bounded working set") {
+    PackingOptions<float> opts{.smart = false, .pot = false};
+    auto packer = MaxRectsPacker<float, Rectangle<float>>{128.0f, 128.0f, 0.0f, opts};
+    
+    auto serials = std::vector<std::size_t>{};
+    auto emitted = std::size_t{0};
+    packer.stream([&](std::size_t serial, AbstractBin<Rectangle<float>, float>& bin) {
+        serials.push_back(serial);
+        emitted += bin.rects.size();
+    }, StreamPolicy{.close_occupancy = 0.85, .close_after_misses = 64});
+    
+    const auto first{packer.insert(Rectangle<float>{40.0f, 40.0f})};
+    auto most_open = std::size_t{0};
+    for (auto i{0}; i < 3000; ++i) {
+        packer.add(static_cast<float>(4 + (i * 37) % 60), static_cast<float>(4 + (i * 53) % 50));
+        most_open = std::max(most_open, packer.bins.size());
+    }
+    ASSERT_GT(packer.closed_bin_count(), 20);
+    ASSERT_GT(16, most_open);
+    ASSERT_EQ(packer.get(first), nullptr);
+    
+    packer.next();
+    ASSERT_EQ(packer.bins.size(), 0);
+    ASSERT_EQ(emitted, 3001);
+    ASSERT_EQ(serials.size(), packer.closed_bin_count());
+    std::sort(serials.begin(), serials.end());
+    for (auto i = std::size_t{0}; i < serials.size(); ++i) {
+        ASSERT_EQ(serials[i], i);
+    }
+}
+
+TEST("MaxRectsPacker streaming keeps serials in step with best-of and sharded packs") {
+    auto configs = std::vector<PackingOptions<float>>{};
+    configs.push_back(PackingOptions<float>{.smart = false, .pot = false, .best_of = true});
+    configs.push_back(PackingOptions<float>{.smart = false, .pot = false, .shard = ShardMode::RoundRobin, .shards = 3});
+    for (const auto& opts : configs) {
+        auto packer = MaxRectsPacker<float, Rectangle<float>>{128.0f, 128.0f, 0.0f, opts};
+        auto emitted = std::vector<std::pair<std::size_t, std::vector<int>>>{};
+        packer.stream([&](std::size_t serial, AbstractBin<Rectangle<float>, float>& bin) {
+            auto ids = std::vector<int>{};
+            for (const auto& rect : bin.rects) {
+                ids.push_back(std::any_cast<int>(rect.data));
+            }
+            emitted.emplace_back(serial, std::move(ids));
+        }, StreamPolicy{.close_occupancy = 0.8});
+        
+        auto total = 0;
+        for (auto batch{0}; batch < 6; ++batch) {
+            auto rects = std::vector<Rectangle<float>>{};
+            for (auto i{0}; i < 150; ++i, ++total) {
+                rects.emplace_back(static_cast<float>(6 + (total * 37) % 40), static_cast<float>(6 + (total * 53) % 36), std::any{total});
+            }
+            packer.add_array(rects);
+        }
+        packer.add(Rectangle<float>{4.0f, 4.0f, std::any{total++}});
+        ASSERT_GT(packer.closed_bin_count(), 2);
+        
+        // Open bins sit in creation order, so their serials must rise.
+        auto open_ids = std::vector<int>{};
+        for (const auto& bin : packer.bins) {
+            open_ids.push_back(std::any_cast<int>(bin->rects[0].data));
+        }
+        const auto closed_before = emitted.size();
+        packer.next();
+        ASSERT_EQ(emitted.size() - closed_before, open_ids.size());
+        for (auto i = closed_before; i < emitted.size(); ++i) {
+            ASSERT_EQ(emitted[i].second[0], open_ids[i - closed_before]);
+            if (i > closed_before) {
+                ASSERT_GT(emitted[i].first, emitted[i - 1].first);
+            }
+        }
+        
+        auto serials = std::vector<std::size_t>{};
+        auto seen = std::vector<int>(static_cast<std::size_t>(total), 0);
+        for (const auto& [serial, ids] : emitted) {
+            serials.push_back(serial);
+            for (auto id : ids) {
+                ++seen[static_cast<std::size_t>(id)];
+            }
+        }
+        ASSERT_EQ(serials.size(), packer.closed_bin_count());
+        std::sort(serials.begin(), serials.end());
+        for (auto i = std::size_t{0}; i < serials.size(); ++i) {
+            ASSERT_EQ(serials[i], i);
+        }
+        for (auto count : seen) {
+            ASSERT_EQ(count, 1);
+        }
+    }
+}
+
+TEST("MaxRectsPacker remove frees a rect and keeps other handles valid") {
+    PackingOptions<float> opts{.smart = false, .pot = false};
+    auto packer = MaxRectsPacker<float, Rectangle<float>>{100.0f, 100.0f, 0.0f, opts};
+    
+    const auto first{packer.insert(Rectangle<float>{100.0f, 60.0f, std::any{1}})};
+    const auto second{packer.insert(Rectangle<float>{50.0f, 40.0f, std::any{2}})};
+    const auto third{packer.insert(Rectangle<float>{50.0f, 40.0f, std::any{3}})};
+    ASSERT_EQ(packer.bins.size(), 1);
+    
+    ASSERT_TRUE(packer.remove(first));
+    ASSERT_FALSE(packer.remove(first));
+    ASSERT_EQ(packer.get(first), nullptr);
+    ASSERT_EQ(std::any_cast<int>(packer.get(second)->data), 2);
+    ASSERT_EQ(std::any_cast<int>(packer.get(third)->data), 3);
+    ASSERT_EQ(packer.locate(third)->index, 0);
+    
+    packer.add(100.0f, 60.0f, 4);
+    ASSERT_EQ(packer.bins.size(), 1);
+    ASSERT_EQ(packer.bins[0]->rects.size(), 3);
+}
+
+TEST("MaxRectsPacker reuses space freed through its bins directly") {
+    PackingOptions<float> opts{.smart = false, .pot = false};
+    auto packer = MaxRectsPacker<float, Rectangle<float>>{100.0f, 100.0f, 0.0f, opts};
+    
+    packer.add(100.0f, 100.0f, 1);
+    packer.add(100.0f, 100.0f, 2);
+    ASSERT_EQ(packer.bins.size(), 2);
+    
+    ASSERT_TRUE(packer.bins[0]->remove(std::size_t{0}));
+    packer.add(100.0f, 100.0f, 3);
+    ASSERT_EQ(packer.bins.size(), 2);
+    ASSERT_EQ(std::any_cast<int>(packer.bins[0]->rects[0].data), 3);
+    
+    ASSERT_TRUE(packer.bins[1]->remove(std::size_t{0}));
+    auto sizes = std::vector<Size<float>>{{100.0f, 100.0f}};
+    auto placements = std::vector<Placement<float>>(1);
+    ASSERT_EQ(packer.add_array(sizes, placements), 1);
+    ASSERT_EQ(packer.bins.size(), 2);
+    ASSERT_EQ(placements[0].bin, 1);
+}
+
+TEST("MaxRectsPacker global fit places every rect without overlaps on any thread count") {
+    auto rectangles = std::vector<Rectangle<float>>{};
+    for (auto i{0}; i < 600; ++i) {
+        rectangles.emplace_back(static_cast<float>(4 + (i * 37) % 61), static_cast<float>(4 + (i * 53) % 47));
+    }
+    rectangles.emplace_back(400.0f, 20.0f);
+    
+    PackingOptions<float> opts{.pot = false, .allow_rotation = true};
+    auto greedy = MaxRectsPacker<float, Rectangle<float>>{256.0f, 256.0f, 0.0f, opts};
+    greedy.add_array(rectangles);
+    
+    auto layouts = std::vector<std::vector<Rectangle<float>>>{};
+    for (auto threads : {std::size_t{1}, std::size_t{4}}) {
+        opts.global_fit = true;
+        opts.threads = threads;
+        auto packer = MaxRectsPacker<float, Rectangle<float>>{256.0f, 256.0f, 0.0f, opts};
+        packer.add_array(rectangles);
+        
+        ASSERT_EQ(packer.get_all_rects().size(), rectangles.size());
+        ASSERT_TRUE(packer.bins.size() <= greedy.bins.size());
+        for (const auto& bin : packer.bins) {
+            for (auto a = std::size_t{0}; a < bin->rects.size(); ++a) {
+                for (auto b = a + 1; b < bin->rects.size(); ++b) {
+                    const auto& p = bin->rects[a];
+                    const auto& q = bin->rects[b];
+                    ASSERT_TRUE(p.x + p.w <= q.x || q.x + q.w <= p.x || p.y + p.h <= q.y || q.y + q.h <= p.y);
+                }
+            }
+        }
+        layouts.push_back(packer.get_all_rects());
+    }
+    
+    ASSERT_EQ(layouts[0].size(), layouts[1].size());
+    for (auto i = std::size_t{0}; i < layouts[0].size(); ++i) {
+        ASSERT_TRUE(layouts[0][i] == layouts[1][i]);
+    }
+}
+
+TEST("MaxRectsPacker routes tagged rects to bins of their own tag") {
+    constexpr auto stone = make_tag("stone");
+    constexpr auto grass = make_tag("grass");
+    static_assert(stone != grass && stone.tagged());
+    
+    auto rectangles = std::vector<Rectangle<float>>{};
+    for (auto i{0}; i < 40; ++i) {
+        auto rect = Rectangle<float>{static_cast<float>(8 + i % 5), 8.0f};
+        rect.tag = i % 2 == 0 ? stone : grass;
+        rectangles.push_back(rect);
+    }
+    
+    for (auto global : {false, true}) {
+        PackingOptions<float> opts{.pot = false, .tag = true, .exclusive_tag = true};
+        opts.global_fit = global;
+        auto packer = MaxRectsPacker<float, Rectangle<float>>{256.0f, 256.0f, 0.0f, opts};
+        packer.add_array(rectangles);
+        
+        ASSERT_EQ(packer.bins.size(), std::size_t{2});
+        ASSERT_EQ(packer.get_all_rects().size(), rectangles.size());
+        for (const auto& bin : packer.bins) {
+            for (const auto& rect : bin->rects) {
+                ASSERT_TRUE(rect.tag == bin->tag);
+            }
+        }
+        
+        auto loose = rectangles.front();
+        loose.tag = make_tag("sand");
+        ASSERT_NE(packer.add(loose), nullptr);
+        ASSERT_EQ(packer.bins.size(), std::size_t{3});
+    }
+    
+    PackingOptions<float> shared{.pot = false, .tag = true, .exclusive_tag = false};
+    auto packer = MaxRectsPacker<float, Rectangle<float>>{256.0f, 256.0f, 0.0f, shared};
+    packer.add_array(rectangles);
+    ASSERT_EQ(packer.bins.size(), std::size_t{1});
+}
+
+TEST("MaxRectsPacker sharded add_array keeps every rect and handle") {
+    auto rectangles = std::vector<Rectangle<float>>{};
+    for (auto i{0}; i < 900; ++i) {
+        rectangles.emplace_back(static_cast<float>(4 + (i * 37) % 61), static_cast<float>(4 + (i * 53) % 47));
+    }
+    rectangles.emplace_back(400.0f, 20.0f);
+    
+    PackingOptions<float> opts{.pot = false, .allow_rotation = true};
+    auto sequential = MaxRectsPacker<float, Rectangle<float>>{256.0f, 256.0f, 0.0f, opts};
+    sequential.add_array(rectangles);
+    
+    for (auto mode : {ShardMode::RoundRobin, ShardMode::SizeClass}) {
+        opts.shard = mode;
+        opts.shards = 3;
+        opts.threads = 3;
+        auto packer = MaxRectsPacker<float, Rectangle<float>>{256.0f, 256.0f, 0.0f, opts};
+        const auto handle = packer.insert(Rectangle<float>{10.0f, 10.0f});
+        const auto result = packer.add_array_sharded(rectangles);
+        
+        ASSERT_EQ(result.shard_count, std::size_t{3});
+        ASSERT_EQ(result.bin_count + 1, packer.bins.size());
+        ASSERT_TRUE(result.bin_count <= sequential.bins.size() + 2);
+        ASSERT_GT(result.area_bound_bins, std::size_t{0});
+        ASSERT_TRUE(result.area_bound_bins <= sequential.bins.size());
+        ASSERT_TRUE(result.area_bound_bins <= result.bin_count);
+        ASSERT_GT(result.occupancy, 0.0);
+        ASSERT_EQ(packer.get_all_rects().size(), rectangles.size() + 1);
+        ASSERT_NE(packer.get(handle), nullptr);
+        for (auto bin = std::size_t{0}; bin < packer.bins.size(); ++bin) {
+            for (auto index = std::size_t{0}; index < packer.bins[bin]->rects.size(); ++index) {
+                const auto* rect = packer.get(packer.handle_at(bin, index));
+                ASSERT_TRUE(rect == &packer.bins[bin]->rects[index]);
+            }
+        }
+    }
+    
+    auto tagged = rectangles;
+    for (auto i = std::size_t{0}; i < tagged.size(); ++i) {
+        tagged[i].tag = i % 3 == 0 ? make_tag("a") : make_tag("b");
+    }
+    PackingOptions<float> tag_opts{.pot = false, .tag = true, .shard = ShardMode::Tag};
+    auto packer = MaxRectsPacker<float, Rectangle<float>>{256.0f, 256.0f, 0.0f, tag_opts};
+    packer.add_array(tagged);
+    ASSERT_EQ(packer.get_all_rects().size(), tagged.size());
+    for (const auto& bin : packer.bins) {
+        for (const auto& rect : bin->rects) {
+            ASSERT_TRUE(rect.tag == bin->tag || bin->rects.size() == 1);
+        }
+    }
+}
+
+TEST("MaxRectsPacker repacks dirty bins concurrently with a deterministic result") {
+    auto rectangles = std::vector<Rectangle<float>>{};
+    for (auto i{0}; i < 800; ++i) {
+        rectangles.emplace_back(static_cast<float>(4 + (i * 37) % 61), static_cast<float>(4 + (i * 53) % 47));
+    }
+    
+    auto layouts = std::vector<std::vector<Rectangle<float>>>{};
+    for (auto threads : {std::size_t{1}, std::size_t{4}}) {
+        PackingOptions<float> opts{.pot = false, .allow_rotation = true, .threads = threads};
+        auto packer = MaxRectsPacker<float, Rectangle<float>>{128.0f, 128.0f, 0.0f, opts};
+        packer.add_array(rectangles);
+        const auto bin_count = packer.bins.size();
+        ASSERT_GT(bin_count, std::size_t{30});
+        
+        auto handles = std::vector<RectHandle>{};
+        for (auto bin = std::size_t{0}; bin < bin_count; ++bin) {
+            handles.push_back(packer.handle_at(bin, 0));
+            packer.bins[bin]->rects[0].set_width(packer.bins[bin]->rects[0].w + 6.0f);
+        }
+        packer.repack();
+        
+        ASSERT_EQ(packer.get_all_rects().size(), rectangles.size());
+        for (const auto& handle : handles) {
+            ASSERT_NE(packer.get(handle), nullptr);
+        }
+        for (const auto& bin : packer.bins) {
+            for (auto a = std::size_t{0}; a < bin->rects.size(); ++a) {
+                for (auto b = a + 1; b < bin->rects.size(); ++b) {
+                    const auto& p = bin->rects[a];
+                    const auto& q = bin->rects[b];
+                    ASSERT_TRUE(p.x + p.w <= q.x || q.x + q.w <= p.x || p.y + p.h <= q.y || q.y + q.h <= p.y);
+                }
+            }
+        }
+        layouts.push_back(packer.get_all_rects());
+    }
+    
+    ASSERT_EQ(layouts[0].size(), layouts[1].size());
+    for (auto i = std::size_t{0}; i < layouts[0].size(); ++i) {
+        ASSERT_TRUE(layouts[0][i] == layouts[1][i]);
+    }
+}
+
+TEST("MaxRectsPacker deterministic mode gives the same layout on any thread count") {
+    auto rectangles = std::vector<Rectangle<float>>{};
+    for (auto i{0}; i < 1200; ++i) {
+        // Few distinct sizes, so sorting and scoring see plenty of ties.
+        rectangles.emplace_back(static_cast<float>(8 + (i * 7) % 5 * 8), static_cast<float>(8 + (i * 3) % 4 * 8), std::any{i});
+    }
+    
+    auto configs = std::vector<PackingOptions<float>>{};
+    configs.push_back(PackingOptions<float>{.pot = false, .allow_rotation = true, .bin_selection = BinSelection::BestFit});
+    configs.push_back(PackingOptions<float>{.pot = false, .best_of = true});
+    configs.push_back(PackingOptions<float>{.pot = false, .allow_rotation = true, .global_fit = true});
+    configs.push_back(PackingOptions<float>{.pot = false, .shard = ShardMode::RoundRobin});
+    for (auto& opts : configs) {
+        opts.deterministic = true;
+        auto reference = std::vector<Rectangle<float>>{};
+        for (auto threads = std::size_t{1}; threads <= 4; ++threads) {
+            opts.threads = threads;
+            auto packer = MaxRectsPacker<float, Rectangle<float>>{128.0f, 128.0f, 0.0f, opts};
+            packer.add_array(rectangles);
+            for (auto bin = std::size_t{0}; bin < packer.bins.size(); bin += 2) {
+                packer.bins[bin]->rects[0].set_height(packer.bins[bin]->rects[0].h + 4.0f);
+            }
+            packer.repack();
+            
+            const auto layout = packer.get_all_rects();
+            ASSERT_EQ(layout.size(), rectangles.size());
+            if (threads == 1) {
+                reference = layout;
+                continue;
+            }
+            for (auto i = std::size_t{0}; i < layout.size(); ++i) {
+                ASSERT_TRUE(layout[i] == reference[i]);
+                ASSERT_EQ(std::any_cast<int>(layout[i].data), std::any_cast<int>(reference[i].data));
+            }
+        }
+    }
+}
+
+TEST("MaxRectsPacker places equal rects in input order") {
+    PackingOptions<float> opts{.pot = false};
+    auto packer = MaxRectsPacker<float, Rectangle<float>>{64.0f, 64.0f, 0.0f, opts};
+    auto rectangles = std::vector<Rectangle<float>>{};
+    for (auto i{0}; i < 16; ++i) {
+        rectangles.emplace_back(16.0f, 16.0f, std::any{i});
+    }
+    packer.add_array(rectangles);
+    
+    ASSERT_EQ(packer.bins.size(), std::size_t{1});
+    for (auto i = std::size_t{0}; i < rectangles.size(); ++i) {
+        ASSERT_EQ(std::any_cast<int>(packer.bins[0]->rects[i].data), static_cast<int>(i));
+    }
+}
@@ -0,0 +1,61 @@
+#include "simple_test.h"
+#include "../src/maxrects_packer.h"
+#include <type_traits>
+
+using namespace MaxRects;
+
+TEST("StatsRecorder disabled specialization is empty") {
+    ASSERT_TRUE(std::is_empty_v<StatsRecorder<false>>);
+    
+    auto recorder = StatsRecorder<false>{};
+    recorder.count_insert();
+    recorder.count_scan(10);
+    ASSERT_EQ(recorder.snapshot().inserts, 0);
+    ASSERT_EQ(recorder.snapshot().free_rects_scanned, 0);
+}
+
+TEST("StatsRecorder accumulates counters and keeps the peak") {
+    auto recorder = StatsRecorder<true>{};
+    recorder.count_insert();
+    recorder.count_insert();
+    recorder.count_scan(7);
+    recorder.count_splits(3);
+    recorder.observe_free_rects(12);
+    recorder.observe_free_rects(5);
+    
+    auto other = PackingStats{};
+    other.inserts = 1;
+    other.peak_free_rects = 9;
+    recorder.merge(other);
+    
+    const auto stats{recorder.snapshot()};
+    ASSERT_EQ(stats.inserts, 3);
+    ASSERT_EQ(stats.free_rects_scanned, 7);
+    ASSERT_EQ(stats.splits, 3);
+    ASSERT_EQ(stats.peak_free_rects, 12);
+    
+    recorder.reset();
+    ASSERT_EQ(recorder.snapshot().inserts, 0);
+}
+
+TEST("MaxRectsPacker stats follow the compile-time switch") {
+    PackingOptions<float> opts{.pot = false, .allow_rotation = true};
+    auto packer = MaxRectsPacker<float, Rectangle<float>>{256.0f, 256.0f, 0.0f, opts};
+    for (auto i{0}; i < 40; ++i) {
+        packer.add(static_cast<float>(16 + (i * 37) % 90), static_cast<float>(16 + (i * 53) % 70));
+    }
+    
+    const auto stats{packer.stats()};
+    if constexpr (stats_enabled) {
+        ASSERT_EQ(stats.inserts, 40);
+        ASSERT_GT(stats.free_rects_scanned, 0);
+        ASSERT_GT(stats.splits, 0);
+        ASSERT_GT(stats.prune_pairs, 0);
+        ASSERT_GT(stats.peak_free_rects, 0);
+        ASSERT_GT(stats.bins_probed, 0);
+    } else {
+        ASSERT_EQ(stats.inserts, 0);
+        ASSERT_EQ(stats.free_rects_scanned, 0);
+        ASSERT_EQ(stats.bins_probed, 0);
+    }
+}
@@ -0,0 +1,40 @@
+#include "simple_test.h"
+#include "../src/rect_slot_map.h"
+
+using namespace MaxRects;
+
+TEST("RectSlotMap resolves live handles to their location") {
+    auto map = RectSlotMap{};
+    const auto first = map.allocate();
+    const auto second = map.allocate();
+    map.place(first, 0, 3);
+    map.place(second, 2, 1);
+    
+    const auto handle = map.handle(second);
+    ASSERT_TRUE(handle.valid());
+    ASSERT_EQ(map.size(), 2);
+    ASSERT_EQ(map.find(handle)->bin, 2);
+    ASSERT_EQ(map.find(handle)->index, 1);
+    
+    map.place(second, 4, 0);
+    ASSERT_EQ(map.find(handle)->bin, 4);
+}
+
+TEST("RectSlotMap rejects handles after their slot is reused") {
+    auto map = RectSlotMap{};
+    const auto slot = map.allocate();
+    const auto old_handle = map.handle(slot);
+    
+    map.release(slot);
+    ASSERT_EQ(map.find(old_handle), nullptr);
+    ASSERT_FALSE(map.handle(slot).valid());
+    
+    const auto reused = map.allocate();
+    ASSERT_EQ(reused, slot);
+    ASSERT_EQ(map.find(old_handle), nullptr);
+    ASSERT_NE(map.find(map.handle(reused)), nullptr);
+    
+    map.clear();
+    ASSERT_EQ(map.size(), 0);
+    ASSERT_EQ(map.find(map.handle(reused)), nullptr);
+}
@@ -0,0 +1,95 @@
+#include "simple_test.h"
+#include "../src/skyline_bin.h"
+#include "../src/maxrects_packer.h"
+
+using namespace MaxRects;
+
+namespace {
+    auto overlaps(const Rectangle<int>& a, const Rectangle<int>& b) -> bool {
+        return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+    }
+}
+
+TEST("SkylineBin places rects inside the bin without overlap") {
+    for (auto heuristic : {SkylineHeuristic::BottomLeft, SkylineHeuristic::MinWaste}) {
+        auto opts = PackingOptions<int>{.smart = false, .pot = false, .allow_rotation = true, .skyline = heuristic};
+        auto bin = SkylineBin<Rectangle<int>, int>{256, 256, 0, opts};
+        
+        for (auto i{0}; i < 200; ++i) {
+            bin.add(Rectangle<int>{4 + (i * 37) % 40, 4 + (i * 53) % 30});
+        }
+        ASSERT_GT(bin.rects.size(), 40);
+        for (auto a = std::size_t{0}; a < bin.rects.size(); ++a) {
+            const auto& rect = bin.rects[a];
+            ASSERT_GE(rect.x, 0);
+            ASSERT_GE(rect.y, 0);
+            ASSERT_GE(256, rect.x + rect.w);
+            ASSERT_GE(256, rect.y + rect.h);
+            for (auto b = a + 1; b < bin.rects.size(); ++b) {
+                ASSERT_FALSE(overlaps(rect, bin.rects[b]));
+            }
+        }
+        
+        const auto segments{bin.segments()};
+        auto x{0};
+        for (auto i = std::size_t{0}; i < segments.size(); ++i) {
+            ASSERT_EQ(segments[i].x, x);
+            if (i > 0) {
+                ASSERT_NE(segments[i].y, segments[i - 1].y);
+            }
+            x += segments[i].w;
+        }
+        ASSERT_EQ(x, 256);
+    }
+}
+
+TEST("SkylineBin bottom-left fills the lowest level first") {
+    auto bin = SkylineBin<Rectangle<int>, int>{100, 100, 0, PackingOptions<int>{.smart = false, .pot = false}};
+    
+    ASSERT_NE(bin.add(Rectangle<int>{60, 30}), nullptr);
+    const auto* second{bin.add(Rectangle<int>{40, 10})};
+    ASSERT_NE(second, nullptr);
+    ASSERT_EQ(second->x, 60);
+    ASSERT_EQ(second->y, 0);
+    const auto* third{bin.add(Rectangle<int>{40, 10})};
+    ASSERT_EQ(third->x, 60);
+    ASSERT_EQ(third->y, 10);
+    ASSERT_EQ(bin.add(Rectangle<int>{101, 10}), nullptr);
+    ASSERT_EQ(bin.capacity().max_h, 80);
+}
+
+TEST("SkylineBin repack reclaims space after remove") {
+    auto bin = SkylineBin<Rectangle<int>, int>{64, 64, 0, PackingOptions<int>{.smart = false, .pot = false}};
+    for (auto i{0}; i < 16; ++i) {
+        ASSERT_NE(bin.add(Rectangle<int>{16, 16}), nullptr);
+    }
+    ASSERT_EQ(bin.add(Rectangle<int>{16, 16}), nullptr);
+    
+    ASSERT_TRUE(bin.remove(3));
+    ASSERT_TRUE(bin.is_dirty());
+    ASSERT_TRUE(bin.repack().empty());
+    ASSERT_EQ(bin.rects.size(), 15);
+    ASSERT_NE(bin.add(Rectangle<int>{16, 16}), nullptr);
+    
+    auto cloned{bin.clone()};
+    ASSERT_EQ(cloned->rects.size(), bin.rects.size());
+    ASSERT_EQ(cloned->add(Rectangle<int>{16, 16}), nullptr);
+}
+
+TEST("MaxRectsPacker creates skyline bins when configured") {
+    auto opts = PackingOptions<float>{.pot = false, .allow_rotation = true, .bin_algorithm = BinAlgorithm::Skyline};
+    auto packer = MaxRectsPacker<float, Rectangle<float>>{128.0f, 128.0f, 0.0f, opts};
+    auto rectangles = std::vector<Rectangle<float>>{};
+    for (auto i{0}; i < 300; ++i) {
+        rectangles.emplace_back(static_cast<float>(4 + (i * 37) % 40), static_cast<float>(4 + (i * 53) % 30));
+    }
+    packer.add_array(rectangles);
+    
+    ASSERT_GT(packer.bins.size(), 1);
+    for (const auto& bin : packer.bins) {
+        const auto* skyline_bin{dynamic_cast<const SkylineBin<Rectangle<float>, float>*>(bin.get())};
+        ASSERT_NE(skyline_bin, nullptr);
+    }
+    ASSERT_EQ(packer.get_all_rects().size(), rectangles.size());
+    ASSERT_GT(packer.occupancy(), 0.5);
+}
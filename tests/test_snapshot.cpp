@@ -0,0 +1,210 @@
+#include "simple_test.h"
+#include "../src/maxrects_packer.h"
+#include "../src/compact_rect.h"
+#include <array>
+#include <cstring>
+
+using namespace MaxRects;
+
+namespace {
+    auto write_id(const Rectangle<float>& rect, std::pmr::vector<std::byte>& out) -> void {
+        if (const auto* id = std::any_cast<int>(&rect.data)) {
+            const auto* bytes = reinterpret_cast<const std::byte*>(id);
+            out.insert(out.end(), bytes, bytes + sizeof(int));
+        }
+    }
+
+    auto read_id(Rectangle<float>& rect, std::span<const std::byte> payload) -> void {
+        if (payload.size() == sizeof(int)) {
+            auto id = 0;
+            std::memcpy(&id, payload.data(), sizeof(int));
+            rect.data = id;
+        }
+    }
+
+    auto make_rects(int first, int count) -> std::vector<Rectangle<float>> {
+        auto rects = std::vector<Rectangle<float>>{};
+        for (auto i{first}; i < first + count; ++i) {
+            rects.emplace_back(static_cast<float>(6 + (i * 37) % 41), static_cast<float>(6 + (i * 53) % 29), std::any{i});
+            rects.back().allow_rotation = true;
+            rects.back().tag = make_tag(i % 3 == 0 ? "ui" : "world");
+        }
+        return rects;
+    }
+
+    auto same_layout(const MaxRectsPacker<float, Rectangle<float>>& a, const MaxRectsPacker<float, Rectangle<float>>& b) -> bool {
+        if (a.bins.size() != b.bins.size()) {
+            return false;
+        }
+        for (auto bin = std::size_t{0}; bin < a.bins.size(); ++bin) {
+            const auto& p = a.bins[bin]->rects;
+            const auto& q = b.bins[bin]->rects;
+            if (p.size() != q.size()) {
+                return false;
+            }
+            for (auto i = std::size_t{0}; i < p.size(); ++i) {
+                if (p[i].x != q[i].x || p[i].y != q[i].y || p[i].w != q[i].w || p[i].h != q[i].h ||
+                    p[i].rot != q[i].rot || p[i].tag != q[i].tag ||
+                    std::any_cast<int>(p[i].data) != std::any_cast<int>(q[i].data)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+TEST("MaxRectsPacker snapshot restores layout, free space and handles") {
+    PackingOptions<float> opts{.pot = false, .allow_rotation = true, .tag = true, .exclusive_tag = false};
+    auto packer = MaxRectsPacker<float, Rectangle<float>>{128.0f, 128.0f, 1.0f, opts};
+    packer.add_array(make_rects(0, 300));
+    auto oversized = Rectangle<float>{300.0f, 20.0f, std::any{-1}};
+    packer.add(oversized);
+    const auto handle = packer.insert(Rectangle<float>{10.0f, 12.0f, std::any{1000}});
+    const auto removed = packer.insert(Rectangle<float>{9.0f, 9.0f, std::any{1001}});
+    ASSERT_TRUE(packer.remove(removed));
+
+    auto bytes = std::vector<std::byte>{};
+    ASSERT_TRUE(packer.snapshot(bytes, write_id));
+
+    auto restored = MaxRectsPacker<float, Rectangle<float>>{};
+    ASSERT_TRUE(restored.restore(bytes, read_id));
+    ASSERT_TRUE(same_layout(packer, restored));
+    ASSERT_EQ(restored.get_current_bin_index(), packer.get_current_bin_index());
+    ASSERT_FLOAT_EQ(restored.occupancy(), packer.occupancy());
+    ASSERT_NE(restored.get(handle), nullptr);
+    ASSERT_EQ(std::any_cast<int>(restored.get(handle)->data), 1000);
+    ASSERT_EQ(restored.get(removed), nullptr);
+
+    // Both carry on from the same free space, handle table and options.
+    const auto more = make_rects(300, 200);
+    packer.add_array(more);
+    restored.add_array(more);
+    packer.insert(Rectangle<float>{7.0f, 5.0f, std::any{2000}});
+    restored.insert(Rectangle<float>{7.0f, 5.0f, std::any{2000}});
+    ASSERT_TRUE(same_layout(packer, restored));
+}
+
+TEST("MaxRectsPacker snapshot carries contact-point edges") {
+    PackingOptions<float> opts{.pot = false, .allow_rotation = true, .logic = PackingLogic::ContactPoint};
+    auto packer = MaxRectsPacker<float, Rectangle<float>>{128.0f, 128.0f, 0.0f, opts};
+    packer.add_array(make_rects(0, 120));
+    
+    auto bytes = std::vector<std::byte>{};
+    ASSERT_TRUE(packer.snapshot(bytes, write_id));
+    auto restored = MaxRectsPacker<float, Rectangle<float>>{};
+    ASSERT_TRUE(restored.restore(bytes, read_id));
+    
+    const auto more = make_rects(120, 120);
+    packer.add_array(more);
+    restored.add_array(more);
+    ASSERT_TRUE(same_layout(packer, restored));
+}
+
+TEST("MaxRectsPacker restore rejects bad snapshots and keeps its state") {
+    auto packer = MaxRectsPacker<float, Rectangle<float>>{64.0f, 64.0f, 0.0f, PackingOptions<float>{.pot = false}};
+    packer.add_array(make_rects(0, 40));
+    auto bytes = std::vector<std::byte>{};
+    ASSERT_TRUE(packer.snapshot(bytes, write_id));
+
+    auto target = MaxRectsPacker<float, Rectangle<float>>{32.0f, 32.0f, 0.0f, PackingOptions<float>{.pot = false}};
+    target.add_array(make_rects(100, 10));
+    const auto bin_count = target.bins.size();
+    const auto rect_count = target.get_all_rects().size();
+
+    ASSERT_FALSE(target.restore(std::span<const std::byte>{bytes}.first(bytes.size() / 2)));
+
+    auto bad_version = bytes;
+    auto version = snapshot_version + 1;
+    std::memcpy(bad_version.data() + sizeof(std::uint32_t), &version, sizeof(version));
+    ASSERT_FALSE(target.restore(bad_version));
+
+    auto bad_slot = bytes;
+    const auto reader = SnapshotReader{bytes};
+    const auto slots = reader.section_bytes(static_cast<std::size_t>(SnapshotPackerSection::Slots), sizeof(SnapshotSlot));
+    ASSERT_GT(slots.size(), std::size_t{0});
+    const auto live = std::uint32_t{0};
+    std::memcpy(bad_slot.data() + (slots.data() - bytes.data()) + sizeof(std::uint32_t), &live, sizeof(live));
+    ASSERT_FALSE(target.restore(bad_slot));
+
+    auto as_double = MaxRectsPacker<double, Rectangle<double>>{};
+    ASSERT_FALSE(as_double.restore(bytes));
+
+    ASSERT_EQ(target.bins.size(), bin_count);
+    ASSERT_EQ(target.get_all_rects().size(), rect_count);
+    ASSERT_EQ(target.width, 32.0f);
+
+    auto skyline = MaxRectsPacker<float, Rectangle<float>>{64.0f, 64.0f, 0.0f,
+        PackingOptions<float>{.pot = false, .bin_algorithm = BinAlgorithm::Skyline}};
+    skyline.add_array(make_rects(0, 10));
+    auto untouched = std::vector<std::byte>{std::byte{7}};
+    ASSERT_FALSE(skyline.snapshot(untouched));
+    ASSERT_EQ(untouched.size(), std::size_t{1});
+}
+
+TEST("SnapshotReader rejects headers whose section table does not fit") {
+    alignas(snapshot_alignment) auto buffer = std::array<std::byte, 64>{};
+    auto header = SnapshotHeader{};
+    header.section_count = 3;
+    for (const auto size : {std::uint64_t{0}, std::uint64_t{sizeof(SnapshotHeader)}, std::uint64_t{buffer.size()}}) {
+        header.size = size;
+        std::memcpy(buffer.data(), &header, sizeof(header));
+        const auto reader = SnapshotReader{buffer};
+        ASSERT_FALSE(reader.valid());
+        ASSERT_EQ(reader.section_count(), std::size_t{0});
+    }
+    
+    header.section_count = 0;
+    header.size = buffer.size();
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    ASSERT_TRUE(SnapshotReader{buffer}.valid());
+}
+
+TEST("MaxRectsPacker snapshot round-trips CompactRect indices") {
+    PackingOptions<int> opts{.pot = false, .allow_rotation = true};
+    auto packer = MaxRectsPacker<int, CompactRect<std::int16_t>>{256, 256, 0, opts};
+    auto input = std::vector<CompactRect<std::int16_t>>{};
+    for (auto i{0u}; i < 150u; ++i) {
+        input.emplace_back(static_cast<int>(8 + (i * 37) % 61), static_cast<int>(8 + (i * 53) % 47), i);
+    }
+    packer.add_array(input);
+
+    auto bytes = std::vector<std::byte>{};
+    ASSERT_TRUE(packer.snapshot(bytes));
+    auto restored = MaxRectsPacker<int, CompactRect<std::int16_t>>{};
+    ASSERT_TRUE(restored.restore(bytes));
+
+    const auto expected = packer.get_all_rects();
+    const auto actual = restored.get_all_rects();
+    ASSERT_EQ(actual.size(), expected.size());
+    for (auto i = std::size_t{0}; i < actual.size(); ++i) {
+        ASSERT_EQ(actual[i].x, expected[i].x);
+        ASSERT_EQ(actual[i].y, expected[i].y);
+        ASSERT_EQ(actual[i].w, expected[i].w);
+        ASSERT_EQ(actual[i].index, expected[i].index);
+        ASSERT_EQ(actual[i].rot, expected[i].rot);
+    }
+}
+
+TEST("MaxRectsPacker restore rejects snapshots of another rect type") {
+    PackingOptions<int> opts{.pot = false};
+    auto full = MaxRectsPacker<int, Rectangle<int>>{4096, 4096, 0, opts};
+    full.add(Rectangle<int>{3000, 40});
+    full.add(Rectangle<int>{50, 60});
+    auto bytes = std::vector<std::byte>{};
+    ASSERT_TRUE(full.snapshot(bytes));
+
+    auto compact = MaxRectsPacker<int, CompactRect<std::int16_t>>{256, 256, 0, opts};
+    compact.add(CompactRect<std::int16_t>{20, 30, 5});
+    ASSERT_FALSE(compact.restore(bytes));
+    ASSERT_EQ(compact.bins.size(), std::size_t{1});
+    ASSERT_EQ(compact.width, 256);
+    ASSERT_EQ(compact.get_all_rects()[0].index, 5);
+
+    auto compact_bytes = std::vector<std::byte>{};
+    ASSERT_TRUE(compact.snapshot(compact_bytes));
+    auto wide = MaxRectsPacker<int, CompactRect<std::int32_t>>{};
+    ASSERT_FALSE(wide.restore(compact_bytes));
+    ASSERT_FALSE(full.restore(compact_bytes));
+    ASSERT_EQ(full.get_all_rects().size(), std::size_t{2});
+}
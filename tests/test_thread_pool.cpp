@@ -0,0 +1,44 @@
+#include "simple_test.h"
+#include "../src/thread_pool.h"
+#include <atomic>
+
+using namespace MaxRects;
+
+TEST("ThreadPool runs every index exactly once") {
+    auto pool = ThreadPool{4};
+    auto hits = std::vector<std::atomic<int>>(1000);
+    
+    pool.parallel_for(hits.size(), [&hits](std::size_t i) { hits[i].fetch_add(1); });
+    pool.parallel_for(hits.size(), [&hits](std::size_t i) { hits[i].fetch_add(1); });
+    
+    for (const auto& hit : hits) {
+        ASSERT_EQ(hit.load(), 2);
+    }
+    ASSERT_EQ(pool.size(), 4);
+}
+
+TEST("ThreadPool runs nested loops inline") {
+    auto pool = ThreadPool{3};
+    auto total = std::atomic<int>{0};
+    
+    pool.parallel_for(8, [&](std::size_t) {
+        pool.parallel_for(8, [&](std::size_t) { total.fetch_add(1); });
+    });
+    
+    ASSERT_EQ(total.load(), 64);
+}
+
+TEST("ThreadPool rethrows task failures") {
+    auto pool = ThreadPool{2};
+    auto threw = false;
+    try {
+        pool.parallel_for(16, [](std::size_t i) {
+            if (i == 5) {
+                throw std::runtime_error{"task failed"};
+            }
+        });
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+}